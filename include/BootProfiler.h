@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// records how long the initialization of the individual subsystems takes
+// and when the control path first became operational after (re)booting.
+class BootProfilerClass {
+public:
+    enum class Milestone : uint8_t {
+        SetupDone,
+        FirstDplCalculation,
+        FirstLimitCommand,
+        Count
+    };
+
+    struct Stage {
+        char const* name;
+        uint32_t durationUs;
+    };
+
+    // ends the current stage of the initialization, which started when the
+    // previous one ended.
+    void endStage(char const* name);
+
+    // records the time since boot at which the milestone was first reached
+    void reach(Milestone milestone);
+
+    std::vector<Stage> getStages() const;
+
+    // ms since boot, zero if not reached yet
+    uint32_t getMillis(Milestone milestone) const;
+
+    static char const* getName(Milestone milestone);
+
+    void printSummary() const;
+
+private:
+    mutable std::mutex _mutex;
+    std::vector<Stage> _stages;
+    int64_t _lastStageEnd = 0;
+
+    std::array<std::atomic<uint32_t>, static_cast<size_t>(Milestone::Count)> _milestones = {};
+};
+
+extern BootProfilerClass BootProfiler;
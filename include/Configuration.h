@@ -136,10 +136,18 @@ using PowerMeterHttpSmlConfig = struct POWERMETER_HTTP_SML_CONFIG_T;
 
 struct POWERMETER_UDP_VICTRON_CONFIG_T {
     uint16_t PollingIntervalMs;
+    bool AdaptivePolling;
     uint8_t IpAddress[4];
 };
 using PowerMeterUdpVictronConfig = struct POWERMETER_UDP_VICTRON_CONFIG_T;
 
+struct POWERMETER_FUSION_CONFIG_T {
+    uint32_t FastSource;
+    uint32_t SlowSource;
+    uint16_t CorrectionTimeConstant; // s
+};
+using PowerMeterFusionConfig = struct POWERMETER_FUSION_CONFIG_T;
+
 struct POWERLIMITER_INVERTER_CONFIG_T {
     uint64_t Serial;
     bool IsGoverned;
@@ -176,6 +184,9 @@ struct POWERLIMITER_CONFIG_T {
     uint8_t InverterChannelIdForDcVoltage;
     uint8_t RestartHour;
     uint16_t TotalUpperPowerLimit;
+    bool PredictiveEnabled;
+    uint16_t RampRateLimit;
+    bool FailsafeEnabled;
     PowerLimiterInverterConfig Inverters[INV_MAX_COUNT];
 };
 using PowerLimiterConfig = struct POWERLIMITER_CONFIG_T;
@@ -305,6 +316,7 @@ struct CONFIG_T {
         bool Enabled;
         char Hostname[SYSLOG_MAX_HOSTNAME_STRLEN + 1];
         uint16_t Port;
+        bool UseTcp;
     } Syslog;
 
     struct {
@@ -399,6 +411,7 @@ struct CONFIG_T {
         PowerMeterHttpJsonConfig HttpJson;
         PowerMeterHttpSmlConfig HttpSml;
         PowerMeterUdpVictronConfig UdpVictron;
+        PowerMeterFusionConfig Fusion;
     } PowerMeter;
 
     PowerLimiterConfig PowerLimiter;
@@ -407,6 +420,12 @@ struct CONFIG_T {
 
     GridChargerConfig Huawei;
 
+    struct {
+        bool Enabled;
+        uint32_t Interval;
+        uint32_t MaxSizeKb;
+    } History;
+
     INVERTER_CONFIG_T Inverter[INV_MAX_COUNT];
     char Dev_PinMapping[DEV_MAX_MAPPING_NAME_STRLEN + 1];
 };
@@ -444,6 +463,7 @@ public:
     static void serializePowerMeterHttpJsonConfig(PowerMeterHttpJsonConfig const& source, JsonObject& target);
     static void serializePowerMeterHttpSmlConfig(PowerMeterHttpSmlConfig const& source, JsonObject& target);
     static void serializePowerMeterUdpVictronConfig(PowerMeterUdpVictronConfig const& source, JsonObject& target);
+    static void serializePowerMeterFusionConfig(PowerMeterFusionConfig const& source, JsonObject& target);
     static void serializeBatteryConfig(BatteryConfig const& source, JsonObject& target);
     static void serializeBatteryZendureConfig(BatteryZendureConfig const& source, JsonObject& target);
     static void serializePowerLimiterConfig(PowerLimiterConfig const& source, JsonObject& target);
@@ -457,6 +477,7 @@ public:
     static void deserializePowerMeterHttpJsonConfig(JsonObject const& source, PowerMeterHttpJsonConfig& target);
     static void deserializePowerMeterHttpSmlConfig(JsonObject const& source, PowerMeterHttpSmlConfig& target);
     static void deserializePowerMeterUdpVictronConfig(JsonObject const& source, PowerMeterUdpVictronConfig& target);
+    static void deserializePowerMeterFusionConfig(JsonObject const& source, PowerMeterFusionConfig& target);
     static void deserializeBatteryConfig(JsonObject const& source, BatteryConfig& target);
     static void deserializeBatteryZendureConfig(JsonObject const& source, BatteryZendureConfig& target);
     static void deserializePowerLimiterConfig(JsonObject const& source, PowerLimiterConfig& target);
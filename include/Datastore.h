@@ -1,14 +1,39 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include "Configuration.h"
 #include <TaskSchedulerDeclarations.h>
-#include <mutex>
+#include <array>
+#include <atomic>
 
 class DatastoreClass {
 public:
+    struct Totals {
+        float acYieldTotalEnabled = 0;
+        float acYieldDayEnabled = 0;
+        float acPowerEnabled = 0;
+        float dcPowerEnabled = 0;
+        float dcPowerIrradiation = 0;
+        float dcIrradiationInstalled = 0;
+        float dcIrradiation = 0;
+        uint32_t acYieldTotalDigits = 0;
+        uint32_t acYieldDayDigits = 0;
+        uint32_t acPowerDigits = 0;
+        uint32_t dcPowerDigits = 0;
+        bool isAtLeastOneReachable = false;
+        bool isAtLeastOneProducing = false;
+        bool isAllEnabledProducing = false;
+        bool isAllEnabledReachable = false;
+        bool isAtLeastOnePollEnabled = false;
+    };
+
     DatastoreClass();
     void init(Scheduler& scheduler);
 
+    // consistent copy of all totals. never blocks, not even while the
+    // totals are being updated.
+    Totals getTotals() const;
+
     // Sum of yield total of all enabled inverters, a inverter which is just disabled at night is also included
     float getTotalAcYieldTotalEnabled();
 
@@ -59,27 +84,48 @@ public:
 
 private:
     void loop();
+    void publish(Totals const& totals);
+
+    // the contribution of a single inverter to the totals. it is only
+    // recalculated if the inverter's statistics or settings changed.
+    //
+    // the statistics are not pushed by the StatisticsParser: it is updated
+    // in the radio's context, which may run on the realtime core, and the
+    // reachability and settings change without a parser update anyway.
+    // instead, the parser's internal update timestamp serves as the
+    // per-inverter change marker, which the task checks once per second.
+    struct InverterContribution {
+        // values which invalidate the contribution when changed
+        uint64_t serial = 0;
+        uint32_t lastUpdate = 0;
+        bool pollEnabled = false;
+        bool cfgPollEnabled = false;
+        uint32_t stringMaxPower = 0;
+
+        bool valid = false;
+        bool producing = false;
+        float acYieldTotal = 0;
+        float acYieldDay = 0;
+        float acPower = 0;
+        float dcPower = 0;
+        float dcPowerIrradiation = 0;
+        float dcIrradiationInstalled = 0;
+        uint32_t acYieldTotalDigits = 0;
+        uint32_t acYieldDayDigits = 0;
+        uint32_t acPowerDigits = 0;
+        uint32_t dcPowerDigits = 0;
+    };
 
     Task _loopTask;
 
-    std::mutex _mutex;
-
-    float _totalAcYieldTotalEnabled = 0;
-    float _totalAcYieldDayEnabled = 0;
-    float _totalAcPowerEnabled = 0;
-    float _totalDcPowerEnabled = 0;
-    float _totalDcPowerIrradiation = 0;
-    float _totalDcIrradiationInstalled = 0;
-    float _totalDcIrradiation = 0;
-    uint32_t _totalAcYieldTotalDigits = 0;
-    uint32_t _totalAcYieldDayDigits = 0;
-    uint32_t _totalAcPowerDigits = 0;
-    uint32_t _totalDcPowerDigits = 0;
-    bool _isAtLeastOneReachable = false;
-    bool _isAtLeastOneProducing = false;
-    bool _isAllEnabledProducing = false;
-    bool _isAllEnabledReachable = false;
-    bool _isAtLeastOnePollEnabled = false;
+    std::array<InverterContribution, INV_MAX_COUNT> _contributions;
+    std::array<bool, INV_MAX_COUNT> _reachable = {};
+
+    // two copies of the totals, written alternately. the sequence number
+    // selects the current copy and allows readers to detect that the copy
+    // they read was overwritten meanwhile (seqlock).
+    std::array<Totals, 2> _totals;
+    std::atomic<uint32_t> _sequence = 0;
 };
 
 extern DatastoreClass Datastore;
@@ -1,9 +1,9 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include <RingBuffer.h>
 #include <TaskSchedulerDeclarations.h>
 #include <U8g2lib.h>
-#include <array>
 
 #define MAX_DATAPOINTS 128
 
@@ -26,8 +26,7 @@ private:
     Task _dataPointTask;
 
     U8G2* _display = nullptr;
-    std::array<float, MAX_DATAPOINTS> _graphValues = {};
-    uint8_t _graphValuesCount = 0;
+    RingBuffer<float, MAX_DATAPOINTS> _graphValues;
 
     uint8_t _chartWidth = MAX_DATAPOINTS;
 
@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <RingBuffer.h>
+#include <TaskSchedulerDeclarations.h>
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+namespace History {
+
+// values are stored as 16 bit fixed-point numbers. a raw value of
+// INT16_MIN marks a sample where no valid value was available.
+using Sample = int16_t;
+
+static constexpr Sample InvalidSample = INT16_MIN;
+
+struct Aggregate {
+    Sample min = InvalidSample;
+    Sample max = InvalidSample;
+    Sample avg = InvalidSample;
+};
+
+enum class Resolution : uint8_t {
+    Raw = 0, // one sample per second
+    OneMinute,
+    FifteenMinutes
+};
+
+// a single time series kept at three resolutions. samples are appended
+// once per second. every 60 raw samples are condensed into one minute
+// aggregate, every 15 minute aggregates are condensed into one fifteen
+// minute aggregate.
+class Series {
+public:
+    static constexpr size_t RawCapacity = 128; // ~2 minutes
+    static constexpr size_t MinuteCapacity = 120; // 2 hours
+    static constexpr size_t QuarterCapacity = 96; // 24 hours
+
+    // resolution is the value represented by one LSB of the encoding
+    Series(char const* name, char const* unit, float resolution)
+        : _name(name)
+        , _unit(unit)
+        , _resolution(resolution) { }
+
+    void append(float value, bool valid);
+
+    char const* getName() const { return _name; }
+    char const* getUnit() const { return _unit; }
+
+    Sample encode(float value) const;
+    float decode(Sample sample) const;
+
+    RingBuffer<Sample, RawCapacity> const& getRaw() const { return _raw; }
+    RingBuffer<Aggregate, MinuteCapacity> const& getMinutes() const { return _minutes; }
+    RingBuffer<Aggregate, QuarterCapacity> const& getQuarters() const { return _quarters; }
+
+private:
+    // accumulates samples or aggregates until a coarser aggregate is complete
+    struct Accumulator {
+        void add(Sample min, Sample max, Sample avg);
+        Aggregate get() const;
+        void reset() { *this = Accumulator(); }
+
+        Sample min = InvalidSample;
+        Sample max = InvalidSample;
+        int32_t sum = 0;
+        uint16_t validCount = 0;
+        uint16_t count = 0;
+    };
+
+    char const* _name;
+    char const* _unit;
+    float _resolution;
+
+    RingBuffer<Sample, RawCapacity> _raw;
+    RingBuffer<Aggregate, MinuteCapacity> _minutes;
+    RingBuffer<Aggregate, QuarterCapacity> _quarters;
+
+    Accumulator _minuteAccumulator;
+    Accumulator _quarterAccumulator;
+};
+
+class Recorder {
+public:
+    enum class SeriesId : uint8_t {
+        AcPower = 0,
+        BatterySoC,
+        GridPower,
+        Count
+    };
+
+    Recorder();
+    void init(Scheduler& scheduler);
+
+    // the lock must be held while reading from a series
+    std::unique_lock<std::mutex> lock() const { return std::unique_lock<std::mutex>(_mutex); }
+
+    Series const& getSeries(SeriesId id) const { return _series[static_cast<size_t>(id)]; }
+
+    // uptime in seconds when the last raw sample was recorded
+    uint32_t getLastSampleUptime() const { return _lastSampleUptime; }
+
+    static constexpr uint32_t getInterval(Resolution res)
+    {
+        return (res == Resolution::Raw) ? 1 : (res == Resolution::OneMinute) ? 60 : 900;
+    }
+
+private:
+    void loop();
+
+    Task _loopTask;
+
+    mutable std::mutex _mutex;
+
+    std::array<Series, static_cast<size_t>(SeriesId::Count)> _series;
+
+    uint32_t _lastSampleUptime = 0;
+};
+
+} // namespace History
+
+extern History::Recorder HistoryRecorder;
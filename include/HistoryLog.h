@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <TaskSchedulerDeclarations.h>
+#include <TimeSeriesCodec.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <WString.h>
+
+namespace History {
+
+// append-only, compressed log of energy and power values on LittleFS.
+// records are compressed into fixed size blocks, which are appended to
+// segment files once full. the oldest segment file is deleted once the
+// configured storage size is exceeded. LittleFS itself takes care of wear
+// levelling.
+class FlashLog {
+public:
+    enum class Channel : uint8_t {
+        InverterAcPower = 0,
+        InverterDcPower,
+        BatterySoC,
+        BatteryPower,
+        GridPower,
+        PowerLimiterTarget,
+        Count
+    };
+
+    static constexpr uint8_t ChannelCount = static_cast<uint8_t>(Channel::Count);
+    static constexpr size_t BlockSize = 512;
+    static constexpr uint8_t BlocksPerSegment = 16;
+
+    using Values = std::array<float, ChannelCount>;
+
+    struct BlockHeader {
+        uint32_t magic;
+        uint32_t firstTimestamp;
+        uint32_t lastTimestamp;
+        uint16_t recordCount;
+        uint8_t channelCount;
+        uint8_t version;
+    };
+
+    static constexpr size_t PayloadSize = BlockSize - sizeof(BlockHeader);
+
+    struct Block {
+        BlockHeader header;
+        uint8_t payload[PayloadSize];
+    };
+
+    static_assert(sizeof(Block) == BlockSize, "unexpected padding in History::FlashLog::Block");
+
+    // reads all records within a time range in chronological order. the
+    // cursor works on a snapshot of the log taken at construction time.
+    class Cursor {
+    public:
+        bool next(uint32_t& timestamp, Values& values);
+
+    private:
+        friend class FlashLog;
+        Cursor(uint32_t start, uint32_t end)
+            : _start(start)
+            , _end(end) { }
+
+        bool loadNextBlock();
+
+        uint32_t _start;
+        uint32_t _end;
+
+        std::vector<String> _segments;
+        size_t _lastSegmentBlocks = 0; // blocks in the last segment at snapshot time
+        size_t _segmentIdx = 0;
+        size_t _blockIdx = 0;
+
+        bool _pendingBlockValid = false;
+        Block _pendingBlock; // the block which was not yet written to flash
+
+        Block _block;
+        std::unique_ptr<TimeSeriesCodec::Decoder> _upDecoder = nullptr;
+        bool _done = false;
+    };
+
+    FlashLog();
+    void init(Scheduler& scheduler);
+    void updateSettings();
+
+    // writes the current, partially filled block to flash
+    void flush();
+
+    std::unique_ptr<Cursor> query(uint32_t start, uint32_t end) const;
+
+    static char const* getChannelName(Channel channel);
+
+private:
+    void loop();
+    Values collect() const;
+    void resetBlock();
+    bool writeBlock();
+    String startSegment(uint32_t timestamp);
+    void startScan();
+    void scanSegments();
+    static void scanSegmentsHelper(void* context);
+    void enforceStorageLimit();
+
+    Task _loopTask;
+
+    mutable std::mutex _mutex;
+
+    Block _block;
+    std::unique_ptr<TimeSeriesCodec::Encoder> _upEncoder = nullptr;
+
+    std::vector<String> _segments; // oldest first
+    std::atomic<bool> _scanStarted = false;
+    std::atomic<bool> _segmentsScanned = false;
+    uint8_t _blocksInSegment = 0;
+    size_t _maxSegments = 0;
+};
+
+} // namespace History
+
+extern History::FlashLog HistoryLog;
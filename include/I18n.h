@@ -1,9 +1,11 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include <ArduinoJson.h>
 #include <TaskSchedulerDeclarations.h>
 #include <WString.h>
 #include <list>
+#include <mutex>
 
 struct LanguageInfo_t {
     String code;
@@ -26,11 +28,20 @@ public:
         String& yield_today_wh, String& yield_today_kwh,
         String& yield_total_kwh, String& yield_total_mwh);
 
+    // looks up an inverter alarm message in the language pack and copies
+    // it to the target. the messages of the most recently used language
+    // pack are cached.
+    bool getAlarmMessage(const String& locale, const uint16_t messageId, JsonVariant target);
+
 private:
     void readLangPacks();
     void readConfig(String file);
 
     std::list<LanguageInfo_t> _availLanguages;
+
+    std::mutex _alarmMessagesMutex;
+    String _alarmMessagesLocale;
+    JsonDocument _alarmMessages;
 };
 
 extern I18nClass I18n;
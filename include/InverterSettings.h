@@ -9,7 +9,7 @@
 class InverterSettingsClass {
 public:
     InverterSettingsClass();
-    void init(Scheduler& scheduler);
+    void init(Scheduler& scheduler, Scheduler& radioScheduler);
 
 private:
     void settingsLoop();
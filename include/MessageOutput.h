@@ -7,6 +7,7 @@
 #include <freertos/task.h>
 #include <mutex>
 #include <vector>
+#include <memory>
 #include <unordered_map>
 #include <queue>
 
@@ -18,6 +19,18 @@ public:
     size_t write(const uint8_t* buffer, size_t size) override;
     void register_ws_output(AsyncWebSocket* output);
 
+    // log output is kept in a ring buffer of this size (bytes), which is
+    // allocated in PSRAM if available. newly connected websocket clients are
+    // sent its contents first.
+    static constexpr size_t BacklogSize = 4 * 1024;
+    static constexpr size_t BacklogSizePsram = 64 * 1024;
+
+    // lines are sent to the websocket clients in frames of up to this size
+    static constexpr size_t MaxFrameSize = 2 * 1024;
+
+    // lines are sent to the websocket clients with a "HH:MM:SS.mmm > " prefix
+    static constexpr size_t TimestampLength = 15;
+
 private:
     void loop();
 
@@ -33,6 +46,22 @@ private:
 
     AsyncWebSocket* _ws = nullptr;
 
+    // positions are counted in bytes ever appended to the backlog. every
+    // websocket client is served from its own position, such that a client
+    // with a full queue is skipped without holding back the others.
+    char* _backlog = nullptr;
+    size_t _backlogCapacity = 0;
+    size_t _backlogFill = 0;
+    uint32_t _backlogEnd = 0;
+    std::unordered_map<uint32_t, uint32_t> _wsPositions;
+
+    static void stampLine(message_t& m);
+    void forwardLine(message_t&& m);
+    void appendBacklog(message_t const& m);
+    uint32_t getOldestBacklogLine() const;
+    std::shared_ptr<message_t> createFrame(uint32_t start, uint32_t& end) const;
+    void serveWebsocketClients();
+
     std::mutex _msgLock;
 
     void serialWrite(message_t const& m);
@@ -74,6 +74,9 @@ public:
 
 private:
     void loop();
+    static void publishDtuConfig();
+    static void publishInverterConfig(std::shared_ptr<InverterAbstract> inv);
+    static bool skipDocument();
     static void publish(const String& subtopic, const String& payload);
     static void publish(const String& subtopic, const JsonDocument& doc);
 
@@ -102,6 +105,15 @@ private:
 
     bool _wasConnected = false;
     bool _updateForced = false;
+
+    bool _publishing = false;
+    uint8_t _nextStep = 0; // DTU first, then the inverters
+
+    // position of the documents in the current step, such that a repeated
+    // step resumes with the first deferred document
+    static uint16_t _stepDocument;
+    static uint16_t _resumeDocument;
+    static bool _stepDeferred;
 };
 
 extern MqttHandleHassClass MqttHandleHass;
@@ -12,6 +12,7 @@ public:
 
 private:
     void loop();
+    void publishEntities();
     void publish(const String& subtopic, const String& payload);
     void publishNumber(const char* caption, const char* icon, const char* category, const char* commandTopic, const char* stateTopic, const char* unitOfMeasure, const int16_t min, const int16_t max, const float step);
     void publishSelect(const char* caption, const char* icon, const char* category, const char* commandTopic, const char* stateTopic);
@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <unordered_map>
+
+// keeps track of the Home Assistant discovery documents published by the
+// various integrations. documents are only published if they are new or
+// their content changed. the messages are paced by a token bucket, such
+// that (re-)publishing the discovery documents of many inverters does not
+// block the main loop and other MQTT traffic for seconds.
+//
+// no payloads are buffered: if the bucket is empty, the document is
+// deferred and its owner builds and publishes it again in a later pass,
+// once the registry is ready. documents sent before are skipped then.
+class MqttHassRegistryClass {
+public:
+    enum class Owner : uint8_t {
+        Dtu,
+        PowerLimiter,
+        Battery,
+        SolarCharger
+    };
+
+    void init();
+
+    // the subtopic is relative to the configured Home Assistant topic.
+    // an empty payload removes the entity from Home Assistant. returns
+    // false if the document was deferred, i.e., was not sent.
+    bool publish(Owner owner, const String& subtopic, const String& payload);
+
+    // entities of the owner which are not published between beginRound()
+    // and endRound() are removed from Home Assistant.
+    void beginRound(Owner owner);
+    void endRound(Owner owner);
+
+    // true if a whole burst of documents can be sent right away
+    bool isReady();
+
+    // true (once) if documents of the owner were deferred since the last
+    // call, i.e., the owner must publish its documents again.
+    bool takeDeferred(Owner owner);
+
+    // true (once) if the connection to the broker was (re-)established
+    // since the last call. the broker might have lost retained messages
+    // and Home Assistant might have been restarted, so the owner must
+    // publish all of its documents again.
+    bool takeInvalidated(Owner owner);
+
+private:
+    void onMqttConnect();
+    void handleConnect();
+    void refillTokens();
+    static uint32_t hash(const String& value);
+    static uint32_t hash(const String& payload, bool retain);
+    static constexpr uint8_t bit(Owner owner) { return 1 << static_cast<uint8_t>(owner); }
+
+    static constexpr float BucketCapacity = 10;
+    static constexpr float TokensPerSecond = 25;
+
+    // a hash value which never matches, used to force re-publishing
+    static constexpr uint32_t InvalidHash = 0;
+
+    struct Entity {
+        uint32_t hash;
+        Owner owner;
+        bool seen;
+    };
+
+    // key is a hash of the full topic. a collision of two topics is
+    // unlikely enough with a few hundred entities to not be handled.
+    std::unordered_map<uint32_t, Entity> _entities;
+
+    // the full topics are only required to remove stale entities, so they
+    // are only kept for owners publishing in rounds.
+    std::unordered_map<uint32_t, String> _roundTopics;
+
+    uint8_t _roundsActive = 0;
+    uint8_t _deferred = 0;
+    uint8_t _invalidated = 0;
+
+    // incremented in the MQTT client's task
+    std::atomic<uint32_t> _connectCounter { 0 };
+    uint32_t _handledConnects = 0;
+
+    float _tokens = BucketCapacity;
+    uint32_t _lastRefillMillis = 0;
+};
+
+extern MqttHassRegistryClass MqttHassRegistry;
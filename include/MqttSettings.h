@@ -5,7 +5,9 @@
 #include <MqttSubscribeParser.h>
 #include <Ticker.h>
 #include <espMqttClient.h>
+#include <functional>
 #include <mutex>
+#include <vector>
 
 class MqttSettingsClass {
 public:
@@ -17,12 +19,19 @@ public:
     void publish(const String& subtopic, const String& payload);
     void publishGeneric(const String& topic, const String& payload, const bool retain, const uint8_t qos = 0);
 
-    void subscribe(const String& topic, const uint8_t qos, const espMqttClientTypes::OnMessageCallback& cb);
+    MqttSubscribeParser::handle_t subscribe(const String& topic, const uint8_t qos, const espMqttClientTypes::OnMessageCallback& cb);
     void unsubscribe(const String& topic);
+    void unsubscribe(MqttSubscribeParser::handle_t handle);
 
     String getPrefix() const;
     String getClientId() const;
 
+    // the callback is invoked in the context of the MQTT client's task
+    // whenever the connection to the broker was established. callbacks
+    // must be registered during setup.
+    typedef std::function<void()> ConnectCb;
+    void onConnect(ConnectCb cb);
+
 private:
     void NetworkEvent(network_event event);
 
@@ -39,6 +48,7 @@ private:
     Ticker _mqttReconnectTimer;
     MqttSubscribeParser _mqttSubscribeParser;
     std::mutex _clientLock;
+    std::vector<ConnectCb> _connectCallbacks;
     bool _verboseLogging = true;
 };
 
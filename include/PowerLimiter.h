@@ -3,13 +3,16 @@
 
 #include "Configuration.h"
 #include "PowerLimiterInverter.h"
+#include "PowerLimiterLoadPredictor.h"
 #include <espMqttClient.h>
 #include <Arduino.h>
 #include <atomic>
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <functional>
 #include <optional>
+#include <vector>
 #include <TaskSchedulerDeclarations.h>
 #include <frozen/string.h>
 
@@ -43,6 +46,15 @@ public:
     int32_t getInverterOutput() { return _lastExpectedInverterOutput; }
     bool getFullSolarPassThroughEnabled() const { return _fullSolarPassThroughEnabled; }
 
+    // load the last calculation was based on in predictive mode
+    std::optional<float> getPredictedLoad() const { return _oPredictedLoad; }
+    float getLoadPredictionError() const { return _loadPredictor.getMeanAbsoluteError(); }
+    uint32_t getLimitCommands() const { return PowerLimiterInverter::getLimitCommandsSent(); }
+
+    bool isFailsafeActive() const { return _oFailsafeSince.has_value(); }
+    uint32_t getFailsafeMillis() const; // total time spent in fail-safe state
+    uint32_t getFailsafeEntries() const { return _failsafeEntries; }
+
     enum class Mode : unsigned {
         Normal = 0,
         Disabled = 1,
@@ -71,6 +83,9 @@ private:
     uint32_t _calculationBackoffMs = _calculationBackoffMsDefault;
     Mode _mode = Mode::Normal;
 
+    // the DPL may run on another core than the modules querying it, which
+    // must not observe the inverters while they are being replaced.
+    mutable std::mutex _invertersMutex;
     std::deque<std::unique_ptr<PowerLimiterInverter>> _inverters;
     std::deque<std::unique_ptr<PowerLimiterInverter>> _retirees;
     bool _batteryDischargeEnabled = false;
@@ -79,14 +94,35 @@ private:
     bool _fullSolarPassThroughEnabled = false;
     bool _verboseLogging = true;
 
+    PowerLimiterLoadPredictor _loadPredictor;
+    uint32_t _lastLoadSampleMillis = 0;
+    std::optional<float> _oPredictedLoad = std::nullopt;
+
+    // the fail-safe limit is sent to the inverters directly, without waiting
+    // for valid time, inverter stats and power meter data, after booting and
+    // once the power meter data went stale. the fail-safe state ends once the
+    // DPL performs a calculation based on valid power meter data.
+    bool _failsafeAtBoot = true;
+    bool _meterWasValid = false;
+    std::optional<uint32_t> _oFailsafeSince = std::nullopt;
+    uint32_t _failsafeMillis = 0;
+    uint32_t _failsafeEntries = 0;
+    std::vector<std::pair<uint64_t, uint16_t>> _failsafePending; // serial, limit (W)
+
     frozen::string const& getStatusText(Status status);
     void announceStatus(Status status);
     void reloadConfig();
+    void updateFailsafe();
+    void enterFailsafe(char const* reason);
+    void leaveFailsafe();
     std::pair<float, char const*> getInverterDcVoltage();
     float getBatteryVoltage(bool log = false);
     uint16_t dcPowerBusToInverterAc(uint16_t dcPower);
     void unconditionalFullSolarPassthrough();
     uint16_t calcTargetOutput();
+    uint32_t getPredictionHorizon();
+    uint32_t getMeterSettleMillis();
+    uint16_t getRampAllowance(PowerLimiterInverter const& inverter);
     using inverter_filter_t = std::function<bool(PowerLimiterInverter const&)>;
     uint16_t updateInverterLimits(uint16_t powerRequested, inverter_filter_t filter, std::string const& filterExpression);
     uint16_t calcPowerBusUsage(uint16_t powerRequested);
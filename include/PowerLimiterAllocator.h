@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include "PowerLimiterInverter.h"
+#include <vector>
+
+// plans which inverters shall change their output, and by how much, to
+// achieve a requested change of their total output. the plan uses as few
+// inverters as possible, such that as few limit commands as possible are
+// sent. among the plans using the same amount of inverters, the cheapest one
+// is selected. its cost is the energy that is expected to be lost due to
+// conversion losses (as per the inverters' efficiency curves), due to the
+// response time (the change is not effective until the slowest inverter
+// acknowledged its new limit and ramped its output accordingly), and due to
+// commands timing out (as per the inverters' update failure rates).
+class PowerLimiterAllocator {
+public:
+    struct Candidate {
+        PowerLimiterInverter* pInverter;
+        uint16_t capacity; // maximum change of this inverter's output (W)
+    };
+
+    struct Assignment {
+        PowerLimiterInverter* pInverter;
+        uint16_t change; // W
+    };
+
+    using Plan = std::vector<Assignment>;
+
+    // plans an increase (or a reduction) of the total output by the given
+    // amount. if the candidates cannot achieve the change in total, all of
+    // them are assigned their full capacity.
+    static Plan plan(std::vector<Candidate> const& candidates, uint16_t change, bool increase);
+
+    // conversion losses are accounted for during this time span
+    static constexpr uint32_t LossHorizonMillis = 60 * 1000;
+
+    // time an inverter takes to ramp from zero to its nominal power
+    static constexpr uint32_t FullScaleRampMillis = 10 * 1000;
+
+    // an update that times out only ends after this time
+    static constexpr uint32_t TimeoutMillis = 30 * 1000;
+
+    // subsets of the candidates are enumerated to find the cheapest plan,
+    // so only this many candidates are considered.
+    static constexpr size_t MaxCandidates = INV_MAX_COUNT;
+
+private:
+    static float getCost(Plan const& plan, bool increase);
+};
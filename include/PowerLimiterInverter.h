@@ -3,6 +3,7 @@
 
 #include "Configuration.h"
 #include <Hoymiles.h>
+#include <array>
 #include <optional>
 #include <memory>
 
@@ -29,6 +30,34 @@ public:
     // the amount of times an update command issued to the inverter timed out
     uint8_t getUpdateTimeouts() const { return _updateTimeouts; }
 
+    // moving average of the time it takes from starting a limit update until
+    // the inverter acknowledged the new limit. std::nullopt until the first
+    // limit update succeeded.
+    std::optional<uint32_t> getLimitLatencyMillis() const { return _oLimitLatencyMillis; }
+
+    // timestamp of the last limit command acknowledged by the inverter
+    uint32_t getLastLimitCommandMillis() const;
+
+    // true while the reported output is still above the current limit, i.e.,
+    // while the inverter is ramping down towards a new limit. as the output
+    // keeps changing, such stats do not belong to a power meter reading taken
+    // at a different time. gives up MaxRampMillis after the last limit
+    // command, in case the inverter does not honor its limit.
+    bool isRampingDown() const;
+    static constexpr uint32_t MaxRampMillis = 20 * 1000;
+
+    // the amount of limit commands sent to any inverter since boot
+    static uint32_t getLimitCommandsSent() { return _limitCommandsSent; }
+
+    // moving average of the update outcomes, 0 if all updates succeeded
+    // recently, approaching 1 if all of them timed out or failed.
+    float getFailureRate() const { return _failureRate; }
+
+    // conversion efficiency (0 - 1) at the given AC output. the curve is
+    // learned from the efficiency reported at different output levels,
+    // starting from the curve typical for micro inverters.
+    float getEfficiency(uint16_t acWatts) const;
+
     // maximum amount of AC power the inverter is able to produce
     // (not regarding the configured upper power limit)
     uint16_t getInverterMaxPowerWatts() const;
@@ -124,6 +153,16 @@ private:
     // issued to the inverter timed out *or* failed
     uint8_t _updateTimeouts = 0;
 
+    std::optional<uint32_t> _oLimitLatencyMillis = std::nullopt;
+    static uint32_t _limitCommandsSent;
+
+    float _failureRate = 0;
+
+    // efficiency in ten buckets of 10 % of the max output each
+    void updateEfficiency();
+    std::array<float, 10> _efficiencyCurve = { 0.88, 0.93, 0.945, 0.953, 0.957, 0.958, 0.958, 0.957, 0.956, 0.955 };
+    uint32_t _lastEfficiencyUpdate = 0;
+
     // track (target) state
     std::optional<uint32_t> _oUpdateStartMillis = std::nullopt;
     std::optional<uint16_t> _oTargetPowerLimitWatts = std::nullopt;
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <Arduino.h>
+#include <optional>
+
+// estimates the household load (what the DPL-governed inverters are supposed
+// to cover) a short time into the future. the samples are smoothed using
+// exponential moving averages for the level and the trend (Holt's method),
+// with smoothing factors derived from the actual time between samples, as
+// power meter readings do not arrive at a fixed interval. a sample deviating
+// from the prediction by more than StepThreshold is considered a load step:
+// the estimate then jumps to the new sample to avoid a sluggish response.
+class PowerLimiterLoadPredictor {
+public:
+    void reset();
+
+    // adds a load sample (W) which was taken at the given time (ms)
+    void addSample(float load, uint32_t timestamp);
+
+    // predicted load horizon ms after the last sample was taken,
+    // std::nullopt if no sample was added since the last reset.
+    std::optional<float> predict(uint32_t horizon) const;
+
+    // trend of the load in W/s
+    float getTrend() const { return _trend; }
+
+    // exponential moving average of the absolute difference between each
+    // sample and the value predicted for its timestamp.
+    float getMeanAbsoluteError() const { return _meanAbsoluteError; }
+
+    uint32_t getLoadSteps() const { return _loadSteps; }
+
+    static constexpr float LevelTimeConstant = 4000; // ms
+    static constexpr float TrendTimeConstant = 15000; // ms
+    static constexpr float ErrorTimeConstant = 60000; // ms
+    static constexpr float StepThreshold = 150; // W
+    static constexpr uint32_t MaxHorizon = 10 * 1000; // ms
+
+private:
+    std::optional<uint32_t> _oLastSample = std::nullopt;
+    float _level = 0; // W
+    float _trend = 0; // W/s
+    float _meanAbsoluteError = 0; // W
+    uint32_t _loadSteps = 0;
+};
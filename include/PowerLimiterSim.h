@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <TaskSchedulerDeclarations.h>
+#include <deque>
+#include <optional>
+#include <utility>
+
+#if defined(DPL_SIM) && !defined(HOYMILES_RADIO_SIM)
+#error "DPL_SIM requires HOYMILES_RADIO_SIM"
+#endif
+
+// closes the loop around the DPL without any hardware: simulates the household
+// load, the power meter (sample interval and latency) and the battery, while
+// the inverters (including their ramp) are emulated by the simulated Hoymiles
+// radio. the household load is replayed from /dplsim.csv ("seconds,watts" per
+// line, repeated once exhausted) or generated from a synthetic day profile.
+// grid import/export, the amount of limit commands and the time the grid
+// power takes to settle after load steps are accumulated, such that changes
+// to the control loop can be compared objectively. only active if the firmware
+// is built with DPL_SIM.
+class PowerLimiterSimClass {
+public:
+    PowerLimiterSimClass();
+
+    void init(Scheduler& scheduler);
+
+    // returns a power meter reading once (and only once) it became available,
+    // i.e., the power at the grid connection as it was MeterLatency ms ago.
+    std::optional<float> getMeterReading();
+
+    // battery state as reported by a BMS
+    float getBatterySoC() const { return _batterySoC; }
+    float getBatteryVoltage() const;
+    float getBatteryCurrent() const { return _batteryCurrent; }
+
+    struct Metrics {
+        uint32_t duration; // s
+        float loadEnergy; // Wh
+        float gridImport; // Wh
+        float gridExport; // Wh
+        uint32_t limitCommands;
+        uint32_t loadSteps;
+        uint32_t settled;
+        uint32_t unsettled; // not settled within SettleTimeout, e.g., saturated
+        uint32_t settlingTimeTotal; // ms
+        uint32_t settlingTimeMax; // ms
+    };
+
+    Metrics const& getMetrics() const { return _metrics; }
+    void resetMetrics();
+    void printReport(Print& output) const;
+
+    static constexpr uint32_t MeterInterval = 1000; // ms
+    static constexpr uint32_t MeterLatency = 1500; // ms
+    static constexpr float LoadStepThreshold = 100; // W
+    static constexpr float SettleBand = 50; // W around the target consumption
+    static constexpr uint32_t SettleHoldTime = 10 * 1000;
+    static constexpr uint32_t SettleTimeout = 5 * 60 * 1000;
+    static constexpr float BatteryCapacity = 5000; // Wh
+    static constexpr float BatteryMaxDischarge = 2400; // W
+    static constexpr float BatteryChargerPeak = 1000; // W at full irradiation
+    static constexpr float InverterEfficiency = 0.96; // as emulated by the radio
+
+private:
+    void loop();
+
+    float getLoad();
+    bool readProfileSample(std::pair<uint32_t, float>& sample);
+    float getSyntheticLoad();
+    uint32_t nextRandom();
+    static float getIrradiation();
+    void updateBattery(float dcPower, float elapsed);
+    void updateSettling(float gridPower, float load);
+
+    Task _loopTask;
+
+    uint32_t _start = 0;
+    uint32_t _lastUpdate = 0;
+    uint32_t _lastReport = 0;
+    uint32_t _metricsStart = 0;
+
+    // recorded load profile, streamed as the simulation advances
+    File _profile;
+    std::pair<uint32_t, float> _profileCurrent = { 0, 0 };
+    std::pair<uint32_t, float> _profileNext = { 0, 0 };
+    uint32_t _profileOffset = 0; // s, advances whenever the profile restarts
+
+    // state of the synthetic profile
+    uint32_t _random = 0x2545f491;
+    uint32_t _nextApplianceChange = 0;
+    float _applianceLoad = 0;
+
+    float _referenceLoad = 0; // load when the last step was detected
+
+    // meter samples in flight, ordered by the time they become available
+    std::deque<std::pair<uint32_t, float>> _meterSamples;
+    uint32_t _lastMeterSample = 0;
+    std::optional<float> _oMeterReading = std::nullopt;
+
+    float _batterySoC = 50; // %
+    float _batteryCurrent = 0; // A, positive while charging
+
+    std::optional<uint32_t> _oStepMillis = std::nullopt;
+    std::optional<uint32_t> _oInBandSince = std::nullopt;
+
+    Metrics _metrics = {};
+    uint32_t _limitCommandsOffset = 0;
+};
+
+extern PowerLimiterSimClass PowerLimiterSim;
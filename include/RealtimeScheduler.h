@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <TaskSchedulerDeclarations.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <functional>
+#include <ThreadSafeQueue.h>
+
+// the tasks which keep the inverters' output in line with the household
+// consumption, i.e., servicing the radio and running the DPL, are added to
+// this scheduler. if the firmware is built with REALTIME_CORE, it runs in a
+// FreeRTOS task of its own, pinned to the respective core. these tasks are
+// then not delayed by the tasks run from the Arduino loop, like MQTT
+// publishing, Home Assistant auto-discovery or the display. otherwise this is
+// the main scheduler.
+class RealtimeSchedulerClass {
+public:
+    // starts executing the scheduler's tasks. to be called once all tasks
+    // were added.
+    void init();
+
+    Scheduler& get();
+
+    // executes the function in the context of the realtime scheduler. this
+    // must be used to change the state of the modules run by it from the
+    // outside.
+    void post(std::function<void()> const& func);
+
+private:
+#ifdef REALTIME_CORE
+    static void taskLoopHelper(void* context);
+    void taskLoop();
+
+    Scheduler _scheduler;
+    TaskHandle_t _taskHandle = nullptr;
+    ThreadSafeQueue<std::function<void()>> _messages;
+#endif
+};
+
+extern RealtimeSchedulerClass RealtimeScheduler;
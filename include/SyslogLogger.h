@@ -1,8 +1,14 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 #include <WiFiUdp.h>
+#include <WiFiClient.h>
 #include <TaskSchedulerDeclarations.h>
+#include <SyslogBatcher.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
+#include <string>
 
 class SyslogLogger {
 public:
@@ -11,23 +17,48 @@ public:
     void updateSettings(const String&& hostname);
     void write(const uint8_t *buffer, size_t size);
 
+    uint32_t getDroppedLines() const { return _batcher.getDroppedLines(); }
+
 private:
     void loop();
     void disable();
     void enable();
     bool resolveAndStart();
+    void send(char const* data, size_t size);
+    void startTcpTask();
+    void stopTcpTask();
+    static void tcpLoopHelper(void* context);
+    void tcpLoop();
+    static std::string getTimestamp();
     bool isResolved() const {
         return _address != INADDR_NONE;
     }
 
+    static constexpr uint32_t ReconnectIntervalMillis = 10 * 1000;
+    static constexpr int32_t ConnectTimeoutMillis = 500;
+    static constexpr size_t MaxPendingBatches = 8;
+
     Task _loopTask;
     std::mutex _mutex;
     WiFiUDP _udp;
     IPAddress _address;
     String _syslog_hostname;
     String _proc_id;
-    String _header;
+    SyslogBatcher _batcher;
+    SyslogBatcher::Sink _sink;
+
+    // connecting and writing to the TCP socket may block, so this is done
+    // in a task of its own, which is fed the batches through a queue.
+    WiFiClient _tcp;
+    TaskHandle_t _tcpTaskHandle = nullptr;
+    std::atomic<bool> _tcpTaskDone = false;
+    std::atomic<bool> _tcpConnected = false;
+    bool _stopTcp = false;
+    std::deque<std::string> _tcpQueue;
+    std::mutex _tcpMutex;
+    std::condition_variable _tcpCv;
     uint16_t _port;
+    bool _useTcp;
     bool _enabled;
 };
 
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <TaskSchedulerDeclarations.h>
+
+#ifdef TASK_PROFILER
+
+#ifndef _TASK_EXPOSE_CHAIN
+#error "TASK_PROFILER requires _TASK_EXPOSE_CHAIN to be defined"
+#endif
+
+#include <Arduino.h>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// measures the execution time of the tasks run by the scheduler. a probe task
+// is inserted after each task in the scheduler's chain. as the scheduler
+// executes the tasks in the order of the chain, the time passed since the
+// previous probe ran is the time the task in between took, if it did run
+// during this pass at all (its run counter changed).
+// only used if the firmware is built with TASK_PROFILER.
+class TaskProfilerClass {
+public:
+    struct Report {
+        String name;
+        uint32_t interval; // ms, zero if the task runs on every pass
+        uint32_t calls;
+        uint64_t totalUs;
+        uint32_t maxUs;
+        uint32_t p99Us;
+        uint32_t overruns;
+    };
+
+    // assigns the label to all tasks that were added to the scheduler since
+    // the last call. if there are several, they are numbered.
+    void nameNewTasks(Scheduler& scheduler, char const* label);
+
+    // inserts the probes. to be called once all tasks were added.
+    void init(Scheduler& scheduler);
+
+    std::vector<Report> getReports() const;
+
+    // statistics of complete passes through the scheduler's chain
+    Report getLoopReport() const;
+
+    // an execution taking longer than this is an overrun, even if the task's
+    // interval is longer, as it delays all other tasks by as much.
+    static constexpr uint32_t OverrunThresholdUs = 10 * 1000;
+
+private:
+    // half-octave buckets up to 2^24 us (about 17 s)
+    static constexpr size_t HistogramBuckets = 48;
+
+    struct Stats {
+        uint32_t calls = 0;
+        uint64_t totalUs = 0;
+        uint32_t maxUs = 0;
+        uint32_t overruns = 0;
+        std::array<uint16_t, HistogramBuckets> histogram = {};
+
+        void record(uint32_t us, uint32_t budgetUs);
+        uint32_t getPercentile(float fraction) const;
+    };
+
+    struct Entry {
+        Task* pTask;
+        String name;
+        std::unique_ptr<Task> upProbe;
+        unsigned long lastRunCounter = 0;
+        Stats stats;
+    };
+
+    Entry& addEntry(Task* pTask, String const& name);
+    Entry* findEntry(Task* pTask);
+    void insertProbe(Entry& entry);
+    void onProbe(Entry& entry);
+    void onStartProbe();
+    Report createReport(String const& name, uint32_t interval, Stats const& stats) const;
+
+    static size_t getBucket(uint32_t us);
+    static uint32_t getBucketUpperBound(size_t bucket);
+
+    Scheduler* _pScheduler = nullptr;
+    std::unique_ptr<Task> _upStartProbe;
+    Task* _pLastProbe = nullptr;
+    std::vector<std::unique_ptr<Entry>> _entries;
+    uint32_t _lastProbeUs = 0;
+    uint32_t _passStartUs = 0;
+    bool _passStarted = false;
+    Stats _loopStats;
+    mutable std::mutex _mutex;
+};
+
+#else
+
+// the profiler is compiled out, all calls are optimized away
+class TaskProfilerClass {
+public:
+    void nameNewTasks(Scheduler&, char const*) { }
+    void init(Scheduler&) { }
+};
+
+#endif
+
+extern TaskProfilerClass TaskProfiler;
@@ -96,4 +96,8 @@ enum WebApiError {
 
     HardwareBase = 12000,
     HardwarePinMappingLength,
+
+    HistoryBase = 13000,
+    HistoryInvalidInterval,
+    HistoryInvalidMaxSize,
 };
@@ -0,0 +1,16 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <ESPAsyncWebServer.h>
+#include <TaskSchedulerDeclarations.h>
+
+class WebApiHistoryClass {
+public:
+    void init(AsyncWebServer& server, Scheduler& scheduler);
+
+private:
+    void onHistoryStatus(AsyncWebServerRequest* request);
+    void onHistoryLog(AsyncWebServerRequest* request);
+    void onHistoryAdminGet(AsyncWebServerRequest* request);
+    void onHistoryAdminPost(AsyncWebServerRequest* request);
+};
@@ -12,6 +12,7 @@ public:
 
 private:
     void onStatus(AsyncWebServerRequest* request);
+    void onSamples(AsyncWebServerRequest* request);
     void onAdminGet(AsyncWebServerRequest* request);
     void onAdminPost(AsyncWebServerRequest* request);
     void onTestHttpJsonRequest(AsyncWebServerRequest* request);
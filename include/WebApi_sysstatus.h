@@ -10,4 +10,7 @@ public:
 
 private:
     void onSystemStatus(AsyncWebServerRequest* request);
+#ifdef TASK_PROFILER
+    void onTasksStatus(AsyncWebServerRequest* request);
+#endif
 };
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include "WebappManifest.h"
 #include <ESPAsyncWebServer.h>
 #include <TaskSchedulerDeclarations.h>
 
@@ -9,5 +10,6 @@ public:
     void init(AsyncWebServer& server, Scheduler& scheduler);
 
 private:
-    void responseBinaryDataWithETagCache(AsyncWebServerRequest* request, const String &contentType, const String &contentEncoding, const uint8_t *content, size_t len);
+    static webapp_asset_t const* findAsset(char const* path);
+    static void responseAsset(AsyncWebServerRequest* request, webapp_asset_t const& asset);
 };
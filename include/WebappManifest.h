@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// describes a file embedded into the firmware. the table of all embedded
+// webapp files is generated at build time by pio-scripts/compile_webapp.py.
+typedef struct {
+    const char* path; // URL path, e.g., "/js/app.js"
+    const char* content_type;
+    const char* encoding; // content encoding of data, "" if uncompressed
+    const char* etag; // including the quotes
+    const uint8_t* data_start;
+    const uint8_t* data_end;
+
+    // optional brotli compressed variant, NULL if not available
+    const uint8_t* br_data;
+    size_t br_size;
+    const char* br_etag;
+} webapp_asset_t;
+
+extern const webapp_asset_t webapp_assets[];
+extern const size_t webapp_assets_count;
+
+#ifdef __cplusplus
+}
+#endif
@@ -10,6 +10,8 @@ class HassIntegration;
 
 class Provider {
 public:
+    virtual ~Provider() = default;
+
     // returns true if the provider is ready for use, false otherwise
     virtual bool init(bool verboseLogging) = 0;
     virtual void deinit() = 0;
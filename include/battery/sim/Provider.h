@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <memory>
+#include <battery/Provider.h>
+#include <battery/sim/Stats.h>
+
+namespace Batteries::Sim {
+
+// reports the battery of the closed-loop DPL simulation (DPL_SIM). it
+// replaces whatever battery provider is configured.
+class Provider : public ::Batteries::Provider {
+public:
+    Provider() = default;
+
+    bool init(bool verboseLogging) final;
+    void deinit() final { }
+    void loop() final;
+    std::shared_ptr<::Batteries::Stats> getStats() const final { return _stats; }
+    std::shared_ptr<HassIntegration> getHassIntegration() final { return nullptr; }
+
+private:
+    uint32_t _lastUpdate = 0;
+    std::shared_ptr<Stats> _stats = std::make_shared<Stats>();
+};
+
+} // namespace Batteries::Sim
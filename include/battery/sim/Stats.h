@@ -0,0 +1,15 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <battery/Stats.h>
+
+namespace Batteries::Sim {
+
+class Stats : public ::Batteries::Stats {
+friend class Provider;
+
+public:
+    bool supportsAlarmsAndWarnings() const final { return false; }
+};
+
+} // namespace Batteries::Sim
@@ -24,6 +24,7 @@
 
 #define SYSLOG_ENABLED false
 #define SYSLOG_PORT 514
+#define SYSLOG_USE_TCP false
 
 #define NTP_SERVER_OLD "pool.ntp.org"
 #define NTP_SERVER "opendtu.pool.ntp.org"
@@ -124,6 +125,10 @@
 #define POWERMETER_POLLING_INTERVAL 10
 #define POWERMETER_SOURCE 0
 #define POWERMETER_SDMADDRESS 1
+#define POWERMETER_UDP_VICTRON_ADAPTIVE_POLLING false
+#define POWERMETER_FUSION_FAST_SOURCE 5
+#define POWERMETER_FUSION_SLOW_SOURCE 6
+#define POWERMETER_FUSION_CORRECTION_TIME_CONSTANT 30
 
 #define HTTP_REQUEST_TIMEOUT_MS 1000
 
@@ -150,6 +155,9 @@
 #define POWERLIMITER_FULL_SOLAR_PASSTHROUGH_SOC 100
 #define POWERLIMITER_FULL_SOLAR_PASSTHROUGH_START_VOLTAGE 66.0
 #define POWERLIMITER_FULL_SOLAR_PASSTHROUGH_STOP_VOLTAGE 66.0
+#define POWERLIMITER_PREDICTIVE_ENABLED false
+#define POWERLIMITER_RAMP_RATE_LIMIT 0
+#define POWERLIMITER_FAILSAFE_ENABLED false
 
 #define BATTERY_ENABLED false
 #define BATTERY_PROVIDER 0 // Pylontech CAN receiver
@@ -184,4 +192,12 @@
 #define HUAWEI_AUTO_POWER_STOP_BATTERYSOC_THRESHOLD 95
 #define HUAWEI_AUTO_POWER_TARGET_POWER_CONSUMPTION 0
 
+#define HISTORY_ENABLED false
+#define HISTORY_INTERVAL 60U
+#define HISTORY_MAX_SIZE_KB 64U
+#define HISTORY_INTERVAL_MIN 10
+#define HISTORY_INTERVAL_MAX 3600
+#define HISTORY_MAX_SIZE_KB_MIN 8 // a single segment
+#define HISTORY_MAX_SIZE_KB_MAX 128 // leaves room on the smallest LittleFS partition
+
 #define VERBOSE_LOGGING true
@@ -5,7 +5,7 @@
 #include <array>
 #include <mutex>
 #include <memory>
-#include <queue>
+#include <optional>
 #include <cstdint>
 #include <gridcharger/huawei/DataPoints.h>
 
@@ -29,8 +29,24 @@ public:
 
     std::unique_ptr<DataPointContainer> getCurrentData();
 
+    struct TxStats {
+        size_t pending;      // settings waiting to be sent
+        uint32_t sent;       // parameter messages put on the bus
+        uint32_t suppressed; // writes dropped as they would not change anything
+        uint32_t coalesced;  // writes replaced by a newer value before being sent
+        uint32_t failed;     // failed attempts to send a parameter message
+    };
+    TxStats getTxStats() const;
+
     static uint32_t constexpr DataRequestIntervalMillis = 2500;
 
+    // writing the same value again is suppressed for this long. the value
+    // is still sent regularly in case a message was lost on the bus.
+    static uint32_t constexpr RepeatIntervalMillis = 10000;
+
+    // minimum time between two messages changing the same setting
+    static uint32_t constexpr MinSendIntervalMillis = 250;
+
 protected:
     struct CAN_MESSAGE_T {
         uint32_t canId;
@@ -61,7 +77,18 @@ private:
     std::unique_ptr<DataPointContainer> _upDataCurrent = nullptr;
     std::unique_ptr<DataPointContainer> _upDataInFlight = nullptr;
 
-    std::queue<std::pair<HardwareInterface::Setting, uint16_t>> _sendQueue;
+    // only the latest value per setting is kept until it is sent
+    struct SettingState {
+        std::optional<uint16_t> pending;
+        std::optional<uint16_t> lastSent;
+        uint32_t lastSentMillis = 0;
+    };
+    static size_t constexpr SettingCount = 4;
+    static size_t settingIndex(Setting setting);
+    static Setting settingByIndex(size_t idx);
+    std::array<SettingState, SettingCount> _settings;
+
+    TxStats _txStats = {};
 
     static unsigned constexpr _maxCurrentMultiplier = 20;
 
@@ -16,8 +16,15 @@ public:
 
     float getPowerTotal() const;
     uint32_t getLastUpdate() const;
+    uint32_t getDataAgeMillis() const { return millis() - getLastUpdate(); }
     bool isDataValid() const;
 
+    Provider::SampleHistory getSamples() const;
+    Provider::IntervalStats getIntervalStats() const;
+
+    // creates the provider of the given type, using its configuration
+    static std::unique_ptr<Provider> createProvider(Provider::Type type);
+
 private:
     void loop();
 
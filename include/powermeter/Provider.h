@@ -2,7 +2,9 @@
 #pragma once
 
 #include <atomic>
+#include <mutex>
 #include <Configuration.h>
+#include <RingBuffer.h>
 #include <powermeter/DataPoints.h>
 
 namespace PowerMeters {
@@ -19,7 +21,8 @@ public:
         SERIAL_SML = 4,
         SMAHM2 = 5,
         HTTP_SML = 6,
-        UDP_VICTRON = 7
+        UDP_VICTRON = 7,
+        FUSION = 8
     };
 
     // returns true if the provider is ready for use, false otherwise
@@ -32,6 +35,28 @@ public:
     uint32_t getLastUpdate() const { return _dataCurrent.getLastUpdate(); }
     void mqttLoop() const;
 
+    struct Sample {
+        uint32_t timestamp; // millis() when the reading was received
+        float power;
+    };
+
+    static constexpr size_t SampleHistorySize = 64;
+    using SampleHistory = RingBuffer<Sample, SampleHistorySize>;
+
+    // statistics of the time between consecutive readings (ms) found in
+    // the sample history
+    struct IntervalStats {
+        size_t count = 0;
+        float mean = 0;
+        float jitter = 0; // standard deviation
+        uint32_t min = 0;
+        uint32_t max = 0;
+        uint32_t p90 = 0; // 90th percentile, not affected by single outages
+    };
+
+    SampleHistory getSamples() const;
+    IntervalStats getIntervalStats() const;
+
 protected:
     Provider() {
         auto const& config = Configuration.get();
@@ -42,8 +67,16 @@ protected:
 
     DataPointContainer _dataCurrent;
 
+    // adds the current reading to the sample history. to be called by the
+    // providers whenever they stored a new reading, from any context, but
+    // not while holding the lock of _dataCurrent.
+    void recordSample();
+
 private:
     mutable uint32_t _lastMqttPublish = 0;
+
+    mutable std::mutex _samplesMutex;
+    SampleHistory _samples;
 };
 
 } // namespace PowerMeters
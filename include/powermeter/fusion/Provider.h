@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <powermeter/Provider.h>
+
+namespace PowerMeters::Fusion {
+
+// combines a power meter which updates fast but is inaccurate (noise,
+// offset) with one which is accurate but updates slowly. the reported power
+// follows the fast meter's readings, corrected by the offset between both
+// meters. the offset is estimated whenever the slow meter updates, by
+// comparing its reading with the average of the fast meter's readings since
+// its previous update. if the fast meter fails, the slow meter's readings
+// are reported as they are. the age of the reported data is the age of the
+// meter reading it is based on.
+class Provider : public ::PowerMeters::Provider {
+public:
+    explicit Provider(PowerMeterFusionConfig const& cfg);
+
+    bool init() final;
+    void loop() final;
+    bool isDataValid() const final;
+
+private:
+    void onFastUpdate();
+    void onSlowUpdate();
+    std::optional<float> getFastAverage(uint32_t from, uint32_t to) const;
+
+    // the slow meter is compared with at most this many seconds of fast
+    // meter readings, taken from the fast meter's sample history.
+    static constexpr uint32_t MaxAlignmentWindowMillis = 10 * 1000;
+
+    // the fast meter is considered to have failed if the slow meter updated
+    // and the fast meter did not for this long.
+    static constexpr uint32_t FastMeterTimeoutMillis = 5 * 1000;
+
+    PowerMeterFusionConfig const _cfg;
+    std::unique_ptr<::PowerMeters::Provider> _upFast;
+    std::unique_ptr<::PowerMeters::Provider> _upSlow;
+
+    uint32_t _lastFastUpdate = 0;
+    uint32_t _lastSlowUpdate = 0;
+    std::optional<float> _oOffset;
+};
+
+} // namespace PowerMeters::Fusion
@@ -4,6 +4,7 @@
 #include <Configuration.h>
 #include <powermeter/Provider.h>
 #include <espMqttClient.h>
+#include <MqttSubscribeParser.h>
 #include <vector>
 #include <mutex>
 #include <array>
@@ -28,7 +29,9 @@ private:
 
     PowerMeterMqttConfig const _cfg;
 
-    std::vector<String> _mqttSubscriptions;
+    // the same topic may be used for multiple values, hence we need to
+    // unsubscribe each individual callback
+    std::vector<MqttSubscribeParser::handle_t> _mqttSubscriptions;
 };
 
 } // namespace PowerMeters::Json::Mqtt
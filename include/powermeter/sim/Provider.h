@@ -0,0 +1,16 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <powermeter/Provider.h>
+
+namespace PowerMeters::Sim {
+
+// reports the grid power of the closed-loop DPL simulation (DPL_SIM). it
+// replaces whatever power meter is configured.
+class Provider : public ::PowerMeters::Provider {
+public:
+    bool init() final { return true; }
+    void loop() final;
+};
+
+} // namespace PowerMeters::Sim
@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <WiFiUdp.h>
+
+namespace PowerMeters::Udp {
+
+// Modbus TCP framing (MBAP header) over UDP. several requests may be in
+// flight at the same time, responses are matched to their request by the
+// transaction ID. the round-trip time of every transaction is measured and
+// used to detect transactions that will not be answered anymore.
+class ModbusClient {
+public:
+    struct Response {
+        uint16_t transactionId;
+        uint16_t address; // first register
+        uint16_t count; // number of registers
+        uint8_t const* pData; // register values, valid until the next receive()
+        uint32_t rttMicros;
+    };
+
+    ModbusClient() = default;
+    ~ModbusClient();
+
+    ModbusClient(ModbusClient const&) = delete;
+    ModbusClient& operator=(ModbusClient const&) = delete;
+
+    bool begin(IPAddress const& server, uint16_t port = DefaultPort);
+    void end();
+
+    // sends a request to read holding registers (function code 3). returns
+    // the transaction ID, or nothing if too many requests are in flight.
+    std::optional<uint16_t> readHoldingRegisters(uint8_t unitId, uint16_t address, uint16_t count);
+
+    // reads all datagrams received so far and returns the first valid
+    // response. expires requests that were not answered in time.
+    std::optional<Response> receive();
+
+    size_t getInFlight() const;
+
+    // smoothed round-trip time and its mean deviation (RFC 6298), valid
+    // once a response was received
+    bool hasRtt() const { return _rttValid; }
+    uint32_t getSmoothedRttMicros() const { return _srttMicros; }
+    uint32_t getRttVariationMicros() const { return _rttVarMicros; }
+
+    uint32_t getTimeoutMicros() const;
+    uint32_t getTimeouts() const { return _timeouts; }
+
+    static constexpr uint16_t DefaultPort = 502;
+    static constexpr size_t MaxInFlight = 4;
+
+    // bounds of the time after which an unanswered request is abandoned
+    static constexpr uint32_t MinTimeoutMicros = 100 * 1000;
+    static constexpr uint32_t MaxTimeoutMicros = 3 * 1000 * 1000;
+
+    // the maximum size of a Modbus TCP ADU
+    static constexpr size_t MaxAduSize = 260;
+
+private:
+    struct Transaction {
+        bool pending = false;
+        uint16_t id;
+        uint8_t unitId;
+        uint8_t functionCode;
+        uint16_t address;
+        uint16_t count;
+        uint32_t sentMicros;
+    };
+
+    Transaction* findTransaction(uint16_t id);
+    void expireTransactions(uint32_t now);
+    void updateRtt(uint32_t rttMicros);
+    std::optional<Response> parseResponse(size_t length, uint32_t receivedMicros);
+
+    WiFiUDP _udp;
+    IPAddress _server;
+    uint16_t _port = DefaultPort;
+    bool _started = false;
+
+    uint16_t _nextTransactionId = 1;
+    std::array<Transaction, MaxInFlight> _transactions;
+    std::array<uint8_t, MaxAduSize> _buffer;
+
+    uint32_t _srttMicros = 0;
+    uint32_t _rttVarMicros = 0;
+    bool _rttValid = false;
+    uint8_t _backoff = 0; // the timeout is doubled this many times
+    uint32_t _timeouts = 0;
+};
+
+} // namespace PowerMeters::Udp
@@ -4,6 +4,7 @@
  */
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <powermeter/Provider.h>
 
@@ -16,14 +17,39 @@ public:
     bool init() final;
     void loop() final;
 
-private:
-    void Soutput(int kanal, int index, int art, int tarif,
-            char const* name, float value, uint32_t timestamp);
+    // the meter's datagrams are about 600 bytes in size
+    static constexpr size_t DatagramBufferSize = 1024;
+
+    // bounds the time spent in a single loop() if the socket is flooded
+    static constexpr size_t MaxDatagramsPerLoop = 16;
 
-    uint8_t* decodeGroup(uint8_t* offset, uint16_t grouplen);
+    // several meters may multicast their readings into the same network.
+    // we stick to the first meter we hear from, unless it went silent.
+    static constexpr uint32_t SerialTimeoutMillis = 10 * 1000;
 
-    uint32_t _previousMillis = 0;
+private:
+    enum Measurand : uint8_t {
+        ImportTotal, ExportTotal,
+        ImportL1, ExportL1,
+        ImportL2, ExportL2,
+        ImportL3, ExportL3,
+        MeasurandCount
+    };
+
+    struct Reading {
+        std::array<float, MeasurandCount> values; // W
+        uint32_t found; // bit mask of measurands found in the datagram
+        uint32_t timestamp; // the meter's ticker (ms)
+    };
+
+    bool decodeDatagram(uint8_t const* data, size_t length, Reading& reading);
+    bool decodeGroup(uint8_t const* data, uint16_t length, Reading& reading);
+    bool acceptSerial(uint32_t serial);
+    void publish(Reading const& reading);
+
+    std::array<uint8_t, DatagramBufferSize> _buffer;
     uint32_t _serial = 0;
+    uint32_t _lastSerialMillis = 0;
 };
 
 } // namespace PowerMeters::Udp::SmaHM
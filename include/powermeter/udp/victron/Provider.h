@@ -5,25 +5,32 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
 #include <Configuration.h>
 #include <powermeter/Provider.h>
+#include <powermeter/udp/ModbusClient.h>
 
 namespace PowerMeters::Udp::Victron {
 
 class Provider : public ::PowerMeters::Provider {
 public:
     explicit Provider(PowerMeterUdpVictronConfig const& cfg);
-    ~Provider();
 
     bool init() final;
     void loop() final;
 
+    // lower bound of the polling interval if it adapts to the network
+    static constexpr uint32_t MinPollingIntervalMs = 100;
+
 private:
     void sendModbusRequest();
-    void parseModbusResponse();
+    void parseModbusResponse(ModbusClient::Response const& response);
+    uint32_t getPollingInterval() const;
 
     uint32_t _lastRequest = 0;
+    std::optional<uint16_t> _oLastTransactionId;
     PowerMeterUdpVictronConfig _cfg;
+    ModbusClient _client;
 };
 
 } // namespace PowerMeters::Udp::Victron
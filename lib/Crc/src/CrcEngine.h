@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// table-driven CRC calculation. the lookup tables are computed at compile
+// time and reside in flash. all frames handled by this project are at most
+// a few hundred bytes long, hence a single table per algorithm (processing
+// one byte per lookup) is used rather than slice-by-N tables, which would
+// need N times the flash space and cache lines for little benefit.
+namespace Crc {
+
+namespace detail {
+
+template <typename T>
+constexpr std::array<T, 256> makeTable(T poly, bool reflected)
+{
+    constexpr unsigned width = sizeof(T) * 8;
+    constexpr T topBit = static_cast<T>(1u << (width - 1));
+
+    std::array<T, 256> table = {};
+    for (unsigned i = 0; i < 256; ++i) {
+        T crc = reflected ? static_cast<T>(i) : static_cast<T>(i << (width - 8));
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            if (reflected) {
+                crc = (crc & 1) ? static_cast<T>((crc >> 1) ^ poly) : static_cast<T>(crc >> 1);
+            } else {
+                crc = (crc & topBit) ? static_cast<T>((crc << 1) ^ poly) : static_cast<T>(crc << 1);
+            }
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+} // namespace detail
+
+// Poly is given in the bit order of the algorithm, i.e., bit-reversed
+// for reflected algorithms (e.g., 0xA001 instead of 0x8005 for Modbus).
+template <typename T, T Poly, bool Reflected>
+class Engine {
+public:
+    static constexpr T update(T crc, uint8_t byte)
+    {
+        if (Reflected) {
+            return static_cast<T>((crc >> 8) ^ _table[(crc ^ byte) & 0xFF]);
+        }
+
+        constexpr unsigned shift = sizeof(T) * 8 - 8;
+        return static_cast<T>((crc << 8) ^ _table[((crc >> shift) ^ byte) & 0xFF]);
+    }
+
+    static constexpr T calculate(const uint8_t* buf, size_t len, T crc)
+    {
+        for (size_t i = 0; i < len; ++i) {
+            crc = update(crc, buf[i]);
+        }
+        return crc;
+    }
+
+private:
+    static constexpr std::array<T, 256> _table = detail::makeTable<T>(Poly, Reflected);
+};
+
+// Hoymiles radio fragments: poly 0x01, init 0x00
+using Crc8Hoymiles = Engine<uint8_t, 0x01, false>;
+
+// CRC-16/MODBUS: Hoymiles payloads and Modbus RTU, init 0xFFFF
+using Crc16Modbus = Engine<uint16_t, 0xA001, true>;
+
+// CRC-16/X-25: SML, init 0xFFFF, final XOR 0xFFFF
+using Crc16X25 = Engine<uint16_t, 0x8408, true>;
+
+// CRC-16/CCITT (MSB first): nRF24 packet CRC, init 0xFFFF
+using Crc16Ccitt = Engine<uint16_t, 0x1021, false>;
+
+// check values of the catalogued algorithms, i.e., the CRC of "123456789"
+namespace detail {
+constexpr uint8_t CheckInput[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+} // namespace detail
+
+static_assert(Crc16Modbus::calculate(detail::CheckInput, sizeof(detail::CheckInput), 0xFFFF) == 0x4B37,
+    "CRC-16/MODBUS check value mismatch");
+static_assert((Crc16X25::calculate(detail::CheckInput, sizeof(detail::CheckInput), 0xFFFF) ^ 0xFFFF) == 0x906E,
+    "CRC-16/X-25 check value mismatch");
+static_assert(Crc16Ccitt::calculate(detail::CheckInput, sizeof(detail::CheckInput), 0xFFFF) == 0x29B1,
+    "CRC-16/CCITT check value mismatch");
+
+} // namespace Crc
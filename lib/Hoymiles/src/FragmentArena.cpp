@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2022-2024 Thomas Basler and others
+ */
+#include "FragmentArena.h"
+#include "Hoymiles.h"
+#include <cstring>
+
+void FragmentArena::clear()
+{
+    _receivedMask = 0;
+    _lastId = 0;
+    _size = 0;
+}
+
+bool FragmentArena::add(const uint8_t fragment[], const uint8_t len)
+{
+    if (len < 11) {
+        Hoymiles.getMessageOutput()->printf("FATAL: (%s, %d) fragment too short\r\n", __FILE__, __LINE__);
+        return false;
+    }
+
+    const uint8_t payloadLen = len - 11;
+    if (payloadLen > MAX_FRAGMENT_PAYLOAD_SIZE) {
+        Hoymiles.getMessageOutput()->printf("FATAL: (%s, %d) fragment too large\r\n", __FILE__, __LINE__);
+        return false;
+    }
+
+    const uint8_t fragmentCount = fragment[9];
+
+    // Packets with 0x81 will be seen as 1
+    const uint8_t fragmentId = fragmentCount & 0b01111111; // fragmentId is 1 based
+
+    // 0b10000000 == 0x80
+    const bool isLast = (fragmentCount & 0b10000000) == 0b10000000;
+
+    if (fragmentId == 0) {
+        Hoymiles.getMessageOutput()->println("ERROR: fragment id zero received and ignored");
+        return false;
+    }
+
+    if (fragmentId >= MAX_RF_FRAGMENT_COUNT) {
+        Hoymiles.getMessageOutput()->printf("ERROR: fragment id %" PRId8 " is too large for buffer and ignored\r\n", fragmentId);
+        return false;
+    }
+
+    // Only the last fragment may exceed its slot, it uses the spare bytes at the end
+    if (!isLast && payloadLen > FRAGMENT_PAYLOAD_SIZE) {
+        Hoymiles.getMessageOutput()->printf("ERROR: fragment %" PRId8 " exceeds %" PRId8 " bytes and is ignored\r\n",
+            fragmentId, FRAGMENT_PAYLOAD_SIZE);
+        return false;
+    }
+
+    const uint8_t idx = fragmentId - 1;
+    memcpy(&_payload[idx * FRAGMENT_PAYLOAD_SIZE], &fragment[10], payloadLen);
+    _length[idx] = payloadLen;
+    _mainCmd[idx] = fragment[0];
+    _receivedMask |= (1 << idx);
+
+    if (isLast) {
+        _lastId = fragmentId;
+    }
+
+    return true;
+}
+
+uint8_t FragmentArena::getFirstMissingId() const
+{
+    if (_lastId == 0) {
+        return getHighestId() + 1;
+    }
+
+    const uint16_t expected = (1 << _lastId) - 1;
+    const uint16_t missing = expected & ~_receivedMask;
+    if (missing == 0) {
+        return 0;
+    }
+
+    return __builtin_ctz(missing) + 1;
+}
+
+uint8_t FragmentArena::getHighestId() const
+{
+    if (_receivedMask == 0) {
+        return 0;
+    }
+
+    return 32 - __builtin_clz(_receivedMask);
+}
+
+void FragmentArena::assemble()
+{
+    _size = 0;
+    for (uint8_t i = 0; i < _lastId; i++) {
+        // Fragments usually are full size, nothing has to be moved then
+        const uint8_t offset = i * FRAGMENT_PAYLOAD_SIZE;
+        if (offset != _size) {
+            memmove(&_payload[_size], &_payload[offset], _length[i]);
+        }
+        _size += _length[i];
+    }
+}
+
+bool FragmentArena::hasMainCmd(const uint8_t mainCmd) const
+{
+    for (uint8_t i = 0; i < _lastId; i++) {
+        if (_mainCmd[i] != mainCmd) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include "types.h"
+#include <cstdint>
+
+#define MAX_RF_FRAGMENT_COUNT 13
+
+// Collects the fragments of the response to the command currently in flight.
+// Every fragment except the last one carries FRAGMENT_PAYLOAD_SIZE bytes,
+// hence each payload is written directly to its final position within one
+// contiguous buffer. Commands get a read-only view of the whole payload once
+// all fragments were received.
+class FragmentArena {
+public:
+    // Payload size of all fragments except the last one
+    static constexpr uint8_t FRAGMENT_PAYLOAD_SIZE = 16;
+
+    // Header (10 bytes) and CRC8 (1 byte) are not part of the payload
+    static constexpr uint8_t MAX_FRAGMENT_PAYLOAD_SIZE = MAX_RF_PAYLOAD_SIZE - 11;
+
+    void clear();
+
+    // Stores the payload of a raw fragment as received from the radio.
+    // Returns false if the fragment was ignored.
+    bool add(const uint8_t fragment[], const uint8_t len);
+
+    // Returns zero if all fragments up to the last one were received or the
+    // 1 based id of the first missing fragment otherwise
+    uint8_t getFirstMissingId() const;
+
+    bool hasAnyFragment() const { return _receivedMask != 0; }
+    bool hasLastFragment() const { return _lastId != 0; }
+
+    // Highest fragment id received so far
+    uint8_t getHighestId() const;
+
+    // Closes gaps left by fragments shorter than FRAGMENT_PAYLOAD_SIZE. Has to
+    // be called once all fragments were received and before data() is used.
+    void assemble();
+
+    // Checks whether all fragments belong to a response to the given command
+    bool hasMainCmd(const uint8_t mainCmd) const;
+
+    uint8_t getFragmentCount() const { return _lastId; }
+    const uint8_t* data() const { return _payload; }
+    uint8_t size() const { return _size; }
+
+private:
+    static constexpr uint16_t PAYLOAD_BUFFER_SIZE = (MAX_RF_FRAGMENT_COUNT - 1) * FRAGMENT_PAYLOAD_SIZE
+        + (MAX_FRAGMENT_PAYLOAD_SIZE - FRAGMENT_PAYLOAD_SIZE);
+
+    uint8_t _payload[PAYLOAD_BUFFER_SIZE];
+    uint8_t _length[MAX_RF_FRAGMENT_COUNT - 1] = {};
+    uint8_t _mainCmd[MAX_RF_FRAGMENT_COUNT - 1] = {};
+
+    // Bit n is set if fragment n + 1 was received
+    uint16_t _receivedMask = 0;
+    uint8_t _lastId = 0;
+    uint8_t _size = 0;
+
+    static_assert(MAX_RF_FRAGMENT_COUNT - 1 <= 16, "receive bitmap too small");
+    static_assert(PAYLOAD_BUFFER_SIZE <= UINT8_MAX, "payload size has to fit into uint8_t");
+};
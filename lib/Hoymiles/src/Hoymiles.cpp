@@ -25,6 +25,10 @@ void HoymilesClass::init()
     _pollInterval = 0;
     _radioNrf.reset(new HoymilesRadio_NRF());
     _radioCmt.reset(new HoymilesRadio_CMT());
+#ifdef HOYMILES_RADIO_SIM
+    _radioSim.reset(new HoymilesRadio_Sim());
+    _radioSim->init();
+#endif
 }
 
 void HoymilesClass::initNRF(SPIClass* initialisedSpiBus, const uint8_t pinCE, const uint8_t pinIRQ)
@@ -42,6 +46,9 @@ void HoymilesClass::loop()
     std::lock_guard<std::mutex> lock(_mutex);
     _radioNrf->loop();
     _radioCmt->loop();
+#ifdef HOYMILES_RADIO_SIM
+    _radioSim->loop();
+#endif
 
     if (getNumInverters() == 0) {
         return;
@@ -148,31 +155,38 @@ void HoymilesClass::loop()
 
 std::shared_ptr<InverterAbstract> HoymilesClass::addInverter(const char* name, const uint64_t serial)
 {
+    HoymilesRadio* radioNrf = _radioNrf.get();
+    HoymilesRadio* radioCmt = _radioCmt.get();
+#ifdef HOYMILES_RADIO_SIM
+    // All inverters are emulated, regardless of the radio they would use
+    radioNrf = radioCmt = _radioSim.get();
+#endif
+
     std::shared_ptr<InverterAbstract> i = nullptr;
     if (HMT_4CH::isValidSerial(serial)) {
-        i = std::make_shared<HMT_4CH>(_radioCmt.get(), serial);
+        i = std::make_shared<HMT_4CH>(radioCmt, serial);
     } else if (HMT_6CH::isValidSerial(serial)) {
-        i = std::make_shared<HMT_6CH>(_radioCmt.get(), serial);
+        i = std::make_shared<HMT_6CH>(radioCmt, serial);
     } else if (HMS_4CH::isValidSerial(serial)) {
-        i = std::make_shared<HMS_4CH>(_radioCmt.get(), serial);
+        i = std::make_shared<HMS_4CH>(radioCmt, serial);
     } else if (HMS_2CH::isValidSerial(serial)) {
-        i = std::make_shared<HMS_2CH>(_radioCmt.get(), serial);
+        i = std::make_shared<HMS_2CH>(radioCmt, serial);
     } else if (HMS_1CH::isValidSerial(serial)) {
-        i = std::make_shared<HMS_1CH>(_radioCmt.get(), serial);
+        i = std::make_shared<HMS_1CH>(radioCmt, serial);
     } else if (HMS_1CHv2::isValidSerial(serial)) {
-        i = std::make_shared<HMS_1CHv2>(_radioCmt.get(), serial);
+        i = std::make_shared<HMS_1CHv2>(radioCmt, serial);
     } else if (HM_4CH::isValidSerial(serial)) {
-        i = std::make_shared<HM_4CH>(_radioNrf.get(), serial);
+        i = std::make_shared<HM_4CH>(radioNrf, serial);
     } else if (HM_2CH::isValidSerial(serial)) {
-        i = std::make_shared<HM_2CH>(_radioNrf.get(), serial);
+        i = std::make_shared<HM_2CH>(radioNrf, serial);
     } else if (HM_1CH::isValidSerial(serial)) {
-        i = std::make_shared<HM_1CH>(_radioNrf.get(), serial);
+        i = std::make_shared<HM_1CH>(radioNrf, serial);
     } else if (HERF_1CH::isValidSerial(serial)) {
-        i = std::make_shared<HERF_1CH>(_radioNrf.get(), serial);
+        i = std::make_shared<HERF_1CH>(radioNrf, serial);
     } else if (HERF_2CH::isValidSerial(serial)) {
-        i = std::make_shared<HERF_2CH>(_radioNrf.get(), serial);
+        i = std::make_shared<HERF_2CH>(radioNrf, serial);
     } else if (HERF_4CH::isValidSerial(serial)) {
-        i = std::make_shared<HERF_4CH>(_radioNrf.get(), serial);
+        i = std::make_shared<HERF_4CH>(radioNrf, serial);
     }
 
     if (i) {
@@ -252,8 +266,20 @@ HoymilesRadio_CMT* HoymilesClass::getRadioCmt()
     return _radioCmt.get();
 }
 
+#ifdef HOYMILES_RADIO_SIM
+HoymilesRadio_Sim* HoymilesClass::getRadioSim()
+{
+    return _radioSim.get();
+}
+#endif
+
 bool HoymilesClass::isAllRadioIdle() const
 {
+#ifdef HOYMILES_RADIO_SIM
+    if (!_radioSim.get()->isIdle()) {
+        return false;
+    }
+#endif
     return _radioNrf.get()->isIdle() && _radioCmt.get()->isIdle();
 }
 
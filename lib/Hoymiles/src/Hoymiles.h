@@ -3,6 +3,9 @@
 
 #include "HoymilesRadio_CMT.h"
 #include "HoymilesRadio_NRF.h"
+#ifdef HOYMILES_RADIO_SIM
+#include "HoymilesRadio_Sim.h"
+#endif
 #include "inverters/InverterAbstract.h"
 #include "types.h"
 #include <Print.h>
@@ -33,6 +36,9 @@ public:
 
     HoymilesRadio_NRF* getRadioNrf();
     HoymilesRadio_CMT* getRadioCmt();
+#ifdef HOYMILES_RADIO_SIM
+    HoymilesRadio_Sim* getRadioSim();
+#endif
 
     uint32_t PollInterval() const;
     void setPollInterval(const uint32_t interval);
@@ -44,6 +50,9 @@ private:
     std::vector<std::shared_ptr<InverterAbstract>> _inverters;
     std::unique_ptr<HoymilesRadio_NRF> _radioNrf;
     std::unique_ptr<HoymilesRadio_CMT> _radioCmt;
+#ifdef HOYMILES_RADIO_SIM
+    std::unique_ptr<HoymilesRadio_Sim> _radioSim;
+#endif
 
     std::mutex _mutex;
 
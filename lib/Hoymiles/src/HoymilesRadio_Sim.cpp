@@ -0,0 +1,495 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#ifdef HOYMILES_RADIO_SIM
+
+#include "HoymilesRadio_Sim.h"
+#include "Hoymiles.h"
+#include "crc.h"
+#include <algorithm>
+#include <cstring>
+
+#define SIM_FRAGMENT_SPACING 2 // ms between two fragments of a response
+#define SIM_RAMP_RATE 10 // percent of nominal power per second
+#define SIM_STATISTICS_INTERVAL (60 * 1000)
+#define SIM_EFFICIENCY 0.96
+
+// The largest model of each inverter class. The HW part numbers are
+// reported by DevInfoSimple and match the table in DevInfoParser.
+const HoymilesRadio_Sim::emulatedModel_t HoymilesRadio_Sim::emulatedModels[] = {
+    { "HM-300/350/400-1T", { 0x10, 0x10, 0x40, 0x01 }, 400 },
+    { "HM-600/700/800-2T", { 0x10, 0x11, 0x40, 0x01 }, 800 },
+    { "HM-1000/1200/1500-4T", { 0x10, 0x12, 0x30, 0x01 }, 1500 },
+    { "HMS-300/350/400/450/500-1T", { 0x10, 0x10, 0x71, 0x01 }, 500 },
+    { "HMS-450/500-1T v2", { 0x10, 0x20, 0x71, 0x01 }, 500 },
+    { "HMS-600/700/800/900/1000-2T", { 0x10, 0x21, 0x71, 0x01 }, 1000 },
+    { "HMS-1600/1800/2000-4T", { 0x10, 0x22, 0x71, 0x01 }, 2000 },
+    { "HMT-1600/1800/2000-4T", { 0x10, 0x32, 0x71, 0x01 }, 2000 },
+    { "HMT-1800/2250-6T", { 0x10, 0x33, 0x31, 0x01 }, 2250 },
+    { "HERF-300-1T", { 0x10, 0x10, 0x10, 0x01 }, 300 },
+    { "HERF-600/800-2T", { 0xF1, 0x01, 0x14, 0x01 }, 800 },
+    { "HERF-1600/1800-4T", { 0xF1, 0x01, 0x22, 0x01 }, 1800 },
+};
+
+void HoymilesRadio_Sim::init()
+{
+    _isInitialized = true;
+    Hoymiles.getMessageOutput()->println("Simulated radio initialized");
+}
+
+void HoymilesRadio_Sim::loop()
+{
+    if (!_isInitialized) {
+        return;
+    }
+
+    while (!_rxBuffer.empty() && static_cast<int32_t>(millis() - _rxBuffer.front().due) >= 0) {
+        fragment_t f;
+        memcpy(f.fragment, _rxBuffer.front().data, _rxBuffer.front().len);
+        f.len = _rxBuffer.front().len;
+        f.channel = 0;
+        f.rssi = _rxBuffer.front().rssi;
+        f.wasReceived = false;
+        f.mainCmd = 0x00;
+        _rxBuffer.pop_front();
+
+        if (!checkFragmentCrc(f)) {
+            Hoymiles.getMessageOutput()->println("Sim: dropping fragment with invalid CRC8");
+            continue;
+        }
+
+        std::shared_ptr<InverterAbstract> inv = Hoymiles.getInverterByFragment(f);
+        if (nullptr == inv) {
+            Hoymiles.getMessageOutput()->println("Inverter Not found!");
+            continue;
+        }
+
+        Hoymiles.getVerboseMessageOutput()->print("RX Sim --> ");
+        dumpBuf(f.fragment, f.len, false);
+        Hoymiles.getVerboseMessageOutput()->printf("| %" PRId8 " dBm\r\n", f.rssi);
+
+        inv->addRxFragment(f.fragment, f.len, f.rssi);
+        _stats.payloadBytes += f.len - 11;
+    }
+
+    const bool wasBusy = _busyFlag;
+    handleReceivedPackage();
+    if (wasBusy && !_busyFlag) {
+        _stats.commandsCompleted++;
+    }
+
+    trackLimitAcks();
+
+    if (millis() - _lastStatisticsPrint > SIM_STATISTICS_INTERVAL) {
+        printStatistics(Hoymiles.getVerboseMessageOutput());
+        _lastStatisticsPrint = millis();
+    }
+}
+
+void HoymilesRadio_Sim::setLinkParameters(const uint64_t serial, const LinkParameters& params)
+{
+    getEmulatedInverter(serial).link = params;
+}
+
+void HoymilesRadio_Sim::setIrradiation(const float irradiation)
+{
+    _irradiation = std::clamp<float>(irradiation, 0, 1);
+}
+
+void HoymilesRadio_Sim::setDcSource(const uint64_t serial, const float power, const float voltage)
+{
+    EmulatedInverter& emu = getEmulatedInverter(serial);
+    emu.dcPower = power;
+    emu.dcVoltage = voltage;
+}
+
+float HoymilesRadio_Sim::getAcPower(const uint64_t serial)
+{
+    std::shared_ptr<InverterAbstract> inv = Hoymiles.getInverterBySerial(serial);
+    if (nullptr == inv) {
+        return 0;
+    }
+
+    EmulatedInverter& emu = getEmulatedInverter(serial);
+    updateEmulatedInverter(*inv, emu);
+    return emu.acPower;
+}
+
+const HoymilesRadio_Sim::Statistics& HoymilesRadio_Sim::getStatistics() const
+{
+    return _stats;
+}
+
+void HoymilesRadio_Sim::resetStatistics()
+{
+    _stats = {};
+}
+
+void HoymilesRadio_Sim::printStatistics(Print* output) const
+{
+    output->printf("Sim: %" PRIu32 " packets sent, %" PRIu32 " commands completed, %" PRIu32 "/%" PRIu32 " fragments lost\r\n",
+        _stats.packetsSent, _stats.commandsCompleted, _stats.fragmentsLost, _stats.fragmentsSent);
+
+    // Share of the time on air which carried response payload
+    const float efficiency = _stats.airtimeUs > 0 ? 100.0 * _stats.payloadBytes * 32 / _stats.airtimeUs : 0;
+    output->printf("Sim: airtime %" PRIu32 " ms, efficiency %.1f %%\r\n", _stats.airtimeUs / 1000, efficiency);
+
+    output->printf("Sim: %" PRIu32 " limit commands sent\r\n", _stats.limitCommands);
+
+    if (_stats.limitAcks > 0) {
+        output->printf("Sim: %" PRIu32 " limits acknowledged after %" PRIu32 " ms on average, %" PRIu32 " ms max\r\n",
+            _stats.limitAcks, _stats.limitAckTimeTotal / _stats.limitAcks, _stats.limitAckTimeMax);
+    }
+}
+
+void HoymilesRadio_Sim::sendEsbPacket(CommandAbstract& cmd)
+{
+    cmd.incrementSendCount();
+
+    cmd.setRouterAddress(DtuSerial().u64);
+
+    Hoymiles.getVerboseMessageOutput()->printf("TX %s Sim --> ", cmd.getCommandName().c_str());
+    cmd.dumpDataPayload(Hoymiles.getVerboseMessageOutput());
+
+    const uint8_t* request = cmd.getDataPayload();
+    const uint8_t len = cmd.getDataSize();
+
+    _stats.packetsSent++;
+    _stats.airtimeUs += getAirtime(len);
+
+    if (len > 10 && request[0] == 0x51 && request[10] == 0x0b && cmd.getSendCount() == 1) {
+        _stats.limitCommands++;
+    }
+
+    _busyFlag = true;
+    _rxTimeout.set(cmd.getTimeout());
+
+    std::shared_ptr<InverterAbstract> inv = Hoymiles.getInverterBySerial(cmd.getTargetAddress());
+    if (nullptr == inv) {
+        return;
+    }
+
+    EmulatedInverter& emu = getEmulatedInverter(inv->serial());
+    const uint32_t due = millis() + emu.link.latency;
+
+    // Inverters without DC power are switched off and do not answer at all
+    if (getAvailablePower(*inv, emu) <= 0) {
+        return;
+    }
+
+    // Requests get lost as well
+    if (random(100) < emu.link.lossPercent) {
+        return;
+    }
+
+    // Retransmit request: ID, target, source and frame number only
+    if (len == 11 && request[0] == 0x15) {
+        const uint8_t frameNo = request[9] & 0x7f;
+        if (frameNo > 0 && frameNo <= emu.response.size()) {
+            transmit(emu, emu.response[frameNo - 1], due);
+        }
+        return;
+    }
+
+    updateEmulatedInverter(*inv, emu);
+
+    std::vector<uint8_t> payload;
+    uint8_t mainCmd;
+    if (!buildResponse(*inv, emu, request, len, payload, mainCmd)) {
+        return;
+    }
+
+    fragmentResponse(inv->serial(), mainCmd, payload, emu);
+    for (uint8_t i = 0; i < emu.response.size(); i++) {
+        transmit(emu, emu.response[i], due + i * SIM_FRAGMENT_SPACING);
+    }
+}
+
+HoymilesRadio_Sim::EmulatedInverter& HoymilesRadio_Sim::getEmulatedInverter(const uint64_t serial)
+{
+    return _inverters[serial];
+}
+
+void HoymilesRadio_Sim::updateEmulatedInverter(InverterAbstract& inv, EmulatedInverter& emu)
+{
+    const uint32_t now = millis();
+    const float nominal = getNominalPower(inv);
+
+    if (emu.lastUpdate == 0) {
+        emu.lastUpdate = now;
+    }
+    const float elapsed = (now - emu.lastUpdate) / 1000.0;
+    emu.lastUpdate = now;
+
+    float target = 0;
+    if (emu.producing) {
+        target = std::min(getAvailablePower(inv, emu), emu.limitPercent * nominal / 100);
+    }
+
+    // Inverters do not apply a new limit at once but ramp towards it
+    const float maxStep = nominal * SIM_RAMP_RATE / 100 * elapsed;
+    emu.acPower += std::clamp(target - emu.acPower, -maxStep, maxStep);
+    emu.yieldDay += emu.acPower * elapsed / 3600;
+}
+
+float HoymilesRadio_Sim::getAvailablePower(InverterAbstract& inv, const EmulatedInverter& emu) const
+{
+    if (emu.dcPower < 0) {
+        return _irradiation * getNominalPower(inv);
+    }
+    return emu.dcPower * SIM_EFFICIENCY;
+}
+
+uint16_t HoymilesRadio_Sim::getNominalPower(InverterAbstract& inv) const
+{
+    return getEmulatedModel(inv).maxPower;
+}
+
+const HoymilesRadio_Sim::emulatedModel_t& HoymilesRadio_Sim::getEmulatedModel(InverterAbstract& inv)
+{
+    const String type = inv.typeName();
+    for (auto& model : emulatedModels) {
+        if (type == model.typeName) {
+            return model;
+        }
+    }
+    return emulatedModels[0];
+}
+
+bool HoymilesRadio_Sim::buildResponse(InverterAbstract& inv, EmulatedInverter& emu, const uint8_t* request, const uint8_t len, std::vector<uint8_t>& payload, uint8_t& mainCmd)
+{
+    if (len < 12) {
+        return false;
+    }
+
+    mainCmd = request[0] | 0x80;
+
+    if (request[0] == 0x51) {
+        // DevControl: sub command, limit, limit type
+        switch (request[10]) {
+        case 0x00: // TurnOn
+            emu.producing = true;
+            break;
+        case 0x01: // TurnOff
+            emu.producing = false;
+            break;
+        case 0x0b: { // ActivePowerControl
+            const float limit = ((static_cast<uint16_t>(request[12]) << 8) | request[13]) / 10.0;
+            const uint16_t type = (static_cast<uint16_t>(request[14]) << 8) | request[15];
+            const bool relative = (type & 0x0001) == 0x0001;
+            emu.limitPercent = relative ? limit : limit / getNominalPower(inv) * 100;
+            emu.limitPercent = std::clamp<float>(emu.limitPercent, 0, 100);
+            if (emu.limitPendingSince == 0) {
+                emu.limitPendingSince = millis();
+            }
+            break;
+        }
+        default:
+            break;
+        }
+        payload = { request[10], 0x00 };
+        return true;
+    }
+
+    if (request[0] != 0x15) {
+        // ChannelChange is never answered
+        return false;
+    }
+
+    switch (request[10]) {
+    case 0x00: // DevInfoSimple
+        buildDevInfoSimple(inv, payload);
+        return true;
+    case 0x01: // DevInfoAll: fw version, build year, month/date, hour/minute, bootloader
+        payload = { 0x27, 0x1C, 0x07, 0xE5, 0x04, 0x01, 0x07, 0x2D, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00 };
+        return true;
+    case 0x02: // GridOnProFilePara: unknown profile without sections
+        payload = { 0x00, 0x00, 0x10, 0x00, 0xff, 0x00, 0x00, 0x00 };
+        return true;
+    case 0x05: { // SystemConfigPara
+        const uint16_t limit = emu.limitPercent * 10;
+        payload.assign(SYSTEM_CONFIG_PARA_SIZE, 0x00);
+        payload[2] = limit >> 8;
+        payload[3] = limit;
+        return true;
+    }
+    case 0x0b: // RealTimeRunData
+        buildRealTimeRunData(inv, emu, payload);
+        return true;
+    case 0x11: // AlarmData: no entries
+        payload = { 0x00, 0x01 };
+        return true;
+    default:
+        return false;
+    }
+}
+
+void HoymilesRadio_Sim::buildRealTimeRunData(InverterAbstract& inv, EmulatedInverter& emu, std::vector<uint8_t>& payload)
+{
+    const uint8_t dcChannels = std::max<uint8_t>(1, inv.Statistics()->getChannelsByType(TYPE_DC).size());
+    const float pdc = emu.acPower / SIM_EFFICIENCY / dcChannels;
+    const float udc = emu.dcVoltage;
+
+    payload.assign(inv.Statistics()->getExpectedByteCount(), 0x00);
+
+    const byteAssign_t* assignment = inv.getByteAssignment();
+    for (uint8_t i = 0; i < inv.getByteAssignmentSize(); i++) {
+        const byteAssign_t& a = assignment[i];
+        if (a.div == CMD_CALC) {
+            continue;
+        }
+
+        float value = 0;
+        switch (a.fieldId) {
+        case FLD_UDC:
+            value = udc;
+            break;
+        case FLD_IDC:
+            value = pdc / udc;
+            break;
+        case FLD_PDC:
+            value = pdc;
+            break;
+        case FLD_YD:
+            value = emu.yieldDay / dcChannels;
+            break;
+        case FLD_YT:
+            value = emu.yieldDay / dcChannels / 1000;
+            break;
+        case FLD_UAC:
+        case FLD_UAC_1N:
+        case FLD_UAC_2N:
+        case FLD_UAC_3N:
+            value = 230;
+            break;
+        case FLD_UAC_12:
+        case FLD_UAC_23:
+        case FLD_UAC_31:
+            value = 400;
+            break;
+        case FLD_IAC:
+            value = emu.acPower / 230;
+            break;
+        case FLD_IAC_1:
+        case FLD_IAC_2:
+        case FLD_IAC_3:
+            value = emu.acPower / 3 / 230;
+            break;
+        case FLD_PAC:
+            value = emu.acPower;
+            break;
+        case FLD_F:
+            value = 50;
+            break;
+        case FLD_T:
+            value = 30;
+            break;
+        case FLD_PF:
+            value = 1;
+            break;
+        default:
+            break;
+        }
+
+        uint32_t raw = static_cast<int32_t>(value * a.div);
+        for (int8_t b = a.num - 1; b >= 0; b--) {
+            if (static_cast<size_t>(a.start + b) < payload.size()) {
+                payload[a.start + b] = raw & 0xff;
+            }
+            raw >>= 8;
+        }
+    }
+}
+
+void HoymilesRadio_Sim::buildDevInfoSimple(InverterAbstract& inv, std::vector<uint8_t>& payload) const
+{
+    const emulatedModel_t& model = getEmulatedModel(inv);
+    payload = { 0x27, 0x1C, model.hwPart[0], model.hwPart[1], model.hwPart[2], model.hwPart[3], 0x01, 0x00, 0x0A, 0x00, 0x20, 0x01, 0x00, 0x00 };
+}
+
+void HoymilesRadio_Sim::fragmentResponse(const uint64_t serial, const uint8_t mainCmd, const std::vector<uint8_t>& payload, EmulatedInverter& emu) const
+{
+    std::vector<uint8_t> data(payload);
+    const uint16_t crc = crc16(data.data(), data.size());
+    data.push_back(crc >> 8);
+    data.push_back(crc);
+
+    serial_u inverterId;
+    inverterId.u64 = serial;
+
+    emu.response.clear();
+    for (size_t offs = 0; offs < data.size(); offs += FragmentArena::FRAGMENT_PAYLOAD_SIZE) {
+        const uint8_t chunk = std::min<size_t>(FragmentArena::FRAGMENT_PAYLOAD_SIZE, data.size() - offs);
+        const bool isLast = offs + chunk >= data.size();
+
+        std::vector<uint8_t> frame;
+        frame.push_back(mainCmd);
+        for (int8_t b = 3; b >= 0; b--) {
+            frame.push_back(inverterId.b[b]);
+        }
+        for (int8_t b = 3; b >= 0; b--) {
+            frame.push_back(_dtuSerial.b[b]);
+        }
+        frame.push_back((emu.response.size() + 1) | (isLast ? 0x80 : 0x00));
+        frame.insert(frame.end(), data.begin() + offs, data.begin() + offs + chunk);
+        frame.push_back(crc8(frame.data(), frame.size()));
+
+        emu.response.push_back(std::move(frame));
+    }
+}
+
+void HoymilesRadio_Sim::transmit(EmulatedInverter& emu, const std::vector<uint8_t>& frame, const uint32_t due)
+{
+    _stats.fragmentsSent++;
+    _stats.airtimeUs += getAirtime(frame.size());
+
+    if (random(100) < emu.link.lossPercent) {
+        _stats.fragmentsLost++;
+        return;
+    }
+
+    PendingFragment f;
+    f.due = due + random(emu.link.jitter + 1);
+    f.len = std::min<size_t>(frame.size(), MAX_RF_PAYLOAD_SIZE);
+    memcpy(f.data, frame.data(), f.len);
+    f.rssi = emu.link.rssi + random(-3, 4);
+
+    // Keep the buffer ordered by arrival time
+    auto pos = std::upper_bound(_rxBuffer.begin(), _rxBuffer.end(), f.due,
+        [](const uint32_t due, const PendingFragment& p) { return static_cast<int32_t>(due - p.due) < 0; });
+    _rxBuffer.insert(pos, f);
+}
+
+void HoymilesRadio_Sim::trackLimitAcks()
+{
+    for (auto& [serial, emu] : _inverters) {
+        if (emu.limitPendingSince == 0) {
+            continue;
+        }
+
+        std::shared_ptr<InverterAbstract> inv = Hoymiles.getInverterBySerial(serial);
+        if (nullptr == inv) {
+            emu.limitPendingSince = 0;
+            continue;
+        }
+
+        const LastCommandSuccess state = inv->SystemConfigPara()->getLastLimitCommandSuccess();
+        if (state == CMD_PENDING) {
+            continue;
+        }
+
+        if (state == CMD_OK) {
+            const uint32_t duration = millis() - emu.limitPendingSince;
+            _stats.limitAcks++;
+            _stats.limitAckTimeTotal += duration;
+            _stats.limitAckTimeMax = std::max(_stats.limitAckTimeMax, duration);
+        }
+        emu.limitPendingSince = 0;
+    }
+}
+
+uint32_t HoymilesRadio_Sim::getAirtime(const uint8_t len)
+{
+    // Preamble, address, packet control field, payload and CRC16 at 4 us per bit
+    return ((1 + 5 + len + 2) * 8 + 9) * 4;
+}
+
+#endif // HOYMILES_RADIO_SIM
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include "HoymilesRadio.h"
+#include "commands/CommandAbstract.h"
+#include "types.h"
+#include <Print.h>
+#include <deque>
+#include <map>
+#include <vector>
+
+// Radio backend which emulates the inverters instead of talking to a NRF24
+// or CMT2300A module. Responses are generated for the inverter models known
+// to this library and are delivered with configurable packet loss, latency
+// and RSSI. This allows to exercise the command queue, the retransmit logic
+// and everything built on top of it without any hardware.
+// Only used if the firmware is built with HOYMILES_RADIO_SIM.
+class HoymilesRadio_Sim : public HoymilesRadio {
+public:
+    struct LinkParameters {
+        uint8_t lossPercent = 10; // per fragment, applies to requests as well
+        uint16_t latency = 20; // ms until the first fragment of a response arrives
+        uint16_t jitter = 10; // ms, fragments may arrive out of order
+        int8_t rssi = -60; // dBm
+    };
+
+    struct Statistics {
+        uint32_t packetsSent; // requests, resends and retransmit requests
+        uint32_t commandsCompleted;
+        uint32_t fragmentsSent;
+        uint32_t fragmentsLost;
+        uint32_t payloadBytes; // response payload delivered to the inverters
+        uint32_t airtimeUs; // time on air of all packets, modelled as ESB at 250 kbit/s
+        uint32_t limitCommands; // first transmissions of limit commands only
+        uint32_t limitAcks;
+        uint32_t limitAckTimeTotal; // ms from the first transmission until the ack was handled
+        uint32_t limitAckTimeMax;
+    };
+
+    void init();
+    void loop();
+
+    void setLinkParameters(const uint64_t serial, const LinkParameters& params);
+
+    // Fraction (0 - 1) of the nominal power the emulated PV modules deliver
+    void setIrradiation(const float irradiation);
+
+    // Overrides the irradiation for inverters supplied by a battery. A
+    // negative power reverts the inverter to PV modules.
+    void setDcSource(const uint64_t serial, const float power, const float voltage);
+
+    // AC power the emulated inverter actually feeds in right now
+    float getAcPower(const uint64_t serial);
+
+    const Statistics& getStatistics() const;
+    void resetStatistics();
+    void printStatistics(Print* output) const;
+
+private:
+    typedef struct {
+        const char* typeName;
+        uint8_t hwPart[4];
+        uint16_t maxPower;
+    } emulatedModel_t;
+
+    static const emulatedModel_t emulatedModels[];
+
+    struct EmulatedInverter {
+        LinkParameters link;
+        float limitPercent = 100;
+        float acPower = 0; // W, follows the limit with a ramp
+        float yieldDay = 0; // Wh
+        bool producing = true;
+        uint32_t lastUpdate = 0;
+
+        float dcPower = -1; // W available from a battery, negative if PV powered
+        float dcVoltage = 35;
+
+        // Frames of the last response, kept for retransmit requests
+        std::vector<std::vector<uint8_t>> response;
+
+        uint32_t limitPendingSince = 0;
+    };
+
+    struct PendingFragment {
+        uint32_t due;
+        uint8_t len;
+        uint8_t data[MAX_RF_PAYLOAD_SIZE];
+        int8_t rssi;
+    };
+
+    void sendEsbPacket(CommandAbstract& cmd);
+
+    EmulatedInverter& getEmulatedInverter(const uint64_t serial);
+    void updateEmulatedInverter(InverterAbstract& inv, EmulatedInverter& emu);
+    float getAvailablePower(InverterAbstract& inv, const EmulatedInverter& emu) const; // AC
+    uint16_t getNominalPower(InverterAbstract& inv) const;
+    static const emulatedModel_t& getEmulatedModel(InverterAbstract& inv);
+
+    bool buildResponse(InverterAbstract& inv, EmulatedInverter& emu, const uint8_t* request, const uint8_t len, std::vector<uint8_t>& payload, uint8_t& mainCmd);
+    void buildRealTimeRunData(InverterAbstract& inv, EmulatedInverter& emu, std::vector<uint8_t>& payload);
+    void buildDevInfoSimple(InverterAbstract& inv, std::vector<uint8_t>& payload) const;
+    void fragmentResponse(const uint64_t serial, const uint8_t mainCmd, const std::vector<uint8_t>& payload, EmulatedInverter& emu) const;
+    void transmit(EmulatedInverter& emu, const std::vector<uint8_t>& frame, const uint32_t due);
+
+    void trackLimitAcks();
+
+    static uint32_t getAirtime(const uint8_t len);
+
+    std::map<uint64_t, EmulatedInverter> _inverters;
+    std::deque<PendingFragment> _rxBuffer;
+    float _irradiation = 0.8;
+
+    Statistics _stats = {};
+    uint32_t _lastStatisticsPrint = 0;
+};
@@ -18,7 +18,7 @@ public:
     virtual QueueInsertType getQueueInsertType() const { return QueueInsertType::RemoveOldest; }
     virtual bool areSameParameter(CommandAbstract* other);
 
-    virtual bool handleResponse(const fragment_t fragment[], const uint8_t max_fragment_id);
+    virtual bool handleResponse(const FragmentArena& fragments);
     virtual void gotTimeout();
 
     void setActivePowerLimit(const float limit, const PowerLimitControlType type = RelativNonPersistent);
@@ -9,6 +9,6 @@ public:
 
     virtual String getCommandName() const;
 
-    virtual bool handleResponse(const fragment_t fragment[], const uint8_t max_fragment_id);
+    virtual bool handleResponse(const FragmentArena& fragments);
     virtual void gotTimeout();
 };
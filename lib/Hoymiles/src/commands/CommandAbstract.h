@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include "FragmentArena.h"
 #include "types.h"
 #include <Stream.h>
 #include <cstdint>
@@ -49,7 +50,7 @@ public:
 
     virtual CommandAbstract* getRequestFrameCommand(const uint8_t frame_no);
 
-    virtual bool handleResponse(const fragment_t fragment[], const uint8_t max_fragment_id) = 0;
+    virtual bool handleResponse(const FragmentArena& fragments) = 0;
     virtual void gotTimeout();
 
     // Sets the amount how often the specific command is resent if all fragments where missing
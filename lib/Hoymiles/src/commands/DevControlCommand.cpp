@@ -39,13 +39,7 @@ void DevControlCommand::udpateCRC(const uint8_t len)
     _payload[10 + len + 1] = static_cast<uint8_t>(crc);
 }
 
-bool DevControlCommand::handleResponse(const fragment_t fragment[], const uint8_t max_fragment_id)
+bool DevControlCommand::handleResponse(const FragmentArena& fragments)
 {
-    for (uint8_t i = 0; i < max_fragment_id; i++) {
-        if (fragment[i].mainCmd != (_payload[0] | 0x80)) {
-            return false;
-        }
-    }
-
-    return true;
+    return fragments.hasMainCmd(_payload[0] | 0x80);
 }
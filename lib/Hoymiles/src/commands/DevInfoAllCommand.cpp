@@ -34,21 +34,17 @@ String DevInfoAllCommand::getCommandName() const
     return "DevInfoAll";
 }
 
-bool DevInfoAllCommand::handleResponse(const fragment_t fragment[], const uint8_t max_fragment_id)
+bool DevInfoAllCommand::handleResponse(const FragmentArena& fragments)
 {
     // Check CRC of whole payload
-    if (!MultiDataCommand::handleResponse(fragment, max_fragment_id)) {
+    if (!MultiDataCommand::handleResponse(fragments)) {
         return false;
     }
 
-    // Move all fragments into target buffer
-    uint8_t offs = 0;
+    // Move the whole payload into target buffer
     _inv->DevInfo()->beginAppendFragment();
     _inv->DevInfo()->clearBufferAll();
-    for (uint8_t i = 0; i < max_fragment_id; i++) {
-        _inv->DevInfo()->appendFragmentAll(offs, fragment[i].fragment, fragment[i].len);
-        offs += (fragment[i].len);
-    }
+    _inv->DevInfo()->appendFragmentAll(0, fragments.data(), fragments.size());
     _inv->DevInfo()->endAppendFragment();
     _inv->DevInfo()->setLastUpdateAll(millis());
     return true;
@@ -35,21 +35,17 @@ String GridOnProFilePara::getCommandName() const
     return "GridOnProFilePara";
 }
 
-bool GridOnProFilePara::handleResponse(const fragment_t fragment[], const uint8_t max_fragment_id)
+bool GridOnProFilePara::handleResponse(const FragmentArena& fragments)
 {
     // Check CRC of whole payload
-    if (!MultiDataCommand::handleResponse(fragment, max_fragment_id)) {
+    if (!MultiDataCommand::handleResponse(fragments)) {
         return false;
     }
 
-    // Move all fragments into target buffer
-    uint8_t offs = 0;
+    // Move the whole payload into target buffer
     _inv->GridProfile()->beginAppendFragment();
     _inv->GridProfile()->clearBuffer();
-    for (uint8_t i = 0; i < max_fragment_id; i++) {
-        _inv->GridProfile()->appendFragment(offs, fragment[i].fragment, fragment[i].len);
-        offs += (fragment[i].len);
-    }
+    _inv->GridProfile()->appendFragment(0, fragments.data(), fragments.size());
     _inv->GridProfile()->endAppendFragment();
     _inv->GridProfile()->setLastUpdate(millis());
     return true;
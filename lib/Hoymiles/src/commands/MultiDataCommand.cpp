@@ -85,27 +85,23 @@ CommandAbstract* MultiDataCommand::getRequestFrameCommand(const uint8_t frame_no
     return &_cmdRequestFrame;
 }
 
-bool MultiDataCommand::handleResponse(const fragment_t fragment[], const uint8_t max_fragment_id)
+bool MultiDataCommand::handleResponse(const FragmentArena& fragments)
 {
-    // All fragments are available --> Check CRC
-    uint16_t crc = 0xffff, crcRcv = 0;
-
-    for (uint8_t i = 0; i < max_fragment_id; i++) {
-        // Doublecheck if correct answer package
-        if (fragment[i].mainCmd != (_payload[0] | 0x80)) {
-            return false;
-        }
-
-        if (i == max_fragment_id - 1) {
-            // Last packet
-            crc = crc16(fragment[i].fragment, fragment[i].len - 2, crc);
-            crcRcv = (fragment[i].fragment[fragment[i].len - 2] << 8)
-                | (fragment[i].fragment[fragment[i].len - 1]);
-        } else {
-            crc = crc16(fragment[i].fragment, fragment[i].len, crc);
-        }
+    // Doublecheck if correct answer package
+    if (!fragments.hasMainCmd(_payload[0] | 0x80)) {
+        return false;
     }
 
+    // All fragments are available --> Check CRC of the contiguous payload
+    const uint8_t* data = fragments.data();
+    const uint8_t len = fragments.size();
+    if (len < 2) {
+        return false;
+    }
+
+    const uint16_t crc = crc16(data, len - 2);
+    const uint16_t crcRcv = (data[len - 2] << 8) | data[len - 1];
+
     return crc == crcRcv;
 }
 
@@ -115,12 +111,3 @@ void MultiDataCommand::udpateCRC()
     _payload[24] = static_cast<uint8_t>(crc >> 8);
     _payload[25] = static_cast<uint8_t>(crc);
 }
-
-uint8_t MultiDataCommand::getTotalFragmentSize(const fragment_t fragment[], const uint8_t max_fragment_id)
-{
-    uint8_t fragmentSize = 0;
-    for (uint8_t i = 0; i < max_fragment_id; i++) {
-        fragmentSize += fragment[i].len;
-    }
-    return fragmentSize;
-}
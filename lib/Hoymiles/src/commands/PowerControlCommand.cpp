@@ -44,9 +44,9 @@ String PowerControlCommand::getCommandName() const
     return "PowerControl";
 }
 
-bool PowerControlCommand::handleResponse(const fragment_t fragment[], const uint8_t max_fragment_id)
+bool PowerControlCommand::handleResponse(const FragmentArena& fragments)
 {
-    if (!DevControlCommand::handleResponse(fragment, max_fragment_id)) {
+    if (!DevControlCommand::handleResponse(fragments)) {
         return false;
     }
 
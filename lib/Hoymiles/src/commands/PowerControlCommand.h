@@ -10,7 +10,7 @@ public:
     virtual String getCommandName() const;
     virtual QueueInsertType getQueueInsertType() const { return QueueInsertType::AllowMultiple; }
 
-    virtual bool handleResponse(const fragment_t fragment[], const uint8_t max_fragment_id);
+    virtual bool handleResponse(const FragmentArena& fragments);
     virtual void gotTimeout();
 
     void setPowerOn(const bool state);
@@ -3,42 +3,36 @@
  * Copyright (C) 2022 Thomas Basler and others
  */
 #include "crc.h"
+#include <CrcEngine.h>
 
 uint8_t crc8(const uint8_t buf[], const uint8_t len)
 {
-    uint8_t crc = CRC8_INIT;
-    for (uint8_t i = 0; i < len; i++) {
-        crc ^= buf[i];
-        for (uint8_t b = 0; b < 8; b++) {
-            crc = (crc << 1) ^ ((crc & 0x80) ? CRC8_POLY : 0x00);
-        }
-    }
-    return crc;
+    return Crc::Crc8Hoymiles::calculate(buf, len, CRC8_INIT);
 }
 
 uint16_t crc16(const uint8_t buf[], const uint8_t len, const uint16_t start)
 {
-    uint16_t crc = start;
-    uint8_t shift = 0;
-
-    for (uint8_t i = 0; i < len; i++) {
-        crc = crc ^ buf[i];
-        for (uint8_t bit = 0; bit < 8; bit++) {
-            shift = (crc & 0x0001);
-            crc = crc >> 1;
-            if (shift != 0)
-                crc = crc ^ 0xA001;
-        }
-    }
-    return crc;
+    return Crc::Crc16Modbus::calculate(buf, len, start);
 }
 
 uint16_t crc16nrf24(const uint8_t buf[], const uint16_t lenBits, const uint16_t startBit, const uint16_t crcIn)
 {
     uint16_t crc = crcIn;
-    uint8_t idx, val = buf[(startBit >> 3)];
+    uint16_t bit = startBit;
+
+    // whole bytes are processed using the lookup table
+    if ((bit & 0x07) == 0) {
+        for (; bit + 8 <= lenBits; bit += 8) {
+            crc = Crc::Crc16Ccitt::update(crc, buf[bit >> 3]);
+        }
+    }
+
+    // remaining bits (and unaligned frames) are processed bit by bit.
+    // the byte is only loaded if there are bits left to process, as bit
+    // points past the end of the buffer if lenBits is a multiple of 8.
+    uint8_t idx, val = (bit < lenBits) ? buf[(bit >> 3)] : 0;
 
-    for (uint16_t bit = startBit; bit < lenBits; bit++) {
+    for (; bit < lenBits; bit++) {
         idx = bit & 0x07;
         if (0 == idx)
             val = buf[(bit >> 3)];
@@ -47,4 +41,4 @@ uint16_t crc16nrf24(const uint8_t buf[], const uint16_t lenBits, const uint16_t
     }
 
     return crc;
-}
\ No newline at end of file
+}
@@ -5,7 +5,7 @@
  */
 #include "HERF_1CH.h"
 
-static const byteAssign_t byteAssignment[] = {
+static constexpr byteAssign_t byteAssignment[] = {
     { TYPE_DC, CH0, FLD_UDC, UNIT_V, 2, 2, 10, false, 1 },
     { TYPE_DC, CH0, FLD_IDC, UNIT_A, 6, 2, 100, false, 2 },
     { TYPE_DC, CH0, FLD_PDC, UNIT_W, 10, 2, 10, false, 1 },
@@ -29,10 +29,12 @@ static const byteAssign_t byteAssignment[] = {
     { TYPE_INV, CH0, FLD_EFF, UNIT_PCT, CALC_TOTAL_EFF, 0, CMD_CALC, false, 3 }
 };
 
-static const channelMetaData_t channelMetaData[] = {
+static constexpr channelMetaData_t channelMetaData[] = {
     { CH0, MPPT_A }
 };
 
+VALIDATE_BYTE_ASSIGNMENT(byteAssignment, channelMetaData);
+
 HERF_1CH::HERF_1CH(HoymilesRadio* radio, const uint64_t serial)
     : HM_Abstract(radio, serial)
 {
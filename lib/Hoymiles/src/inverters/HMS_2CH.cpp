@@ -4,7 +4,7 @@
  */
 #include "HMS_2CH.h"
 
-static const byteAssign_t byteAssignment[] = {
+static constexpr byteAssign_t byteAssignment[] = {
     { TYPE_DC, CH0, FLD_UDC, UNIT_V, 2, 2, 10, false, 1 },
     { TYPE_DC, CH0, FLD_IDC, UNIT_A, 6, 2, 100, false, 2 },
     { TYPE_DC, CH0, FLD_PDC, UNIT_W, 10, 2, 10, false, 1 },
@@ -35,11 +35,13 @@ static const byteAssign_t byteAssignment[] = {
     { TYPE_INV, CH0, FLD_EFF, UNIT_PCT, CALC_TOTAL_EFF, 0, CMD_CALC, false, 3 }
 };
 
-static const channelMetaData_t channelMetaData[] = {
+static constexpr channelMetaData_t channelMetaData[] = {
     { CH0, MPPT_A },
     { CH1, MPPT_B }
 };
 
+VALIDATE_BYTE_ASSIGNMENT(byteAssignment, channelMetaData);
+
 HMS_2CH::HMS_2CH(HoymilesRadio* radio, const uint64_t serial)
     : HMS_Abstract(radio, serial)
 {
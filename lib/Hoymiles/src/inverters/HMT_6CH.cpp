@@ -4,7 +4,7 @@
  */
 #include "HMT_6CH.h"
 
-static const byteAssign_t byteAssignment[] = {
+static constexpr byteAssign_t byteAssignment[] = {
     { TYPE_DC, CH0, FLD_UDC, UNIT_V, 2, 2, 10, false, 1 },
     { TYPE_DC, CH0, FLD_IDC, UNIT_A, 4, 2, 100, false, 2 },
     { TYPE_DC, CH0, FLD_PDC, UNIT_W, 8, 2, 10, false, 1 },
@@ -72,7 +72,7 @@ static const byteAssign_t byteAssignment[] = {
     { TYPE_INV, CH0, FLD_EFF, UNIT_PCT, CALC_TOTAL_EFF, 0, CMD_CALC, false, 3 }
 };
 
-static const channelMetaData_t channelMetaData[] = {
+static constexpr channelMetaData_t channelMetaData[] = {
     { CH0, MPPT_A },
     { CH1, MPPT_A },
     { CH2, MPPT_B },
@@ -81,6 +81,8 @@ static const channelMetaData_t channelMetaData[] = {
     { CH5, MPPT_C }
 };
 
+VALIDATE_BYTE_ASSIGNMENT(byteAssignment, channelMetaData);
+
 HMT_6CH::HMT_6CH(HoymilesRadio* radio, const uint64_t serial)
     : HMT_Abstract(radio, serial)
 {
@@ -184,61 +184,21 @@ SystemConfigParaParser* InverterAbstract::SystemConfigPara()
 
 void InverterAbstract::clearRxFragmentBuffer()
 {
-    memset(_rxFragmentBuffer, 0, MAX_RF_FRAGMENT_COUNT * sizeof(fragment_t));
-    _rxFragmentMaxPacketId = 0;
-    _rxFragmentLastPacketId = 0;
+    _rxFragments.clear();
     _rxFragmentRetransmitCnt = 0;
 }
 
 void InverterAbstract::addRxFragment(const uint8_t fragment[], const uint8_t len, const int8_t rssi)
 {
     _lastRssi = rssi;
-
-    if (len < 11) {
-        Hoymiles.getMessageOutput()->printf("FATAL: (%s, %d) fragment too short\r\n", __FILE__, __LINE__);
-        return;
-    }
-
-    if (len - 11 > MAX_RF_PAYLOAD_SIZE) {
-        Hoymiles.getMessageOutput()->printf("FATAL: (%s, %d) fragment too large\r\n", __FILE__, __LINE__);
-        return;
-    }
-
-    const uint8_t fragmentCount = fragment[9];
-
-    // Packets with 0x81 will be seen as 1
-    const uint8_t fragmentId = fragmentCount & 0b01111111; // fragmentId is 1 based
-
-    if (fragmentId == 0) {
-        Hoymiles.getMessageOutput()->println("ERROR: fragment id zero received and ignored");
-        return;
-    }
-
-    if (fragmentId >= MAX_RF_FRAGMENT_COUNT) {
-        Hoymiles.getMessageOutput()->printf("ERROR: fragment id %" PRId8 " is too large for buffer and ignored\r\n", fragmentId);
-        return;
-    }
-
-    memcpy(_rxFragmentBuffer[fragmentId - 1].fragment, &fragment[10], len - 11);
-    _rxFragmentBuffer[fragmentId - 1].len = len - 11;
-    _rxFragmentBuffer[fragmentId - 1].mainCmd = fragment[0];
-    _rxFragmentBuffer[fragmentId - 1].wasReceived = true;
-
-    if (fragmentId > _rxFragmentLastPacketId) {
-        _rxFragmentLastPacketId = fragmentId;
-    }
-
-    // 0b10000000 == 0x80
-    if ((fragmentCount & 0b10000000) == 0b10000000) {
-        _rxFragmentMaxPacketId = fragmentId;
-    }
+    _rxFragments.add(fragment, len);
 }
 
 // Returns Zero on Success or the Fragment ID for retransmit or error code
 uint8_t InverterAbstract::verifyAllFragments(CommandAbstract& cmd)
 {
     // All missing
-    if (_rxFragmentLastPacketId == 0) {
+    if (!_rxFragments.hasAnyFragment()) {
         Hoymiles.getMessageOutput()->println("All missing");
         if (cmd.getSendCount() <= cmd.getMaxResendCount()) {
             return FRAGMENT_ALL_MISSING_RESEND;
@@ -248,31 +208,20 @@ uint8_t InverterAbstract::verifyAllFragments(CommandAbstract& cmd)
         }
     }
 
-    // Last fragment is missing (the one with 0x80)
-    if (_rxFragmentMaxPacketId == 0) {
-        Hoymiles.getMessageOutput()->println("Last missing");
+    // Last fragment (the one with 0x80) or a fragment in the middle is missing
+    const uint8_t missingId = _rxFragments.getFirstMissingId();
+    if (missingId > 0) {
+        Hoymiles.getMessageOutput()->println(_rxFragments.hasLastFragment() ? "Middle missing" : "Last missing");
         if (_rxFragmentRetransmitCnt++ < cmd.getMaxRetransmitCount()) {
-            return _rxFragmentLastPacketId + 1;
+            return missingId;
         } else {
             cmd.gotTimeout();
             return FRAGMENT_RETRANSMIT_TIMEOUT;
         }
     }
 
-    // Middle fragment is missing
-    for (uint8_t i = 0; i < _rxFragmentMaxPacketId - 1; i++) {
-        if (!_rxFragmentBuffer[i].wasReceived) {
-            Hoymiles.getMessageOutput()->println("Middle missing");
-            if (_rxFragmentRetransmitCnt++ < cmd.getMaxRetransmitCount()) {
-                return i + 1;
-            } else {
-                cmd.gotTimeout();
-                return FRAGMENT_RETRANSMIT_TIMEOUT;
-            }
-        }
-    }
-
-    if (!cmd.handleResponse(_rxFragmentBuffer, _rxFragmentMaxPacketId)) {
+    _rxFragments.assemble();
+    if (!cmd.handleResponse(_rxFragments)) {
         cmd.gotTimeout();
         return FRAGMENT_HANDLE_ERROR;
     }
@@ -8,6 +8,7 @@
 #include "../parser/PowerCommandParser.h"
 #include "../parser/StatisticsParser.h"
 #include "../parser/SystemConfigParaParser.h"
+#include "FragmentArena.h"
 #include "HoymilesRadio.h"
 #include "types.h"
 #include <Arduino.h>
@@ -38,8 +39,6 @@ typedef struct {
     MpptNum_t mppt; // mppt a - d (0 - 3)
 } channelMetaData_t;
 
-#define MAX_RF_FRAGMENT_COUNT 13
-
 class CommandAbstract;
 
 class InverterAbstract {
@@ -143,9 +142,7 @@ private:
     serial_u _serial;
     String _serialString;
     char _name[MAX_NAME_LENGTH] = "";
-    fragment_t _rxFragmentBuffer[MAX_RF_FRAGMENT_COUNT];
-    uint8_t _rxFragmentMaxPacketId = 0;
-    uint8_t _rxFragmentLastPacketId = 0;
+    FragmentArena _rxFragments;
     uint8_t _rxFragmentRetransmitCnt = 0;
 
     bool _enablePolling = true;
@@ -24,9 +24,13 @@ ID   Source Addr   Target Addr   Idx  ?       wcode   ?       Start   End     ?
 */
 #include "AlarmLogParser.h"
 #include "../Hoymiles.h"
+#include <algorithm>
 #include <cstring>
 
-const std::array<const AlarmMessage_t, ALARM_MSG_COUNT> AlarmLogParser::_alarmMessages = { {
+namespace {
+
+// sorted by message id and inverter type, see static_assert below
+constexpr std::array<const AlarmMessage_t, ALARM_MSG_COUNT> alarmMessages = { {
     { AlarmMessageType_t::ALL, 1, "Inverter start", "Wechselrichter gestartet", "L'onduleur a démarré" },
     { AlarmMessageType_t::ALL, 2, "Time calibration", "Zeitabgleich", "" },
     { AlarmMessageType_t::ALL, 3, "EEPROM reading and writing error during operation", "", "" },
@@ -190,6 +194,26 @@ const std::array<const AlarmMessage_t, ALARM_MSG_COUNT> AlarmLogParser::_alarmMe
     { AlarmMessageType_t::ALL, 9000, "Microinverter is suspected of being stolen", "", "" },
 } };
 
+constexpr bool isSorted(const AlarmMessage_t& a, const AlarmMessage_t& b)
+{
+    return a.MessageId < b.MessageId
+        || (a.MessageId == b.MessageId && a.InverterType < b.InverterType);
+}
+
+constexpr bool isTableSorted()
+{
+    for (size_t i = 1; i < alarmMessages.size(); i++) {
+        if (!isSorted(alarmMessages[i - 1], alarmMessages[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(isTableSorted(), "alarm messages must be sorted by message id and inverter type");
+
+} // namespace
+
 AlarmLogParser::AlarmLogParser()
     : Parser()
 {
@@ -264,6 +288,12 @@ void AlarmLogParser::getLogEntry(const uint8_t entryId, AlarmLogEntry_t& entry,
         entry.EndTime += (endTimeOffset + timezoneOffset);
     }
 
+    const AlarmMessage_t* msg = findMessage(entry.MessageId, _messageType);
+    if (msg != nullptr) {
+        entry.Message = getLocaleMessage(msg, locale);
+        return;
+    }
+
     switch (locale) {
     case AlarmMessageLocale_t::DE:
         entry.Message = "Unbekannt";
@@ -274,20 +304,28 @@ void AlarmLogParser::getLogEntry(const uint8_t entryId, AlarmLogEntry_t& entry,
     default:
         entry.Message = "Unknown";
     }
+}
 
-    for (auto& msg : _alarmMessages) {
-        if (msg.MessageId == entry.MessageId) {
-            if (msg.InverterType == _messageType) {
-                entry.Message = getLocaleMessage(&msg, locale);
-                break;
-            } else if (msg.InverterType == AlarmMessageType_t::ALL) {
-                entry.Message = getLocaleMessage(&msg, locale);
-            }
+const AlarmMessage_t* AlarmLogParser::findMessage(const uint16_t messageId, const AlarmMessageType_t type)
+{
+    auto it = std::lower_bound(alarmMessages.begin(), alarmMessages.end(), messageId,
+        [](const AlarmMessage_t& msg, const uint16_t id) { return msg.MessageId < id; });
+
+    // a message specific to the inverter type takes precedence
+    const AlarmMessage_t* res = nullptr;
+    for (; it != alarmMessages.end() && it->MessageId == messageId; ++it) {
+        if (it->InverterType == type) {
+            return &(*it);
+        }
+        if (it->InverterType == AlarmMessageType_t::ALL) {
+            res = &(*it);
         }
     }
+
+    return res;
 }
 
-String AlarmLogParser::getLocaleMessage(const AlarmMessage_t* msg, const AlarmMessageLocale_t locale) const
+const char* AlarmLogParser::getLocaleMessage(const AlarmMessage_t* msg, const AlarmMessageLocale_t locale)
 {
     if (locale == AlarmMessageLocale_t::DE) {
         return msg->Message_de[0] != '\0' ? msg->Message_de : msg->Message_en;
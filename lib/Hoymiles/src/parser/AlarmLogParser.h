@@ -12,17 +12,17 @@
 
 struct AlarmLogEntry_t {
     uint16_t MessageId;
-    String Message;
+    const char* Message; // points to a static string
     time_t StartTime;
     time_t EndTime;
 };
 
-enum class AlarmMessageType_t {
+enum class AlarmMessageType_t : uint8_t {
     ALL = 0,
     HMT
 };
 
-enum class AlarmMessageLocale_t {
+enum class AlarmMessageLocale_t : uint8_t {
     EN,
     DE,
     FR
@@ -52,7 +52,8 @@ public:
 
 private:
     static int getTimezoneOffset();
-    String getLocaleMessage(const AlarmMessage_t* msg, const AlarmMessageLocale_t locale) const;
+    static const AlarmMessage_t* findMessage(const uint16_t messageId, const AlarmMessageType_t type);
+    static const char* getLocaleMessage(const AlarmMessage_t* msg, const AlarmMessageLocale_t locale);
 
     uint8_t _payloadAlarmLog[ALARM_LOG_PAYLOAD_SIZE];
     uint8_t _alarmLogLength = 0;
@@ -60,6 +61,4 @@ private:
     LastCommandSuccess _lastAlarmRequestSuccess = CMD_NOK; // Set to NOK to fetch at startup
 
     AlarmMessageType_t _messageType = AlarmMessageType_t::ALL;
-
-    static const std::array<const AlarmMessage_t, ALARM_MSG_COUNT> _alarmMessages;
 };
@@ -67,6 +67,10 @@ void StatisticsParser::setByteAssignment(const byteAssign_t* byteAssignment, con
     _byteAssignment = byteAssignment;
     _byteAssignmentSize = size;
 
+    for (auto& t : getChannelTypes()) {
+        _channelsByType[t] = calcChannelsByType(byteAssignment, size, t);
+    }
+
     for (uint8_t i = 0; i < _byteAssignmentSize; i++) {
         if (_byteAssignment[i].div == CMD_CALC) {
             continue;
@@ -275,13 +279,13 @@ void StatisticsParser::setChannelFieldOffset(const ChannelType_t type, const Cha
     }
 }
 
-std::list<ChannelType_t> StatisticsParser::getChannelTypes() const
+ChannelTypeList StatisticsParser::getChannelTypes() const
 {
-    return {
-        TYPE_AC,
-        TYPE_DC,
-        TYPE_INV
-    };
+    ChannelTypeList l;
+    l.push_back(TYPE_AC);
+    l.push_back(TYPE_DC);
+    l.push_back(TYPE_INV);
+    return l;
 }
 
 const char* StatisticsParser::getChannelTypeName(const ChannelType_t type) const
@@ -289,16 +293,9 @@ const char* StatisticsParser::getChannelTypeName(const ChannelType_t type) const
     return channelsTypes[type];
 }
 
-std::list<ChannelNum_t> StatisticsParser::getChannelsByType(const ChannelType_t type) const
+const ChannelList& StatisticsParser::getChannelsByType(const ChannelType_t type) const
 {
-    std::list<ChannelNum_t> l;
-    for (uint8_t i = 0; i < _byteAssignmentSize; i++) {
-        if (_byteAssignment[i].type == type) {
-            l.push_back(_byteAssignment[i].ch);
-        }
-    }
-    l.unique();
-    return l;
+    return _channelsByType[type];
 }
 
 uint16_t StatisticsParser::getStringMaxPower(const uint8_t channel) const
@@ -1,7 +1,9 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 #include "Parser.h"
+#include <array>
 #include <cstdint>
+#include <iterator>
 #include <list>
 
 #define STATISTIC_PACKET_SIZE (7 * 16)
@@ -61,7 +63,8 @@ enum {
     CALC_TOTAL_PDC,
     CALC_TOTAL_EFF,
     CALC_CH_IRR,
-    CALC_TOTAL_IAC
+    CALC_TOTAL_IAC,
+    CALC_FUNC_CNT
 };
 enum { CMD_CALC = 0xffff };
 
@@ -102,6 +105,90 @@ typedef struct {
     float offset; // offset (positive/negative) to be applied on the fetched value
 } fieldSettings_t;
 
+// Fixed capacity list which can be iterated without heap allocations
+template <typename T, size_t N>
+class FixedList {
+public:
+    constexpr void push_back(const T item)
+    {
+        if (_size < N) {
+            _items[_size++] = item;
+        }
+    }
+
+    constexpr bool contains(const T item) const
+    {
+        for (size_t i = 0; i < _size; i++) {
+            if (_items[i] == item) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    constexpr size_t size() const { return _size; }
+    constexpr bool empty() const { return _size == 0; }
+    constexpr const T* begin() const { return _items.data(); }
+    constexpr const T* end() const { return _items.data() + _size; }
+
+private:
+    std::array<T, N> _items = {};
+    size_t _size = 0;
+};
+
+using ChannelList = FixedList<ChannelNum_t, CH_CNT>;
+using ChannelTypeList = FixedList<ChannelType_t, TYPE_INV + 1>;
+
+// Channels of the given type in order of their first occurrence in the byte assignment.
+// Used at compile time to validate the inverter models as well as at runtime.
+constexpr ChannelList calcChannelsByType(const byteAssign_t* byteAssignment, const size_t size, const ChannelType_t type)
+{
+    ChannelList l;
+    for (size_t i = 0; i < size; i++) {
+        if (byteAssignment[i].type == type && !l.contains(byteAssignment[i].ch)) {
+            l.push_back(byteAssignment[i].ch);
+        }
+    }
+    return l;
+}
+
+// Checks an inverter model's byte assignment: every field is defined only once,
+// fits into the statistics buffer and references an existing calculation function.
+constexpr bool isValidByteAssignment(const byteAssign_t* byteAssignment, const size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        const byteAssign_t& a = byteAssignment[i];
+
+        if (a.ch >= CH_CNT || a.unitId > UNIT_NONE) {
+            return false;
+        }
+
+        if (a.div == CMD_CALC) {
+            if (a.start >= CALC_FUNC_CNT) {
+                return false;
+            }
+        } else if (a.div == 0 || (a.num != 2 && a.num != 4) || a.start + a.num > STATISTIC_PACKET_SIZE) {
+            return false;
+        }
+
+        for (size_t j = 0; j < i; j++) {
+            if (byteAssignment[j].type == a.type && byteAssignment[j].ch == a.ch && byteAssignment[j].fieldId == a.fieldId) {
+                return false;
+            }
+        }
+    }
+    return size > 0;
+}
+
+// Compile time checks of an inverter model: a valid byte assignment, one meta data
+// entry per DC channel and exactly one AC and one INV channel.
+#define VALIDATE_BYTE_ASSIGNMENT(byteAssignment, channelMetaData) \
+    static_assert(isValidByteAssignment(byteAssignment, std::size(byteAssignment)), "invalid byte assignment"); \
+    static_assert(calcChannelsByType(byteAssignment, std::size(byteAssignment), TYPE_DC).size() == std::size(channelMetaData), \
+        "channel meta data does not match DC channels"); \
+    static_assert(calcChannelsByType(byteAssignment, std::size(byteAssignment), TYPE_AC).size() == 1, "expected exactly one AC channel"); \
+    static_assert(calcChannelsByType(byteAssignment, std::size(byteAssignment), TYPE_INV).size() == 1, "expected exactly one INV channel")
+
 class StatisticsParser : public Parser {
 public:
     StatisticsParser();
@@ -129,9 +216,9 @@ public:
     float getChannelFieldOffset(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId);
     void setChannelFieldOffset(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, const float offset);
 
-    std::list<ChannelType_t> getChannelTypes() const;
+    ChannelTypeList getChannelTypes() const;
     const char* getChannelTypeName(const ChannelType_t type) const;
-    std::list<ChannelNum_t> getChannelsByType(const ChannelType_t type) const;
+    const ChannelList& getChannelsByType(const ChannelType_t type) const;
 
     uint16_t getStringMaxPower(const uint8_t channel) const;
     void setStringMaxPower(const uint8_t channel, const uint16_t power);
@@ -162,6 +249,7 @@ private:
 
     const byteAssign_t* _byteAssignment;
     uint8_t _byteAssignmentSize;
+    std::array<ChannelList, TYPE_INV + 1> _channelsByType;
     uint8_t _expectedByteCount = 0;
     std::list<fieldSettings_t> _fieldSettings;
 
@@ -19,6 +19,11 @@ void CommandQueue::removeDuplicatedEntries(std::shared_ptr<CommandAbstract> cmd)
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
+    // The first entry is the command currently in flight, it must not be touched
+    if (_queue.empty()) {
+        return;
+    }
+
     auto it = std::remove_if(_queue.begin() + 1, _queue.end(),
         [&cmd](std::shared_ptr<CommandAbstract> v) -> bool {
             return cmd->areSameParameter(v.get())
@@ -31,6 +36,11 @@ void CommandQueue::replaceEntries(std::shared_ptr<CommandAbstract> cmd)
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
+    // The first entry is the command currently in flight, it must not be touched
+    if (_queue.empty()) {
+        return;
+    }
+
     std::replace_if(_queue.begin() + 1, _queue.end(),
         [&cmd](std::shared_ptr<CommandAbstract> v)-> bool {
             return cmd.get()->getQueueInsertType() == QueueInsertType::ReplaceExistent
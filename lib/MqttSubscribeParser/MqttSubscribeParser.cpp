@@ -3,20 +3,115 @@
  * Copyright (C) 2022 Thomas Basler and others
  */
 #include "MqttSubscribeParser.h"
+#include <algorithm>
+#include <cstring>
 
-void MqttSubscribeParser::register_callback(const std::string& topic, uint8_t qos, const espMqttClientTypes::OnMessageCallback& cb)
+bool MqttSubscribeParser::node_t::empty() const
 {
-    cb_filter_t cbf;
-    cbf.topic = topic;
-    cbf.qos = qos;
-    cbf.cb = cb;
-    _callbacks.push_back(cbf);
+    return children.empty() && !single_level && subscriptions.empty() && multi_level.empty();
+}
+
+/* Splits a topic filter into its levels and validates the use of wildcards */
+bool MqttSubscribeParser::split_filter(const std::string& topic, std::vector<std::string>& levels)
+{
+    levels.clear();
+    if (topic.empty()) {
+        return false;
+    }
+
+    size_t start = 0;
+    while (true) {
+        size_t end = topic.find('/', start);
+        std::string level = topic.substr(start, end == std::string::npos ? std::string::npos : end - start);
+
+        bool has_wildcard = level.find_first_of("+#") != std::string::npos;
+        if (has_wildcard && level != "+" && level != "#") {
+            return false; // e.g. "foo+" or "#foo"
+        }
+        if (level == "#" && end != std::string::npos) {
+            return false; // '#' must be the last level
+        }
+
+        levels.push_back(std::move(level));
+
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+
+    return true;
+}
+
+MqttSubscribeParser::handle_t MqttSubscribeParser::register_callback(const std::string& topic, uint8_t qos, const espMqttClientTypes::OnMessageCallback& cb)
+{
+    std::vector<std::string> levels;
+    if (!split_filter(topic, levels)) {
+        return invalid_handle;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _callbacks.push_back({ _next_handle++, topic, qos, cb });
+    cb_filter_t* cbf = &_callbacks.back();
+
+    node_t* node = &_root;
+    for (const auto& level : levels) {
+        if (level == "#") {
+            node->multi_level.push_back(cbf);
+            return cbf->handle;
+        }
+
+        std::unique_ptr<node_t>& next = (level == "+") ? node->single_level : node->children[level];
+        if (!next) {
+            next = std::make_unique<node_t>();
+        }
+        node = next.get();
+    }
+
+    node->subscriptions.push_back(cbf);
+    return cbf->handle;
+}
+
+bool MqttSubscribeParser::remove_from_node(node_t* node, const std::vector<std::string>& levels, size_t level, const cb_filter_t* cbf)
+{
+    auto erase = [cbf](std::vector<cb_filter_t*>& vec) {
+        vec.erase(std::remove(vec.begin(), vec.end(), cbf), vec.end());
+    };
+
+    if (level == levels.size()) {
+        erase(node->subscriptions);
+    } else if (levels[level] == "#") {
+        erase(node->multi_level);
+    } else if (levels[level] == "+") {
+        if (node->single_level && remove_from_node(node->single_level.get(), levels, level + 1, cbf)) {
+            node->single_level.reset();
+        }
+    } else {
+        auto it = node->children.find(levels[level]);
+        if (it != node->children.end() && remove_from_node(it->second.get(), levels, level + 1, cbf)) {
+            node->children.erase(it);
+        }
+    }
+
+    // tell the parent whether this node can be pruned
+    return node->empty();
+}
+
+void MqttSubscribeParser::remove_from_trie(const cb_filter_t* cbf)
+{
+    std::vector<std::string> levels;
+    split_filter(cbf->topic, levels);
+    remove_from_node(&_root, levels, 0, cbf);
 }
 
 void MqttSubscribeParser::unregister_callback(const std::string& topic)
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     for (auto it = _callbacks.begin(); it != _callbacks.end();) {
         if ((*it).topic == topic) {
+            remove_from_trie(&(*it));
             it = _callbacks.erase(it);
         } else {
             ++it;
@@ -24,148 +119,97 @@ void MqttSubscribeParser::unregister_callback(const std::string& topic)
     }
 }
 
-void MqttSubscribeParser::handle_message(const espMqttClientTypes::MessageProperties& properties, const char* topic, const uint8_t* payload, size_t len, size_t index, size_t total)
+bool MqttSubscribeParser::unregister_callback(handle_t handle, std::string& topic)
 {
-    bool result = false;
-    for (const auto& cb : _callbacks) {
-        if (mosquitto_topic_matches_sub(cb.topic.c_str(), topic, &result) == MOSQ_ERR_SUCCESS) {
-            if (result) {
-                cb.cb(properties, topic, payload, len, index, total);
-            }
-        }
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = std::find_if(_callbacks.begin(), _callbacks.end(),
+        [handle](const cb_filter_t& cbf) { return cbf.handle == handle; });
+    if (it == _callbacks.end()) {
+        return false;
     }
+
+    topic = it->topic;
+    remove_from_trie(&(*it));
+    _callbacks.erase(it);
+    return true;
 }
 
-std::vector<cb_filter_t> MqttSubscribeParser::get_callbacks()
+bool MqttSubscribeParser::has_callback(const std::string& topic)
 {
-    return _callbacks;
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    return std::any_of(_callbacks.begin(), _callbacks.end(),
+        [&topic](const cb_filter_t& cbf) { return cbf.topic == topic; });
 }
 
-/* Does a topic match a subscription? */
-int MqttSubscribeParser::mosquitto_topic_matches_sub(const char* sub, const char* topic, bool* result)
+/* Walks the trie along the topic levels and collects all matching subscriptions */
+void MqttSubscribeParser::collect(const node_t* node, const char* topic, bool first_level, std::vector<cb_filter_t*>& matches)
 {
-    size_t spos;
+    // wildcards at the first level must not match topics starting with '$'
+    bool wildcards = !(first_level && topic[0] == '$');
+
+    // "foo/#" also matches "foo", hence check before the end of the topic
+    if (wildcards) {
+        matches.insert(matches.end(), node->multi_level.begin(), node->multi_level.end());
+    }
+
+    const char* end = strchr(topic, '/');
+    size_t len = (end != nullptr) ? (end - topic) : strlen(topic);
+    const char* next = (end != nullptr) ? end + 1 : nullptr;
 
-    if (!result)
-        return MOSQ_ERR_INVAL;
-    *result = false;
+    auto descend = [&](const node_t* child) {
+        if (next == nullptr) {
+            matches.insert(matches.end(), child->subscriptions.begin(), child->subscriptions.end());
+            // "foo/#" matches "foo"
+            matches.insert(matches.end(), child->multi_level.begin(), child->multi_level.end());
+        } else {
+            collect(child, next, false, matches);
+        }
+    };
 
-    if (!sub || !topic || sub[0] == 0 || topic[0] == 0) {
-        return MOSQ_ERR_INVAL;
+    auto it = node->children.find(std::string(topic, len));
+    if (it != node->children.end()) {
+        descend(it->second.get());
     }
 
-    if ((sub[0] == '$' && topic[0] != '$')
-        || (topic[0] == '$' && sub[0] != '$')) {
+    if (wildcards && node->single_level) {
+        descend(node->single_level.get());
+    }
+}
 
-        return MOSQ_ERR_SUCCESS;
+void MqttSubscribeParser::handle_message(const espMqttClientTypes::MessageProperties& properties, const char* topic, const uint8_t* payload, size_t len, size_t index, size_t total)
+{
+    if (topic == nullptr || topic[0] == 0) {
+        return;
     }
 
-    spos = 0;
+    std::vector<espMqttClientTypes::OnMessageCallback> callbacks;
 
-    while (sub[0] != 0) {
-        if (topic[0] == '+' || topic[0] == '#') {
-            return MOSQ_ERR_INVAL;
-        }
-        if (sub[0] != topic[0] || topic[0] == 0) { /* Check for wildcard matches */
-            if (sub[0] == '+') {
-                /* Check for bad "+foo" or "a/+foo" subscription */
-                if (spos > 0 && sub[-1] != '/') {
-                    return MOSQ_ERR_INVAL;
-                }
-                /* Check for bad "foo+" or "foo+/a" subscription */
-                if (sub[1] != 0 && sub[1] != '/') {
-                    return MOSQ_ERR_INVAL;
-                }
-                spos++;
-                sub++;
-                while (topic[0] != 0 && topic[0] != '/') {
-                    if (topic[0] == '+' || topic[0] == '#') {
-                        return MOSQ_ERR_INVAL;
-                    }
-                    topic++;
-                }
-                if (topic[0] == 0 && sub[0] == 0) {
-                    *result = true;
-                    return MOSQ_ERR_SUCCESS;
-                }
-            } else if (sub[0] == '#') {
-                /* Check for bad "foo#" subscription */
-                if (spos > 0 && sub[-1] != '/') {
-                    return MOSQ_ERR_INVAL;
-                }
-                /* Check for # not the final character of the sub, e.g. "#foo" */
-                if (sub[1] != 0) {
-                    return MOSQ_ERR_INVAL;
-                } else {
-                    while (topic[0] != 0) {
-                        if (topic[0] == '+' || topic[0] == '#') {
-                            return MOSQ_ERR_INVAL;
-                        }
-                        topic++;
-                    }
-                    *result = true;
-                    return MOSQ_ERR_SUCCESS;
-                }
-            } else {
-                /* Check for e.g. foo/bar matching foo/+/# */
-                if (topic[0] == 0
-                    && spos > 0
-                    && sub[-1] == '+'
-                    && sub[0] == '/'
-                    && sub[1] == '#') {
-                    *result = true;
-                    return MOSQ_ERR_SUCCESS;
-                }
-
-                /* There is no match at this point, but is the sub invalid? */
-                while (sub[0] != 0) {
-                    if (sub[0] == '#' && sub[1] != 0) {
-                        return MOSQ_ERR_INVAL;
-                    }
-                    spos++;
-                    sub++;
-                }
-
-                /* Valid input, but no match */
-                return MOSQ_ERR_SUCCESS;
-            }
-        } else {
-            /* sub[spos] == topic[tpos] */
-            if (topic[1] == 0) {
-                /* Check for e.g. foo matching foo/# */
-                if (sub[1] == '/'
-                    && sub[2] == '#'
-                    && sub[3] == 0) {
-                    *result = true;
-                    return MOSQ_ERR_SUCCESS;
-                }
-            }
-            spos++;
-            sub++;
-            topic++;
-            if (sub[0] == 0 && topic[0] == 0) {
-                *result = true;
-                return MOSQ_ERR_SUCCESS;
-            } else if (topic[0] == 0 && sub[0] == '+' && sub[1] == 0) {
-                if (spos > 0 && sub[-1] != '/') {
-                    return MOSQ_ERR_INVAL;
-                }
-                spos++;
-                sub++;
-                *result = true;
-                return MOSQ_ERR_SUCCESS;
-            }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        std::vector<cb_filter_t*> matches;
+        collect(&_root, topic, true, matches);
+
+        callbacks.reserve(matches.size());
+        for (const auto* cbf : matches) {
+            callbacks.push_back(cbf->cb);
         }
     }
-    if ((topic[0] != 0 || sub[0] != 0)) {
-        *result = false;
-    }
-    while (topic[0] != 0) {
-        if (topic[0] == '+' || topic[0] == '#') {
-            return MOSQ_ERR_INVAL;
-        }
-        topic++;
+
+    // invoke the callbacks without holding the lock, as they might
+    // register or unregister callbacks themselves.
+    for (const auto& cb : callbacks) {
+        cb(properties, topic, payload, len, index, total);
     }
+}
 
-    return MOSQ_ERR_SUCCESS;
+void MqttSubscribeParser::for_each_subscription(const std::function<void(const std::string& topic, uint8_t qos)>& func)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (const auto& cbf : _callbacks) {
+        func(cbf.topic, cbf.qos);
+    }
 }
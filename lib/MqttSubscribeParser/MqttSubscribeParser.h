@@ -3,29 +3,63 @@
 
 #include <cstdint>
 #include <espMqttClient.h>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 struct cb_filter_t {
+    uint32_t handle;
     std::string topic;
     uint8_t qos;
     espMqttClientTypes::OnMessageCallback cb;
 };
 
+// dispatches incoming messages to the registered callbacks. subscriptions
+// are stored in a trie with one node per topic level, such that finding
+// all matching subscriptions only depends on the depth of the topic, not
+// on the number of subscriptions.
 class MqttSubscribeParser {
 public:
-    void register_callback(const std::string& topic, uint8_t qos, const espMqttClientTypes::OnMessageCallback& cb);
+    using handle_t = uint32_t;
+    static constexpr handle_t invalid_handle = 0;
+
+    // returns invalid_handle if the topic filter is malformed
+    handle_t register_callback(const std::string& topic, uint8_t qos, const espMqttClientTypes::OnMessageCallback& cb);
+
+    // removes all callbacks registered for the topic filter
     void unregister_callback(const std::string& topic);
+
+    // removes a single callback and provides the topic filter it was
+    // registered for. returns false if the handle is unknown.
+    bool unregister_callback(handle_t handle, std::string& topic);
+
+    bool has_callback(const std::string& topic);
+
     void handle_message(const espMqttClientTypes::MessageProperties& properties, const char* topic, const uint8_t* payload, size_t len, size_t index, size_t total);
-    std::vector<cb_filter_t> get_callbacks();
 
-private:
-    int mosquitto_topic_matches_sub(const char* sub, const char* topic, bool* result);
+    void for_each_subscription(const std::function<void(const std::string& topic, uint8_t qos)>& func);
 
-    std::vector<cb_filter_t> _callbacks;
+private:
+    struct node_t {
+        std::map<std::string, std::unique_ptr<node_t>> children;
+        std::unique_ptr<node_t> single_level; // '+'
+        std::vector<cb_filter_t*> subscriptions; // filter ends at this level
+        std::vector<cb_filter_t*> multi_level; // filter ends with '#' at this level
 
-    enum mosq_err_t {
-        MOSQ_ERR_SUCCESS = 0,
-        MOSQ_ERR_INVAL = 3,
+        bool empty() const;
     };
-};
\ No newline at end of file
+
+    static bool split_filter(const std::string& topic, std::vector<std::string>& levels);
+    void remove_from_trie(const cb_filter_t* cbf);
+    static bool remove_from_node(node_t* node, const std::vector<std::string>& levels, size_t level, const cb_filter_t* cbf);
+    static void collect(const node_t* node, const char* topic, bool first_level, std::vector<cb_filter_t*>& matches);
+
+    std::mutex _mutex;
+    node_t _root;
+    std::list<cb_filter_t> _callbacks; // stable addresses, referenced by the trie nodes
+    handle_t _next_handle = invalid_handle + 1;
+};
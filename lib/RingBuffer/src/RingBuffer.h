@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+// fixed capacity circular buffer. once full, every push() overwrites the
+// oldest element, i.e., appending is always O(1) and no element is moved.
+// element access is in chronological order: index 0 is the oldest element,
+// index size() - 1 is the newest one.
+template <typename T, size_t N>
+class RingBuffer {
+public:
+    static_assert(N > 0, "RingBuffer capacity must not be zero");
+
+    void push(T const& item)
+    {
+        _items[_head] = item;
+        _head = (_head + 1) % N;
+        if (_size < N) { ++_size; }
+    }
+
+    void clear()
+    {
+        _head = 0;
+        _size = 0;
+    }
+
+    size_t size() const { return _size; }
+    static constexpr size_t capacity() { return N; }
+    bool empty() const { return _size == 0; }
+    bool full() const { return _size == N; }
+
+    T const& operator[](size_t idx) const { return _items[physicalIndex(idx)]; }
+    T& operator[](size_t idx) { return _items[physicalIndex(idx)]; }
+
+    T const& back() const { return (*this)[_size - 1]; }
+    T const& front() const { return (*this)[0]; }
+
+    // calls func(item) for each element from oldest to newest
+    template <typename F>
+    void forEach(F&& func) const
+    {
+        for (size_t i = 0; i < _size; ++i) { func((*this)[i]); }
+    }
+
+private:
+    size_t physicalIndex(size_t idx) const
+    {
+        return (_head + N - _size + idx) % N;
+    }
+
+    std::array<T, N> _items = {};
+    size_t _head = 0; // position the next element will be written to
+    size_t _size = 0;
+};
@@ -2,7 +2,7 @@
 #include <string.h>
 
 #include "sml.h"
-#include "smlCrcTable.h"
+#include <CrcEngine.h>
 
 #ifdef SML_DEBUG
 char logBuff[200];
@@ -57,12 +57,7 @@ static unsigned char listPos = 0;
 
 void crc16(unsigned char &byte)
 {
-#ifdef ARDUINO
-  crc =
-      pgm_read_word_near(&smlCrcTable[(byte ^ crc) & 0xff]) ^ (crc >> 8 & 0xff);
-#else
-  crc = smlCrcTable[(byte ^ crc) & 0xff] ^ (crc >> 8 & 0xff);
-#endif
+  crc = Crc::Crc16X25::update(crc, byte);
 }
 
 void setState(sml_states_t state, int byteLen)
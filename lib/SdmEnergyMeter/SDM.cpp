@@ -5,6 +5,7 @@
 */
 //------------------------------------------------------------------------------
 #include "SDM.h"
+#include <CrcEngine.h>
 //------------------------------------------------------------------------------
 #if defined ( USE_HARDWARESERIAL )
 #if defined ( ESP8266 )
@@ -339,18 +340,7 @@ uint16_t SDM::getMsTimeout() {
 }
 
 uint16_t SDM::calculateCRC(const uint8_t *array, uint8_t len) const {
-  uint16_t _crc, _flag;
-  _crc = 0xFFFF;
-  for (uint8_t i = 0; i < len; i++) {
-    _crc ^= (uint16_t)array[i];
-    for (uint8_t j = 8; j; j--) {
-      _flag = _crc & 0x0001;
-      _crc >>= 1;
-      if (_flag)
-        _crc ^= 0xA001;
-    }
-  }
-  return _crc;
+  return Crc::Crc16Modbus::calculate(array, len, 0xFFFF);
 }
 
 void SDM::flush(unsigned long _flushtime) {
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "SyslogBatcher.h"
+#include <algorithm>
+#include <cstdio>
+
+void SyslogBatcher::setHeader(std::string const& hostname, std::string const& appName, std::string const& procId)
+{
+    // NIL message id
+    _header = hostname + " " + appName + " " + procId + " - ";
+}
+
+bool SyslogBatcher::add(char const* buffer, size_t size, uint32_t uptimeMillis,
+        std::string const& timestamp, Sink const& sink)
+{
+    bool accepted = true;
+
+    size_t start = 0;
+    for (size_t i = 0; i <= size; ++i) {
+        if (i < size && buffer[i] != '\n') { continue; }
+
+        size_t end = i;
+        while (end > start && buffer[end - 1] == '\r') { --end; }
+
+        if (end > start) {
+            if (takeToken(uptimeMillis)) {
+                // while overloaded, the drops are reported once in a while
+                // rather than in between every two lines that pass.
+                if (_dropped > 0 && uptimeMillis - _lastDropReportMillis >= DropReportIntervalMillis) {
+                    char note[64];
+                    int len = snprintf(note, sizeof(note),
+                            "[SyslogLogger] %u line(s) dropped due to rate limit",
+                            static_cast<unsigned>(_dropped));
+                    addMessage(note, len, uptimeMillis, timestamp, sink);
+                    _dropped = 0;
+                    _lastDropReportMillis = uptimeMillis;
+                }
+
+                addMessage(buffer + start, end - start, uptimeMillis, timestamp, sink);
+            } else {
+                ++_dropped;
+                ++_droppedTotal;
+                accepted = false;
+            }
+        }
+
+        start = i + 1;
+    }
+
+    return accepted;
+}
+
+void SyslogBatcher::flush(Sink const& sink)
+{
+    if (_batch.empty()) { return; }
+
+    sink(_batch.data(), _batch.size());
+    _batch.clear();
+}
+
+bool SyslogBatcher::isFlushDue(uint32_t uptimeMillis) const
+{
+    return !_batch.empty() && uptimeMillis - _batchStartMillis >= MaxBatchDelayMillis;
+}
+
+void SyslogBatcher::reset()
+{
+    _batch.clear();
+    _tokens = BurstLines;
+    _dropped = 0;
+}
+
+bool SyslogBatcher::takeToken(uint32_t uptimeMillis)
+{
+    uint32_t elapsed = uptimeMillis - _lastRefillMillis;
+    _lastRefillMillis = uptimeMillis;
+    _tokens = std::min(BurstLines, _tokens + elapsed * LinesPerSecond / 1000);
+
+    if (_tokens < 1) { return false; }
+
+    _tokens -= 1;
+    return true;
+}
+
+void SyslogBatcher::addMessage(char const* text, size_t size, uint32_t uptimeMillis,
+        std::string const& timestamp, Sink const& sink)
+{
+    // RFC 5424: the sequence id wraps to one after 2^31 - 1
+    if (++_sequenceId > 2147483647) { _sequenceId = 1; }
+
+    // facility user, severity info, version 1. the meta structured data
+    // element carries the uptime in hundredths of a second.
+    char meta[64];
+    snprintf(meta, sizeof(meta), "[meta sequenceId=\"%u\" sysUpTime=\"%u\"] ",
+            static_cast<unsigned>(_sequenceId), static_cast<unsigned>(uptimeMillis / 10));
+
+    std::string message = "<14>1 ";
+    message += timestamp.empty() ? "-" : timestamp;
+    message += ' ';
+    message += _header;
+    message += meta;
+
+    // messages which would not fit into a batch on their own are truncated,
+    // leaving room for the length prefix.
+    size_t room = MaxBatchSize - std::min(MaxBatchSize, message.size() + 5);
+    size = std::min(size, room);
+
+    for (size_t i = 0; i < size; ++i) {
+        // replace control and non-ASCII characters with '?'
+        char c = text[i];
+        message += (c >= 0x20 && c < 0x7f) ? c : '?';
+    }
+
+    if (_framing == Framing::Datagram) {
+        sink(message.data(), message.size());
+        return;
+    }
+
+    std::string framed = std::to_string(message.size()) + " " + message;
+
+    if (_batch.size() + framed.size() > MaxBatchSize) { flush(sink); }
+
+    if (_batch.empty()) { _batchStartMillis = uptimeMillis; }
+    _batch += framed;
+}
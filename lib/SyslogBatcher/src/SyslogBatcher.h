@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// formats log lines as syslog messages (RFC 5424). for a stream transport,
+// the messages are collected into batches of up to a maximum size, such that
+// many lines are sent in a single TCP segment. datagram receivers expect a
+// single message per datagram, so those are passed to the sink one by one.
+// the rate of lines is limited by a token bucket,
+// lines exceeding the limit are dropped and accounted for by a message
+// preceding the next line that is accepted.
+// this class does not depend on the Arduino framework, the caller provides
+// the time and sends the batches.
+class SyslogBatcher {
+public:
+    enum class Framing {
+        // one message per datagram, not batched (RFC 5426)
+        Datagram,
+        // messages are prefixed with their length (RFC 6587 octet counting)
+        OctetCounting
+    };
+
+    using Sink = std::function<void(char const* data, size_t size)>;
+
+    // 1500 bytes ethernet MTU minus IPv4 and UDP headers
+    static constexpr size_t MaxBatchSize = 1472;
+
+    // a batch is sent after this time even if it is not full
+    static constexpr uint32_t MaxBatchDelayMillis = 250;
+
+    static constexpr float LinesPerSecond = 50;
+    static constexpr float BurstLines = 250;
+    static constexpr uint32_t DropReportIntervalMillis = 1000;
+
+    void setHeader(std::string const& hostname, std::string const& appName, std::string const& procId);
+    void setFraming(Framing framing) { _framing = framing; }
+
+    // adds the line(s) in the buffer. the timestamp (RFC 3339) may be empty
+    // if the wall-clock time is not known. full batches are passed to the
+    // sink. returns false if lines were dropped due to the rate limit.
+    bool add(char const* buffer, size_t size, uint32_t uptimeMillis,
+            std::string const& timestamp, Sink const& sink);
+
+    // passes the pending batch to the sink, if any
+    void flush(Sink const& sink);
+
+    bool isFlushDue(uint32_t uptimeMillis) const;
+
+    // discards the pending batch and resets the rate limit
+    void reset();
+
+    uint32_t getDroppedLines() const { return _droppedTotal; }
+
+private:
+    bool takeToken(uint32_t uptimeMillis);
+    void addMessage(char const* text, size_t size, uint32_t uptimeMillis,
+            std::string const& timestamp, Sink const& sink);
+
+    std::string _header;
+    Framing _framing = Framing::Datagram;
+
+    std::string _batch;
+    uint32_t _batchStartMillis = 0;
+
+    uint32_t _sequenceId = 0;
+
+    float _tokens = BurstLines;
+    uint32_t _lastRefillMillis = 0;
+    uint32_t _dropped = 0;
+    uint32_t _lastDropReportMillis = 0;
+    uint32_t _droppedTotal = 0;
+};
@@ -0,0 +1,260 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "TimeSeriesCodec.h"
+#include <cstring>
+
+namespace TimeSeriesCodec {
+
+namespace {
+
+// delta-of-delta buckets: control bit prefix and payload width
+struct Bucket {
+    uint8_t prefix;
+    uint8_t prefixBits;
+    uint8_t payloadBits;
+};
+
+constexpr std::array<Bucket, 4> sBuckets = {{
+    { 0b10, 2, 7 },
+    { 0b110, 3, 9 },
+    { 0b1110, 4, 12 },
+    { 0b1111, 4, 32 },
+}};
+
+uint32_t floatToBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsToFloat(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool fitsSigned(int32_t value, uint8_t bits)
+{
+    if (bits >= 32) { return true; }
+    int32_t limit = 1 << (bits - 1);
+    return value >= -limit && value < limit;
+}
+
+int32_t signExtend(uint32_t value, uint8_t bits)
+{
+    if (bits >= 32) { return static_cast<int32_t>(value); }
+    uint32_t signBit = 1u << (bits - 1);
+    return static_cast<int32_t>((value ^ signBit) - signBit);
+}
+
+uint32_t mask(uint8_t bits)
+{
+    return (bits >= 32) ? 0xFFFFFFFF : ((1u << bits) - 1);
+}
+
+} // namespace
+
+bool BitWriter::write(uint32_t value, uint8_t bits)
+{
+    if (_position + bits > _sizeBits) { return false; }
+
+    for (int8_t i = bits - 1; i >= 0; --i) {
+        size_t byte = _position / 8;
+        uint8_t bit = 7 - (_position % 8);
+        if ((value >> i) & 1) {
+            _buffer[byte] |= (1 << bit);
+        } else {
+            _buffer[byte] &= ~(1 << bit);
+        }
+        ++_position;
+    }
+
+    return true;
+}
+
+bool BitReader::read(uint32_t& value, uint8_t bits)
+{
+    if (_position + bits > _sizeBits) { return false; }
+
+    value = 0;
+    for (uint8_t i = 0; i < bits; ++i) {
+        size_t byte = _position / 8;
+        uint8_t bit = 7 - (_position % 8);
+        value = (value << 1) | ((_buffer[byte] >> bit) & 1);
+        ++_position;
+    }
+
+    return true;
+}
+
+Encoder::Encoder(uint8_t* buffer, size_t size, uint8_t channels)
+    : _writer(buffer, size)
+    , _channels(channels > MaxChannels ? MaxChannels : channels)
+{
+}
+
+bool Encoder::append(uint32_t timestamp, float const* values)
+{
+    size_t position = _writer.getPosition();
+    State state = _state;
+
+    bool success = writeTimestamp(timestamp);
+    for (uint8_t c = 0; success && c < _channels; ++c) {
+        success = writeValue(_state.channels[c], floatToBits(values[c]));
+    }
+
+    if (!success) {
+        _writer.setPosition(position);
+        _state = state;
+        return false;
+    }
+
+    ++_count;
+    return true;
+}
+
+bool Encoder::writeTimestamp(uint32_t timestamp)
+{
+    if (_count == 0) {
+        _state.timestamp = timestamp;
+        _state.delta = 0;
+        return _writer.write(timestamp, 32);
+    }
+
+    int32_t delta = static_cast<int32_t>(timestamp - _state.timestamp);
+    int32_t deltaOfDelta = delta - _state.delta;
+    _state.timestamp = timestamp;
+    _state.delta = delta;
+
+    if (deltaOfDelta == 0) {
+        return _writer.write(0, 1);
+    }
+
+    for (auto const& bucket : sBuckets) {
+        if (!fitsSigned(deltaOfDelta, bucket.payloadBits)) { continue; }
+
+        return _writer.write(bucket.prefix, bucket.prefixBits)
+            && _writer.write(static_cast<uint32_t>(deltaOfDelta) & mask(bucket.payloadBits), bucket.payloadBits);
+    }
+
+    return false; // unreachable, the last bucket fits any value
+}
+
+bool Encoder::writeValue(ChannelState& channel, uint32_t value)
+{
+    uint32_t xored = value ^ channel.value;
+    channel.value = value;
+
+    if (xored == 0) {
+        return _writer.write(0, 1);
+    }
+
+    uint8_t leading = __builtin_clz(xored);
+    uint8_t trailing = __builtin_ctz(xored);
+    if (leading > 31) { leading = 31; }
+
+    if (channel.leading != 0xFF && leading >= channel.leading && trailing >= channel.trailing) {
+        uint8_t meaningful = 32 - channel.leading - channel.trailing;
+        return _writer.write(0b10, 2)
+            && _writer.write(xored >> channel.trailing, meaningful);
+    }
+
+    uint8_t meaningful = 32 - leading - trailing;
+    channel.leading = leading;
+    channel.trailing = trailing;
+
+    return _writer.write(0b11, 2)
+        && _writer.write(leading, 5)
+        && _writer.write(meaningful - 1, 5)
+        && _writer.write(xored >> trailing, meaningful);
+}
+
+Decoder::Decoder(uint8_t const* buffer, size_t size, uint8_t channels, uint16_t count)
+    : _reader(buffer, size)
+    , _channels(channels > MaxChannels ? MaxChannels : channels)
+    , _count(count)
+{
+}
+
+bool Decoder::next(uint32_t& timestamp, float* values)
+{
+    if (_index >= _count) { return false; }
+
+    if (!readTimestamp(timestamp)) { return false; }
+
+    for (uint8_t c = 0; c < _channels; ++c) {
+        if (!readValue(_state[c])) { return false; }
+        values[c] = bitsToFloat(_state[c].value);
+    }
+
+    ++_index;
+    return true;
+}
+
+bool Decoder::readTimestamp(uint32_t& timestamp)
+{
+    if (_index == 0) {
+        if (!_reader.read(_timestamp, 32)) { return false; }
+        timestamp = _timestamp;
+        return true;
+    }
+
+    uint32_t bit;
+    if (!_reader.read(bit, 1)) { return false; }
+
+    int32_t deltaOfDelta = 0;
+    if (bit != 0) {
+        uint8_t prefixBits = 1;
+        uint32_t prefix = 1;
+        Bucket const* match = nullptr;
+        while (match == nullptr && prefixBits < 4) {
+            if (!_reader.read(bit, 1)) { return false; }
+            prefix = (prefix << 1) | bit;
+            ++prefixBits;
+            for (auto const& bucket : sBuckets) {
+                if (bucket.prefixBits == prefixBits && bucket.prefix == prefix) {
+                    match = &bucket;
+                    break;
+                }
+            }
+        }
+        if (match == nullptr) { return false; }
+
+        uint32_t payload;
+        if (!_reader.read(payload, match->payloadBits)) { return false; }
+        deltaOfDelta = signExtend(payload, match->payloadBits);
+    }
+
+    _delta += deltaOfDelta;
+    _timestamp += _delta;
+    timestamp = _timestamp;
+    return true;
+}
+
+bool Decoder::readValue(ChannelState& channel)
+{
+    uint32_t bit;
+    if (!_reader.read(bit, 1)) { return false; }
+    if (bit == 0) { return true; }
+
+    if (!_reader.read(bit, 1)) { return false; }
+
+    if (bit != 0) {
+        uint32_t leading, meaningful;
+        if (!_reader.read(leading, 5) || !_reader.read(meaningful, 5)) { return false; }
+        ++meaningful;
+        if (leading + meaningful > 32) { return false; }
+        channel.leading = leading;
+        channel.trailing = 32 - leading - meaningful;
+    }
+
+    uint8_t meaningful = 32 - channel.leading - channel.trailing;
+    uint32_t xored;
+    if (!_reader.read(xored, meaningful)) { return false; }
+
+    channel.value ^= (xored << channel.trailing);
+    return true;
+}
+
+} // namespace TimeSeriesCodec
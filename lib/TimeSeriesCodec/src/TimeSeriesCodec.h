@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// compression of multi-channel time series as described in "Gorilla: A
+// Fast, Scalable, In-Memory Time Series Database" (Pelkonen et al., 2015).
+// timestamps (seconds) are stored as delta-of-delta, values (float) are
+// stored as XOR against the previous value of the same channel. records
+// are appended to a caller-provided, fixed size buffer, which therefore
+// can be written to flash as is and decoded independently of any other
+// buffer.
+namespace TimeSeriesCodec {
+
+static constexpr size_t MaxChannels = 8;
+
+class BitWriter {
+public:
+    BitWriter(uint8_t* buffer, size_t size)
+        : _buffer(buffer)
+        , _sizeBits(size * 8) { }
+
+    // returns false if the bits do not fit. the buffer is left in an
+    // undefined state after the write position in that case.
+    bool write(uint32_t value, uint8_t bits);
+
+    size_t getPosition() const { return _position; }
+    void setPosition(size_t position) { _position = position; }
+
+private:
+    uint8_t* _buffer;
+    size_t _sizeBits;
+    size_t _position = 0;
+};
+
+class BitReader {
+public:
+    BitReader(uint8_t const* buffer, size_t size)
+        : _buffer(buffer)
+        , _sizeBits(size * 8) { }
+
+    bool read(uint32_t& value, uint8_t bits);
+
+private:
+    uint8_t const* _buffer;
+    size_t _sizeBits;
+    size_t _position = 0;
+};
+
+class Encoder {
+public:
+    Encoder(uint8_t* buffer, size_t size, uint8_t channels);
+
+    // appends a record. returns false (and leaves the buffer as it was
+    // before the call) if the record does not fit into the buffer.
+    bool append(uint32_t timestamp, float const* values);
+
+    uint16_t getRecordCount() const { return _count; }
+    uint8_t getChannelCount() const { return _channels; }
+    size_t getBytesUsed() const { return (_writer.getPosition() + 7) / 8; }
+
+private:
+    struct ChannelState {
+        uint32_t value = 0;
+        uint8_t leading = 0xFF;
+        uint8_t trailing = 0;
+    };
+
+    struct State {
+        uint32_t timestamp = 0;
+        int32_t delta = 0;
+        std::array<ChannelState, MaxChannels> channels;
+    };
+
+    bool writeTimestamp(uint32_t timestamp);
+    bool writeValue(ChannelState& channel, uint32_t value);
+
+    BitWriter _writer;
+    uint8_t _channels;
+    uint16_t _count = 0;
+    State _state;
+};
+
+class Decoder {
+public:
+    Decoder(uint8_t const* buffer, size_t size, uint8_t channels, uint16_t count);
+
+    // returns false when all records were read or the data is corrupt
+    bool next(uint32_t& timestamp, float* values);
+
+private:
+    struct ChannelState {
+        uint32_t value = 0;
+        uint8_t leading = 0;
+        uint8_t trailing = 0;
+    };
+
+    bool readTimestamp(uint32_t& timestamp);
+    bool readValue(ChannelState& channel);
+
+    BitReader _reader;
+    uint8_t _channels;
+    uint16_t _count;
+    uint16_t _index = 0;
+    uint32_t _timestamp = 0;
+    int32_t _delta = 0;
+    std::array<ChannelState, MaxChannels> _state;
+};
+
+} // namespace TimeSeriesCodec
@@ -1,8 +1,23 @@
 import os
+import gzip
 import hashlib
 import pickle
+import re
 import subprocess
 
+Import("env")
+
+# content types of the embedded webapp files, by file extension (without
+# the compression suffix)
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".js": "text/javascript",
+    ".json": "application/json",
+    ".ico": "image/x-icon",
+    ".png": "image/png",
+    ".webmanifest": "application/json",
+}
+
 def check_files(directories, filepaths, hash_file):
     old_file_hashes = {}
     file_hashes = {}
@@ -60,6 +75,92 @@ def check_files(directories, filepaths, hash_file):
     with open(hash_file, 'wb') as f:
         pickle.dump(file_hashes, f)
 
+def update_file_if_changed(filename, content):
+    try:
+        with open(filename, "rb") as f:
+            if f.read() == content:
+                return
+    except OSError:
+        pass
+    with open(filename, "wb") as f:
+        f.write(content)
+
+def c_array(name, data):
+    lines = ["static const uint8_t %s[%d] = {" % (name, len(data))]
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    lines.append("};")
+    return "\n".join(lines) + "\n"
+
+def generate_manifest():
+    """
+    creates a C source file which describes all embedded webapp files,
+    including their ETag, such that the web server does not need to hash
+    the (large) files on every request. the list of files is taken from
+    the board_build.embed_files option. if custom_webapp_brotli is set,
+    a brotli compressed variant of each gzip compressed file is added.
+    """
+    embed_files = env.GetProjectOption("board_build.embed_files", "").split()
+
+    with_brotli = env.GetProjectOption("custom_webapp_brotli", "0") in ("1", "true", "yes")
+    if with_brotli:
+        try:
+            import brotli
+        except ModuleNotFoundError:
+            env.Execute('"$PYTHONEXE" -m pip install brotli')
+            import brotli
+
+    body = ""
+    entries = []
+
+    for embed_file in embed_files:
+        if not embed_file.startswith("webapp_dist/"):
+            continue
+
+        with open(embed_file, "rb") as f:
+            data = f.read()
+
+        path = embed_file[len("webapp_dist"):]
+        encoding = ""
+        if path.endswith(".gz"):
+            path = path[:-len(".gz")]
+            encoding = "gzip"
+
+        content_type = CONTENT_TYPES.get(os.path.splitext(path)[1], "application/octet-stream")
+        symbol = "_binary_" + re.sub(r"[^A-Za-z0-9]", "_", embed_file)
+        body += "extern const uint8_t %s_start[];\n" % symbol
+        body += "extern const uint8_t %s_end[];\n" % symbol
+
+        br_data = "NULL"
+        br_size = "0"
+        br_etag = "NULL"
+        if with_brotli and encoding == "gzip":
+            compressed = brotli.compress(gzip.decompress(data), quality=11)
+            if len(compressed) < len(data):
+                br_name = "br" + symbol
+                body += c_array(br_name, compressed)
+                br_data = br_name
+                br_size = "sizeof(%s)" % br_name
+                br_etag = '"\\"%s\\""' % hashlib.md5(compressed).hexdigest()
+
+        entries.append(
+            '    { "%s", "%s", "%s", "\\"%s\\"", %s_start, %s_end, %s, %s, %s },\n' % (
+                path, content_type, encoding, hashlib.md5(data).hexdigest(),
+                symbol, symbol, br_data, br_size, br_etag))
+
+    lines = "/* Generated file within build process - Do NOT edit */\n"
+    lines += "#include \"WebappManifest.h\"\n"
+    lines += "#include <stddef.h>\n\n"
+    lines += body + "\n"
+    lines += "const webapp_asset_t webapp_assets[] = {\n"
+    lines += "".join(entries)
+    lines += "};\n\n"
+    lines += "const size_t webapp_assets_count = %d;\n" % len(entries)
+
+    targetfile = os.path.join(env.subst("$BUILD_DIR"), "__webapp_manifest.c")
+    update_file_if_changed(targetfile, bytes(lines, "utf-8"))
+    env.AppendUnique(PIOBUILDFILES=[targetfile])
+
 def main():
     if os.getenv('GITHUB_ACTIONS') == 'true':
         print("INFO: not testing for up-to-date webapp artifacts when running as Github action")
@@ -76,3 +177,4 @@ def main():
     check_files(directories, files, hash_file)
 
 main()
+generate_manifest()
@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "BootProfiler.h"
+#include "MessageOutput.h"
+#include <algorithm>
+#include <esp_timer.h>
+
+BootProfilerClass BootProfiler;
+
+void BootProfilerClass::endStage(char const* name)
+{
+    int64_t now = esp_timer_get_time();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stages.push_back({ name, static_cast<uint32_t>(now - _lastStageEnd) });
+    _lastStageEnd = now;
+}
+
+void BootProfilerClass::reach(Milestone milestone)
+{
+    auto& reached = _milestones[static_cast<size_t>(milestone)];
+    if (reached.load() != 0) { return; }
+
+    // avoid zero, which means "not reached"
+    reached = std::max<uint32_t>(1, esp_timer_get_time() / 1000);
+}
+
+std::vector<BootProfilerClass::Stage> BootProfilerClass::getStages() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stages;
+}
+
+uint32_t BootProfilerClass::getMillis(Milestone milestone) const
+{
+    return _milestones[static_cast<size_t>(milestone)].load();
+}
+
+char const* BootProfilerClass::getName(Milestone milestone)
+{
+    switch (milestone) {
+        case Milestone::SetupDone:
+            return "setup_done";
+        case Milestone::FirstDplCalculation:
+            return "first_dpl_calculation";
+        case Milestone::FirstLimitCommand:
+            return "first_limit_command";
+        case Milestone::Count:
+            break;
+    }
+
+    return "unknown";
+}
+
+void BootProfilerClass::printSummary() const
+{
+    MessageOutput.println("Boot stages:");
+    for (auto const& stage : getStages()) {
+        MessageOutput.printf("    %-16s %6.1f ms\r\n", stage.name, stage.durationUs / 1000.0);
+    }
+}
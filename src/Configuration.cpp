@@ -122,9 +122,17 @@ void ConfigurationClass::serializePowerMeterHttpSmlConfig(PowerMeterHttpSmlConfi
 void ConfigurationClass::serializePowerMeterUdpVictronConfig(PowerMeterUdpVictronConfig const& source, JsonObject& target)
 {
     target["polling_interval_ms"] = source.PollingIntervalMs;
+    target["adaptive_polling"] = source.AdaptivePolling;
     target["ip_address"] = IPAddress(source.IpAddress).toString();
 }
 
+void ConfigurationClass::serializePowerMeterFusionConfig(PowerMeterFusionConfig const& source, JsonObject& target)
+{
+    target["fast_source"] = source.FastSource;
+    target["slow_source"] = source.SlowSource;
+    target["correction_time_constant"] = source.CorrectionTimeConstant;
+}
+
 void ConfigurationClass::serializeBatteryConfig(BatteryConfig const& source, JsonObject& target)
 {
     target["enabled"] = config.Battery.Enabled;
@@ -198,6 +206,9 @@ void ConfigurationClass::serializePowerLimiterConfig(PowerLimiterConfig const& s
     target["inverter_channel_id_for_dc_voltage"] = source.InverterChannelIdForDcVoltage;
     target["inverter_restart_hour"] = source.RestartHour;
     target["total_upper_power_limit"] = source.TotalUpperPowerLimit;
+    target["predictive_enabled"] = source.PredictiveEnabled;
+    target["ramp_rate_limit"] = source.RampRateLimit;
+    target["failsafe_enabled"] = source.FailsafeEnabled;
 
     JsonArray inverters = target["inverters"].to<JsonArray>();
     for (size_t i = 0; i < INV_MAX_COUNT; ++i) {
@@ -267,6 +278,7 @@ bool ConfigurationClass::write()
     syslog["enabled"] = config.Syslog.Enabled;
     syslog["hostname"] = config.Syslog.Hostname;
     syslog["port"] = config.Syslog.Port;
+    syslog["use_tcp"] = config.Syslog.UseTcp;
 
     JsonObject ntp = doc["ntp"].to<JsonObject>();
     ntp["server"] = config.Ntp.Server;
@@ -391,6 +403,9 @@ bool ConfigurationClass::write()
     JsonObject powermeter_udp_victron = powermeter["udp_victron"].to<JsonObject>();
     serializePowerMeterUdpVictronConfig(config.PowerMeter.UdpVictron, powermeter_udp_victron);
 
+    JsonObject powermeter_fusion = powermeter["fusion"].to<JsonObject>();
+    serializePowerMeterFusionConfig(config.PowerMeter.Fusion, powermeter_fusion);
+
     JsonObject powerlimiter = doc["powerlimiter"].to<JsonObject>();
     serializePowerLimiterConfig(config.PowerLimiter, powerlimiter);
 
@@ -403,6 +418,11 @@ bool ConfigurationClass::write()
     JsonObject huawei = doc["huawei"].to<JsonObject>();
     serializeGridChargerConfig(config.Huawei, huawei);
 
+    JsonObject history = doc["history"].to<JsonObject>();
+    history["enabled"] = config.History.Enabled;
+    history["interval"] = config.History.Interval;
+    history["max_size_kb"] = config.History.MaxSizeKb;
+
     if (!Utils::checkJsonAlloc(doc, __FUNCTION__, __LINE__)) {
         return false;
     }
@@ -500,6 +520,7 @@ void ConfigurationClass::deserializePowerMeterHttpSmlConfig(JsonObject const& so
 void ConfigurationClass::deserializePowerMeterUdpVictronConfig(JsonObject const& source, PowerMeterUdpVictronConfig& target)
 {
     target.PollingIntervalMs = source["polling_interval_ms"] | POWERMETER_POLLING_INTERVAL * 1000;
+    target.AdaptivePolling = source["adaptive_polling"] | POWERMETER_UDP_VICTRON_ADAPTIVE_POLLING;
     IPAddress ip;
     ip.fromString(source["ip_address"] | "");
     target.IpAddress[0] = ip[0];
@@ -508,6 +529,13 @@ void ConfigurationClass::deserializePowerMeterUdpVictronConfig(JsonObject const&
     target.IpAddress[3] = ip[3];
 }
 
+void ConfigurationClass::deserializePowerMeterFusionConfig(JsonObject const& source, PowerMeterFusionConfig& target)
+{
+    target.FastSource = source["fast_source"] | POWERMETER_FUSION_FAST_SOURCE;
+    target.SlowSource = source["slow_source"] | POWERMETER_FUSION_SLOW_SOURCE;
+    target.CorrectionTimeConstant = source["correction_time_constant"] | POWERMETER_FUSION_CORRECTION_TIME_CONSTANT;
+}
+
 void ConfigurationClass::deserializeBatteryConfig(JsonObject const& source, BatteryConfig& target)
 {
     target.Enabled = source["enabled"] | BATTERY_ENABLED;
@@ -577,6 +605,9 @@ void ConfigurationClass::deserializePowerLimiterConfig(JsonObject const& source,
     target.InverterChannelIdForDcVoltage = source["inverter_channel_id_for_dc_voltage"] | POWERLIMITER_INVERTER_CHANNEL_ID;
     target.RestartHour = source["inverter_restart_hour"] | POWERLIMITER_RESTART_HOUR;
     target.TotalUpperPowerLimit = source["total_upper_power_limit"] | POWERLIMITER_UPPER_POWER_LIMIT;
+    target.PredictiveEnabled = source["predictive_enabled"] | POWERLIMITER_PREDICTIVE_ENABLED;
+    target.RampRateLimit = source["ramp_rate_limit"] | POWERLIMITER_RAMP_RATE_LIMIT;
+    target.FailsafeEnabled = source["failsafe_enabled"] | POWERLIMITER_FAILSAFE_ENABLED;
 
     JsonArray inverters = source["inverters"].as<JsonArray>();
     for (size_t i = 0; i < INV_MAX_COUNT; ++i) {
@@ -692,6 +723,7 @@ bool ConfigurationClass::read()
     config.Syslog.Enabled = syslog["enabled"] | SYSLOG_ENABLED;
     strlcpy(config.Syslog.Hostname, syslog["hostname"] | "", sizeof(config.Syslog.Hostname));
     config.Syslog.Port = syslog["port"] | SYSLOG_PORT;
+    config.Syslog.UseTcp = syslog["use_tcp"] | SYSLOG_USE_TCP;
 
     JsonObject ntp = doc["ntp"];
     strlcpy(config.Ntp.Server, ntp["server"] | NTP_SERVER, sizeof(config.Ntp.Server));
@@ -805,6 +837,7 @@ bool ConfigurationClass::read()
     deserializePowerMeterHttpSmlConfig(powermeter["http_sml"], config.PowerMeter.HttpSml);
 
     deserializePowerMeterUdpVictronConfig(powermeter["udp_victron"], config.PowerMeter.UdpVictron);
+    deserializePowerMeterFusionConfig(powermeter["fusion"], config.PowerMeter.Fusion);
 
     deserializePowerLimiterConfig(doc["powerlimiter"], config.PowerLimiter);
 
@@ -814,6 +847,11 @@ bool ConfigurationClass::read()
 
     deserializeGridChargerConfig(doc["huawei"], config.Huawei);
 
+    JsonObject history = doc["history"];
+    config.History.Enabled = history["enabled"] | HISTORY_ENABLED;
+    config.History.Interval = history["interval"] | HISTORY_INTERVAL;
+    config.History.MaxSizeKb = history["max_size_kb"] | HISTORY_MAX_SIZE_KB;
+
     f.close();
 
     // Check for default DTU serial
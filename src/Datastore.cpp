@@ -5,6 +5,7 @@
 #include "Datastore.h"
 #include "Configuration.h"
 #include <Hoymiles.h>
+#include <algorithm>
 
 DatastoreClass Datastore;
 
@@ -21,195 +22,231 @@ void DatastoreClass::init(Scheduler& scheduler)
 
 void DatastoreClass::loop()
 {
+    // the statistics are not consistent while the radio is receiving
     if (!Hoymiles.isAllRadioIdle()) {
         _loopTask.forceNextIteration();
         return;
     }
 
-    uint8_t isProducing = 0;
-    uint8_t isReachable = 0;
-    uint8_t pollEnabledCount = 0;
+    bool changed = false;
+    uint8_t numInverters = std::min<uint8_t>(Hoymiles.getNumInverters(), INV_MAX_COUNT);
 
-    std::lock_guard<std::mutex> lock(_mutex);
+    for (uint8_t i = 0; i < INV_MAX_COUNT; i++) {
+        auto& contrib = _contributions[i];
 
-    _totalAcYieldTotalEnabled = 0;
-    _totalAcYieldTotalDigits = 0;
-
-    _totalAcYieldDayEnabled = 0;
-    _totalAcYieldDayDigits = 0;
-
-    _totalAcPowerEnabled = 0;
-    _totalAcPowerDigits = 0;
-
-    _totalDcPowerEnabled = 0;
-    _totalDcPowerDigits = 0;
+        auto inv = (i < numInverters) ? Hoymiles.getInverterByPos(i) : nullptr;
+        auto cfg = (inv != nullptr) ? Configuration.getInverterConfig(inv->serial()) : nullptr;
+        if (cfg == nullptr) {
+            changed |= contrib.valid || _reachable[i];
+            contrib = InverterContribution();
+            _reachable[i] = false;
+            continue;
+        }
 
-    _totalDcPowerIrradiation = 0;
-    _totalDcIrradiationInstalled = 0;
+        // reachability depends on failed requests, which do not update the statistics
+        bool reachable = inv->isReachable();
+        changed |= (reachable != _reachable[i]);
+        _reachable[i] = reachable;
 
-    _isAllEnabledProducing = true;
-    _isAllEnabledReachable = true;
+        auto stats = inv->Statistics();
 
-    for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
-        auto inv = Hoymiles.getInverterByPos(i);
-        if (inv == nullptr) {
-            continue;
+        uint32_t stringMaxPower = 0;
+        for (uint8_t c = 0; c < CH_CNT; c++) {
+            stringMaxPower += stats->getStringMaxPower(c);
         }
 
-        auto cfg = Configuration.getInverterConfig(inv->serial());
-        if (cfg == nullptr) {
+        if (contrib.valid
+            && contrib.serial == inv->serial()
+            && contrib.lastUpdate == stats->getLastUpdateFromInternal()
+            && contrib.pollEnabled == inv->getEnablePolling()
+            && contrib.cfgPollEnabled == cfg->Poll_Enable
+            && contrib.stringMaxPower == stringMaxPower) {
             continue;
         }
 
-        if (inv->getEnablePolling()) {
-            pollEnabledCount++;
-        }
-
-        if (inv->isProducing()) {
-            isProducing++;
-        } else {
-            if (inv->getEnablePolling()) {
-                _isAllEnabledProducing = false;
+        InverterContribution updated;
+        updated.valid = true;
+        updated.serial = inv->serial();
+        updated.lastUpdate = stats->getLastUpdateFromInternal();
+        updated.pollEnabled = inv->getEnablePolling();
+        updated.cfgPollEnabled = cfg->Poll_Enable;
+        updated.stringMaxPower = stringMaxPower;
+        updated.producing = inv->isProducing();
+
+        if (updated.cfgPollEnabled) {
+            for (auto& c : stats->getChannelsByType(TYPE_INV)) {
+                updated.acYieldTotal += stats->getChannelFieldValue(TYPE_INV, c, FLD_YT);
+                updated.acYieldDay += stats->getChannelFieldValue(TYPE_INV, c, FLD_YD);
+
+                updated.acYieldTotalDigits = max<unsigned int>(updated.acYieldTotalDigits, stats->getChannelFieldDigits(TYPE_INV, c, FLD_YT));
+                updated.acYieldDayDigits = max<unsigned int>(updated.acYieldDayDigits, stats->getChannelFieldDigits(TYPE_INV, c, FLD_YD));
             }
         }
 
-        if (inv->isReachable()) {
-            isReachable++;
-        } else {
-            if (inv->getEnablePolling()) {
-                _isAllEnabledReachable = false;
+        if (updated.pollEnabled) {
+            for (auto& c : stats->getChannelsByType(TYPE_AC)) {
+                updated.acPower += stats->getChannelFieldValue(TYPE_AC, c, FLD_PAC);
+                updated.acPowerDigits = max<unsigned int>(updated.acPowerDigits, stats->getChannelFieldDigits(TYPE_AC, c, FLD_PAC));
             }
-        }
 
-        for (auto& c : inv->Statistics()->getChannelsByType(TYPE_INV)) {
-            if (cfg->Poll_Enable) {
-                _totalAcYieldTotalEnabled += inv->Statistics()->getChannelFieldValue(TYPE_INV, c, FLD_YT);
-                _totalAcYieldDayEnabled += inv->Statistics()->getChannelFieldValue(TYPE_INV, c, FLD_YD);
+            for (auto& c : stats->getChannelsByType(TYPE_DC)) {
+                float dcPower = stats->getChannelFieldValue(TYPE_DC, c, FLD_PDC);
+                updated.dcPower += dcPower;
+                updated.dcPowerDigits = max<unsigned int>(updated.dcPowerDigits, stats->getChannelFieldDigits(TYPE_DC, c, FLD_PDC));
 
-                _totalAcYieldTotalDigits = max<unsigned int>(_totalAcYieldTotalDigits, inv->Statistics()->getChannelFieldDigits(TYPE_INV, c, FLD_YT));
-                _totalAcYieldDayDigits = max<unsigned int>(_totalAcYieldDayDigits, inv->Statistics()->getChannelFieldDigits(TYPE_INV, c, FLD_YD));
+                if (stats->getStringMaxPower(c) > 0) {
+                    updated.dcPowerIrradiation += dcPower;
+                    updated.dcIrradiationInstalled += stats->getStringMaxPower(c);
+                }
             }
         }
 
-        for (auto& c : inv->Statistics()->getChannelsByType(TYPE_AC)) {
-            if (inv->getEnablePolling()) {
-                _totalAcPowerEnabled += inv->Statistics()->getChannelFieldValue(TYPE_AC, c, FLD_PAC);
-                _totalAcPowerDigits = max<unsigned int>(_totalAcPowerDigits, inv->Statistics()->getChannelFieldDigits(TYPE_AC, c, FLD_PAC));
-            }
+        contrib = updated;
+        changed = true;
+    }
+
+    if (!changed) {
+        return;
+    }
+
+    // the totals are summed up from the cached contributions rather than
+    // by applying the difference to the previous totals, such that float
+    // rounding errors cannot accumulate over time.
+    Totals totals;
+    totals.isAllEnabledProducing = true;
+    totals.isAllEnabledReachable = true;
+
+    for (uint8_t i = 0; i < INV_MAX_COUNT; i++) {
+        auto const& contrib = _contributions[i];
+        if (!contrib.valid) {
+            continue;
         }
 
-        for (auto& c : inv->Statistics()->getChannelsByType(TYPE_DC)) {
-            if (inv->getEnablePolling()) {
-                _totalDcPowerEnabled += inv->Statistics()->getChannelFieldValue(TYPE_DC, c, FLD_PDC);
-                _totalDcPowerDigits = max<unsigned int>(_totalDcPowerDigits, inv->Statistics()->getChannelFieldDigits(TYPE_DC, c, FLD_PDC));
+        totals.isAtLeastOnePollEnabled |= contrib.pollEnabled;
+        totals.isAtLeastOneProducing |= contrib.producing;
+        totals.isAtLeastOneReachable |= _reachable[i];
 
-                if (inv->Statistics()->getStringMaxPower(c) > 0) {
-                    _totalDcPowerIrradiation += inv->Statistics()->getChannelFieldValue(TYPE_DC, c, FLD_PDC);
-                    _totalDcIrradiationInstalled += inv->Statistics()->getStringMaxPower(c);
-                }
-            }
+        if (contrib.pollEnabled) {
+            totals.isAllEnabledProducing &= contrib.producing;
+            totals.isAllEnabledReachable &= _reachable[i];
         }
+
+        totals.acYieldTotalEnabled += contrib.acYieldTotal;
+        totals.acYieldDayEnabled += contrib.acYieldDay;
+        totals.acPowerEnabled += contrib.acPower;
+        totals.dcPowerEnabled += contrib.dcPower;
+        totals.dcPowerIrradiation += contrib.dcPowerIrradiation;
+        totals.dcIrradiationInstalled += contrib.dcIrradiationInstalled;
+
+        totals.acYieldTotalDigits = max<unsigned int>(totals.acYieldTotalDigits, contrib.acYieldTotalDigits);
+        totals.acYieldDayDigits = max<unsigned int>(totals.acYieldDayDigits, contrib.acYieldDayDigits);
+        totals.acPowerDigits = max<unsigned int>(totals.acPowerDigits, contrib.acPowerDigits);
+        totals.dcPowerDigits = max<unsigned int>(totals.dcPowerDigits, contrib.dcPowerDigits);
     }
 
-    _isAtLeastOneProducing = isProducing > 0;
-    _isAtLeastOneReachable = isReachable > 0;
-    _isAtLeastOnePollEnabled = pollEnabledCount > 0;
+    totals.dcIrradiation = totals.dcIrradiationInstalled > 0 ? totals.dcPowerIrradiation / totals.dcIrradiationInstalled * 100.0f : 0;
+
+    publish(totals);
+}
+
+void DatastoreClass::publish(Totals const& totals)
+{
+    // only the loop task writes, so the sequence number cannot change meanwhile
+    uint32_t sequence = _sequence.load(std::memory_order_relaxed) + 1;
+    _totals[sequence & 1] = totals;
+    _sequence.store(sequence, std::memory_order_release);
+}
+
+DatastoreClass::Totals DatastoreClass::getTotals() const
+{
+    Totals totals;
+    uint32_t sequence;
+
+    do {
+        sequence = _sequence.load(std::memory_order_acquire);
+        totals = _totals[sequence & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while (sequence != _sequence.load(std::memory_order_relaxed));
 
-    _totalDcIrradiation = _totalDcIrradiationInstalled > 0 ? _totalDcPowerIrradiation / _totalDcIrradiationInstalled * 100.0f : 0;
+    return totals;
 }
 
 float DatastoreClass::getTotalAcYieldTotalEnabled()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _totalAcYieldTotalEnabled;
+    return getTotals().acYieldTotalEnabled;
 }
 
 float DatastoreClass::getTotalAcYieldDayEnabled()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _totalAcYieldDayEnabled;
+    return getTotals().acYieldDayEnabled;
 }
 
 float DatastoreClass::getTotalAcPowerEnabled()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _totalAcPowerEnabled;
+    return getTotals().acPowerEnabled;
 }
 
 float DatastoreClass::getTotalDcPowerEnabled()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _totalDcPowerEnabled;
+    return getTotals().dcPowerEnabled;
 }
 
 float DatastoreClass::getTotalDcPowerIrradiation()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _totalDcPowerIrradiation;
+    return getTotals().dcPowerIrradiation;
 }
 
 float DatastoreClass::getTotalDcIrradiationInstalled()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _totalDcIrradiationInstalled;
+    return getTotals().dcIrradiationInstalled;
 }
 
 float DatastoreClass::getTotalDcIrradiation()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _totalDcIrradiation;
+    return getTotals().dcIrradiation;
 }
 
 uint32_t DatastoreClass::getTotalAcYieldTotalDigits()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _totalAcYieldTotalDigits;
+    return getTotals().acYieldTotalDigits;
 }
 
 uint32_t DatastoreClass::getTotalAcYieldDayDigits()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _totalAcYieldDayDigits;
+    return getTotals().acYieldDayDigits;
 }
 
 uint32_t DatastoreClass::getTotalAcPowerDigits()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _totalAcPowerDigits;
+    return getTotals().acPowerDigits;
 }
 
 uint32_t DatastoreClass::getTotalDcPowerDigits()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _totalDcPowerDigits;
+    return getTotals().dcPowerDigits;
 }
 
 bool DatastoreClass::getIsAtLeastOneReachable()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _isAtLeastOneReachable;
+    return getTotals().isAtLeastOneReachable;
 }
 
 bool DatastoreClass::getIsAtLeastOneProducing()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _isAtLeastOneProducing;
+    return getTotals().isAtLeastOneProducing;
 }
 
 bool DatastoreClass::getIsAllEnabledProducing()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _isAllEnabledProducing;
+    return getTotals().isAllEnabledProducing;
 }
 
 bool DatastoreClass::getIsAllEnabledReachable()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _isAllEnabledReachable;
+    return getTotals().isAllEnabledReachable;
 }
 
 bool DatastoreClass::getIsAtLeastOnePollEnabled()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _isAtLeastOnePollEnabled;
+    return getTotals().isAtLeastOnePollEnabled;
 }
@@ -34,14 +34,8 @@ void DisplayGraphicDiagramClass::averageLoop()
 
 void DisplayGraphicDiagramClass::dataPointLoop()
 {
-    if (_graphValuesCount >= std::size(_graphValues)) {
-        for (uint8_t i = 0; i < std::size(_graphValues) - 1; i++) {
-            _graphValues[i] = _graphValues[i + 1];
-        }
-        _graphValuesCount = std::size(_graphValues) - 1;
-    }
     if (_iRunningAverageCnt != 0) {
-        _graphValues[_graphValuesCount++] = _iRunningAverage / _iRunningAverageCnt;
+        _graphValues.push(_iRunningAverage / _iRunningAverageCnt);
         _iRunningAverage = 0;
         _iRunningAverageCnt = 0;
     }
@@ -83,7 +77,8 @@ void DisplayGraphicDiagramClass::redraw(uint8_t screenSaverOffsetX, uint8_t xPos
 
     // draw AC value
     char fmtText[7];
-    const float maxWatts = *std::max_element(_graphValues.begin(), _graphValues.end());
+    float maxWatts = 0;
+    _graphValues.forEach([&maxWatts](float value) { maxWatts = std::max(maxWatts, value); });
     if (maxWatts > 999) {
         snprintf(fmtText, sizeof(fmtText), "%2.1fkW", maxWatts / 1000);
     } else {
@@ -118,7 +113,7 @@ void DisplayGraphicDiagramClass::redraw(uint8_t screenSaverOffsetX, uint8_t xPos
     }
 
     uint8_t xAxisTicks = 1;
-    for (uint8_t i = 1; i < _graphValuesCount; i++) {
+    for (uint8_t i = 1; i < _graphValues.size(); i++) {
         // draw one tick per hour to the x-axis
         if (i * getSecondsPerDot() > (3600u * xAxisTicks)) {
             _display->drawPixel((graphPosX + 1 + i) * scaleFactorX, graphPosY + height);
@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "History.h"
+#include "Datastore.h"
+#include <battery/Controller.h>
+#include <powermeter/Controller.h>
+#include <algorithm>
+#include <cmath>
+
+History::Recorder HistoryRecorder;
+
+namespace History {
+
+Sample Series::encode(float value) const
+{
+    float scaled = std::round(value / _resolution);
+    // the smallest value is reserved as the marker for invalid samples
+    scaled = std::clamp<float>(scaled, INT16_MIN + 1, INT16_MAX);
+    return static_cast<Sample>(scaled);
+}
+
+float Series::decode(Sample sample) const
+{
+    return sample * _resolution;
+}
+
+void Series::Accumulator::add(Sample sampleMin, Sample sampleMax, Sample sampleAvg)
+{
+    ++count;
+
+    if (sampleAvg == InvalidSample) { return; }
+
+    min = (min == InvalidSample) ? sampleMin : std::min(min, sampleMin);
+    max = (max == InvalidSample) ? sampleMax : std::max(max, sampleMax);
+    sum += sampleAvg;
+    ++validCount;
+}
+
+Aggregate Series::Accumulator::get() const
+{
+    Aggregate res;
+    if (validCount == 0) { return res; }
+
+    res.min = min;
+    res.max = max;
+    res.avg = static_cast<Sample>(sum / validCount);
+    return res;
+}
+
+void Series::append(float value, bool valid)
+{
+    Sample sample = valid ? encode(value) : InvalidSample;
+    _raw.push(sample);
+
+    _minuteAccumulator.add(sample, sample, sample);
+    if (_minuteAccumulator.count < 60) { return; }
+
+    auto minute = _minuteAccumulator.get();
+    _minuteAccumulator.reset();
+    _minutes.push(minute);
+
+    _quarterAccumulator.add(minute.min, minute.max, minute.avg);
+    if (_quarterAccumulator.count < 15) { return; }
+
+    _quarters.push(_quarterAccumulator.get());
+    _quarterAccumulator.reset();
+}
+
+Recorder::Recorder()
+    : _loopTask(1 * TASK_SECOND, TASK_FOREVER, std::bind(&Recorder::loop, this))
+    , _series({
+        Series("ac_power", "W", 1.0f),
+        Series("battery_soc", "%", 0.01f),
+        Series("grid_power", "W", 1.0f)
+    })
+{
+}
+
+void Recorder::init(Scheduler& scheduler)
+{
+    scheduler.addTask(_loopTask);
+    _loopTask.enable();
+}
+
+void Recorder::loop()
+{
+    float acPower = Datastore.getTotalAcPowerEnabled();
+    bool acPowerValid = Datastore.getIsAtLeastOnePollEnabled();
+
+    auto spStats = Battery.getStats();
+    float soc = spStats->getSoC();
+    bool socValid = spStats->isSoCValid() && spStats->getSoCAgeSeconds() < 60;
+
+    float gridPower = PowerMeter.getPowerTotal();
+    bool gridPowerValid = PowerMeter.isDataValid();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _series[static_cast<size_t>(SeriesId::AcPower)].append(acPower, acPowerValid);
+    _series[static_cast<size_t>(SeriesId::BatterySoC)].append(soc, socValid);
+    _series[static_cast<size_t>(SeriesId::GridPower)].append(gridPower, gridPowerValid);
+
+    _lastSampleUptime = millis() / 1000;
+}
+
+} // namespace History
@@ -0,0 +1,381 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "HistoryLog.h"
+#include "Configuration.h"
+#include "Datastore.h"
+#include "MessageOutput.h"
+#include "PowerLimiter.h"
+#include "Utils.h"
+#include <battery/Controller.h>
+#include <powermeter/Controller.h>
+#include <LittleFS.h>
+#include <algorithm>
+#include <cmath>
+
+#define HISTORY_LOG_DIR "/history"
+
+History::FlashLog HistoryLog;
+
+namespace History {
+
+static constexpr uint32_t BlockMagic = 0x53544448; // "HDTS"
+static constexpr uint8_t BlockVersion = 1;
+
+FlashLog::FlashLog()
+    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&FlashLog::loop, this))
+{
+}
+
+void FlashLog::init(Scheduler& scheduler)
+{
+    scheduler.addTask(_loopTask);
+
+    if (!LittleFS.exists(HISTORY_LOG_DIR)) {
+        LittleFS.mkdir(HISTORY_LOG_DIR);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        resetBlock();
+    }
+
+    updateSettings();
+}
+
+void FlashLog::startScan()
+{
+    if (_scanStarted.exchange(true)) { return; }
+
+    // scanning the segment files takes a while if there are many of them.
+    // this shall not delay the initialization of the other modules.
+    uint32_t constexpr stackSize = 4096;
+    if (pdPASS != xTaskCreate(FlashLog::scanSegmentsHelper, "HistoryScan",
+            stackSize, this, 1/*prio*/, nullptr)) {
+        scanSegments();
+    }
+}
+
+void FlashLog::scanSegmentsHelper(void* context)
+{
+    static_cast<FlashLog*>(context)->scanSegments();
+    vTaskDelete(nullptr);
+}
+
+void FlashLog::updateSettings()
+{
+    auto const& config = Configuration.get();
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t segmentSize = BlockSize * BlocksPerSegment;
+        _maxSegments = std::max<size_t>(1, config.History.MaxSizeKb * 1024 / segmentSize);
+        enforceStorageLimit();
+    }
+
+    if (!config.History.Enabled) {
+        _loopTask.disable();
+        return;
+    }
+
+    // the segments are only scanned once the history is enabled
+    startScan();
+
+    _loopTask.setInterval(std::max<uint32_t>(1, config.History.Interval) * TASK_SECOND);
+    _loopTask.enable();
+}
+
+char const* FlashLog::getChannelName(Channel channel)
+{
+    switch (channel) {
+    case Channel::InverterAcPower:
+        return "inverter_ac_power";
+    case Channel::InverterDcPower:
+        return "inverter_dc_power";
+    case Channel::BatterySoC:
+        return "battery_soc";
+    case Channel::BatteryPower:
+        return "battery_power";
+    case Channel::GridPower:
+        return "grid_power";
+    case Channel::PowerLimiterTarget:
+        return "dpl_target";
+    default:
+        break;
+    }
+    return "unknown";
+}
+
+FlashLog::Values FlashLog::collect() const
+{
+    Values values;
+    values.fill(NAN);
+
+    // values are rounded to a sensible resolution, which considerably
+    // improves the XOR compression ratio.
+    auto set = [&values](Channel channel, float value, float resolution) {
+        values[static_cast<size_t>(channel)] = std::round(value / resolution) * resolution;
+    };
+
+    if (Datastore.getIsAtLeastOnePollEnabled()) {
+        set(Channel::InverterAcPower, Datastore.getTotalAcPowerEnabled(), 1.0f);
+        set(Channel::InverterDcPower, Datastore.getTotalDcPowerEnabled(), 1.0f);
+    }
+
+    auto spStats = Battery.getStats();
+    if (spStats->isSoCValid()) {
+        set(Channel::BatterySoC, spStats->getSoC(), 0.1f);
+    }
+    if (spStats->isVoltageValid() && spStats->isCurrentValid()) {
+        set(Channel::BatteryPower, spStats->getVoltage() * spStats->getChargeCurrent(), 1.0f);
+    }
+
+    if (PowerMeter.isDataValid()) {
+        set(Channel::GridPower, PowerMeter.getPowerTotal(), 1.0f);
+    }
+
+    set(Channel::PowerLimiterTarget, PowerLimiter.getInverterOutput(), 1.0f);
+
+    return values;
+}
+
+void FlashLog::loop()
+{
+    // don't block the scheduler while the segments are being scanned
+    if (!_segmentsScanned) { return; }
+
+    time_t now;
+    if (!Utils::getEpoch(&now, 0)) { return; }
+
+    auto values = collect();
+    uint32_t timestamp = static_cast<uint32_t>(now);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_upEncoder->append(timestamp, values.data())) {
+        if (_block.header.recordCount == 0) {
+            _block.header.firstTimestamp = timestamp;
+        }
+        _block.header.lastTimestamp = timestamp;
+        _block.header.recordCount = _upEncoder->getRecordCount();
+        return;
+    }
+
+    // block is full
+    writeBlock();
+    resetBlock();
+
+    if (!_upEncoder->append(timestamp, values.data())) { return; }
+
+    _block.header.firstTimestamp = _block.header.lastTimestamp = timestamp;
+    _block.header.recordCount = _upEncoder->getRecordCount();
+}
+
+void FlashLog::flush()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_block.header.recordCount == 0) { return; }
+
+    writeBlock();
+    resetBlock();
+}
+
+void FlashLog::resetBlock()
+{
+    memset(&_block, 0, sizeof(_block));
+    _block.header.magic = BlockMagic;
+    _block.header.channelCount = ChannelCount;
+    _block.header.version = BlockVersion;
+    _upEncoder = std::make_unique<TimeSeriesCodec::Encoder>(_block.payload, PayloadSize, ChannelCount);
+}
+
+bool FlashLog::writeBlock()
+{
+    if (_segments.empty() || _blocksInSegment >= BlocksPerSegment) {
+        startSegment(_block.header.firstTimestamp);
+    }
+
+    File f = LittleFS.open(_segments.back(), "a");
+    if (!f) {
+        MessageOutput.printf("[History] failed to open %s\r\n", _segments.back().c_str());
+        return false;
+    }
+
+    size_t written = f.write(reinterpret_cast<uint8_t const*>(&_block), sizeof(_block));
+    f.close();
+
+    if (written != sizeof(_block)) {
+        // blocks appended after a torn one would not be aligned to the
+        // block size, hence the next block starts a new segment. readers
+        // skip the incomplete block at the end of this one.
+        MessageOutput.printf("[History] short write to %s\r\n", _segments.back().c_str());
+        _blocksInSegment = BlocksPerSegment;
+        return false;
+    }
+
+    ++_blocksInSegment;
+    return true;
+}
+
+String FlashLog::startSegment(uint32_t timestamp)
+{
+    char path[32];
+    snprintf(path, sizeof(path), HISTORY_LOG_DIR "/%08" PRIx32 ".bin", timestamp);
+
+    _segments.emplace_back(path);
+    _blocksInSegment = 0;
+
+    enforceStorageLimit();
+
+    return _segments.back();
+}
+
+void FlashLog::scanSegments()
+{
+    // the directory is listed without holding the lock, such that queries
+    // and settings changes are not blocked for the duration of the scan.
+    std::vector<String> segments;
+
+    File dir = LittleFS.open(HISTORY_LOG_DIR);
+    if (dir && dir.isDirectory()) {
+        File file = dir.openNextFile();
+        while (file) {
+            String path = String(HISTORY_LOG_DIR "/") + file.name();
+            if (!file.isDirectory() && path.endsWith(".bin")) {
+                segments.push_back(path);
+            }
+            file.close();
+            file = dir.openNextFile();
+        }
+    }
+
+    // file names are fixed width hex timestamps, hence they sort chronologically
+    std::sort(segments.begin(), segments.end());
+
+    uint8_t blocksInSegment = 0;
+    if (!segments.empty()) {
+        File last = LittleFS.open(segments.back(), "r");
+        size_t size = last.size();
+        last.close();
+
+        // a segment ending with a torn block is not appended to, as the
+        // blocks would not be aligned to the block size any more.
+        blocksInSegment = (size % BlockSize == 0) ? size / BlockSize : BlocksPerSegment;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _segments = std::move(segments);
+    _blocksInSegment = blocksInSegment;
+    enforceStorageLimit();
+    _segmentsScanned = true;
+}
+
+void FlashLog::enforceStorageLimit()
+{
+    while (_segments.size() > _maxSegments) {
+        LittleFS.remove(_segments.front());
+        _segments.erase(_segments.begin());
+    }
+}
+
+std::unique_ptr<FlashLog::Cursor> FlashLog::query(uint32_t start, uint32_t end) const
+{
+    std::unique_ptr<Cursor> upCursor(new Cursor(start, end));
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // skip segments which only hold data older than the requested range
+    size_t first = 0;
+    for (size_t i = 1; i < _segments.size(); ++i) {
+        uint32_t segmentStart = strtoul(_segments[i].c_str() + strlen(HISTORY_LOG_DIR "/"), nullptr, 16);
+        if (segmentStart <= start) { first = i; }
+    }
+    upCursor->_segments.assign(_segments.begin() + first, _segments.end());
+
+    // blocks written after the snapshot was taken are not read, as the
+    // pending block below might be among them.
+    upCursor->_lastSegmentBlocks = _blocksInSegment;
+
+    if (_block.header.recordCount > 0) {
+        upCursor->_pendingBlock = _block;
+        upCursor->_pendingBlockValid = true;
+    }
+
+    return upCursor;
+}
+
+bool FlashLog::Cursor::loadNextBlock()
+{
+    _upDecoder = nullptr;
+
+    while (_segmentIdx < _segments.size()) {
+        bool lastSegment = (_segmentIdx + 1 == _segments.size());
+        if (lastSegment && _blockIdx >= _lastSegmentBlocks) {
+            ++_segmentIdx;
+            break;
+        }
+
+        File f = LittleFS.open(_segments[_segmentIdx], "r");
+        bool valid = f && f.seek(_blockIdx * BlockSize)
+            && f.read(reinterpret_cast<uint8_t*>(&_block), sizeof(_block)) == sizeof(_block);
+        if (f) { f.close(); }
+
+        if (!valid) {
+            ++_segmentIdx;
+            _blockIdx = 0;
+            continue;
+        }
+
+        ++_blockIdx;
+
+        if (_block.header.magic != BlockMagic || _block.header.version != BlockVersion) { continue; }
+        if (_block.header.lastTimestamp < _start) { continue; }
+        if (_block.header.firstTimestamp > _end) { return false; }
+
+        _upDecoder = std::make_unique<TimeSeriesCodec::Decoder>(_block.payload, PayloadSize,
+                _block.header.channelCount, _block.header.recordCount);
+        return true;
+    }
+
+    if (!_pendingBlockValid) { return false; }
+    _pendingBlockValid = false;
+
+    if (_pendingBlock.header.lastTimestamp < _start || _pendingBlock.header.firstTimestamp > _end) {
+        return false;
+    }
+
+    _block = _pendingBlock;
+    _upDecoder = std::make_unique<TimeSeriesCodec::Decoder>(_block.payload, PayloadSize,
+            _block.header.channelCount, _block.header.recordCount);
+    return true;
+}
+
+bool FlashLog::Cursor::next(uint32_t& timestamp, Values& values)
+{
+    std::array<float, TimeSeriesCodec::MaxChannels> decoded;
+
+    while (!_done) {
+        if (!_upDecoder && !loadNextBlock()) {
+            _done = true;
+            break;
+        }
+
+        if (!_upDecoder->next(timestamp, decoded.data())) {
+            _upDecoder = nullptr;
+            continue;
+        }
+
+        if (timestamp < _start) { continue; }
+        if (timestamp > _end) {
+            _done = true;
+            break;
+        }
+
+        values.fill(NAN);
+        std::copy_n(decoded.begin(), std::min<size_t>(ChannelCount, _block.header.channelCount), values.begin());
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace History
@@ -116,6 +116,46 @@ void I18nClass::readDisplayStrings(
     f.close();
 }
 
+bool I18nClass::getAlarmMessage(const String& locale, const uint16_t messageId, JsonVariant target)
+{
+    std::lock_guard<std::mutex> lock(_alarmMessagesMutex);
+
+    if (locale != _alarmMessagesLocale) {
+        _alarmMessagesLocale = locale;
+        _alarmMessages.clear();
+
+        auto filename = getFilenameByLocale(locale);
+        if (filename == "") {
+            return false;
+        }
+
+        JsonDocument filter;
+        filter["alarm_messages"] = true;
+
+        File f = LittleFS.open(filename, "r", false);
+        const DeserializationError error = deserializeJson(_alarmMessages, f, DeserializationOption::Filter(filter));
+        f.close();
+
+        if (error) {
+            MessageOutput.printf("Failed to read file %s\r\n", filename.c_str());
+            _alarmMessages.clear();
+            return false;
+        }
+    }
+
+    char key[6];
+    snprintf(key, sizeof(key), "%u", messageId);
+
+    const char* value = _alarmMessages["alarm_messages"][key];
+    if (value == nullptr || value[0] == '\0') {
+        return false;
+    }
+
+    // copied, the cache may be replaced as soon as the lock is released
+    target.set(value);
+    return true;
+}
+
 void I18nClass::readLangPacks()
 {
     auto root = LittleFS.open("/");
@@ -18,7 +18,7 @@ InverterSettingsClass::InverterSettingsClass()
 {
 }
 
-void InverterSettingsClass::init(Scheduler& scheduler)
+void InverterSettingsClass::init(Scheduler& scheduler, Scheduler& radioScheduler)
 {
     const CONFIG_T& config = Configuration.get();
     const PinMapping_t& pin = PinMapping.get();
@@ -29,7 +29,13 @@ void InverterSettingsClass::init(Scheduler& scheduler)
     Hoymiles.setMessageOutput(&MessageOutput);
     Hoymiles.init();
 
-    if (PinMapping.isValidNrf24Config() || PinMapping.isValidCmt2300Config()) {
+#ifdef HOYMILES_RADIO_SIM
+    const bool radioAvailable = true;
+#else
+    const bool radioAvailable = PinMapping.isValidNrf24Config() || PinMapping.isValidCmt2300Config();
+#endif
+
+    if (radioAvailable) {
         if (PinMapping.isValidNrf24Config()) {
             auto spi_bus = SpiManagerInst.claim_bus_arduino();
             ESP_ERROR_CHECK(spi_bus ? ESP_OK : ESP_FAIL);
@@ -54,6 +60,9 @@ void InverterSettingsClass::init(Scheduler& scheduler)
         MessageOutput.println("  Setting DTU serial... ");
         Hoymiles.getRadioNrf()->setDtuSerial(config.Dtu.Serial);
         Hoymiles.getRadioCmt()->setDtuSerial(config.Dtu.Serial);
+#ifdef HOYMILES_RADIO_SIM
+        Hoymiles.getRadioSim()->setDtuSerial(config.Dtu.Serial);
+#endif
 
         MessageOutput.println("  Setting poll interval... ");
         Hoymiles.setPollInterval(config.Dtu.PollInterval);
@@ -90,7 +99,7 @@ void InverterSettingsClass::init(Scheduler& scheduler)
         MessageOutput.println("Invalid pin config");
     }
 
-    scheduler.addTask(_hoyTask);
+    radioScheduler.addTask(_hoyTask);
     _hoyTask.enable();
 
     scheduler.addTask(_settingsTask);
@@ -3,9 +3,17 @@
  * Copyright (C) 2022-2024 Thomas Basler and others
  */
 #include <HardwareSerial.h>
+#include <Esp.h>
+#include <esp_heap_caps.h>
+#include <algorithm>
+#include <sys/time.h>
 #include "MessageOutput.h"
 #include "SyslogLogger.h"
 
+// positions wrap around, which requires the capacity to divide 2^32
+static_assert((MessageOutputClass::BacklogSize & (MessageOutputClass::BacklogSize - 1)) == 0);
+static_assert((MessageOutputClass::BacklogSizePsram & (MessageOutputClass::BacklogSizePsram - 1)) == 0);
+
 MessageOutputClass MessageOutput;
 
 MessageOutputClass::MessageOutputClass()
@@ -17,6 +25,18 @@ void MessageOutputClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
     _loopTask.enable();
+
+    std::lock_guard<std::mutex> lock(_msgLock);
+
+    if (ESP.getPsramSize() > 0) {
+        _backlog = static_cast<char*>(heap_caps_malloc(BacklogSizePsram, MALLOC_CAP_SPIRAM));
+        if (_backlog != nullptr) { _backlogCapacity = BacklogSizePsram; }
+    }
+
+    if (_backlog == nullptr) {
+        _backlog = static_cast<char*>(heap_caps_malloc(BacklogSize, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+        if (_backlog != nullptr) { _backlogCapacity = BacklogSize; }
+    }
 }
 
 void MessageOutputClass::register_ws_output(AsyncWebSocket* output)
@@ -53,6 +73,7 @@ size_t MessageOutputClass::write(uint8_t c)
 
     if (c == '\n') {
         serialWrite(message);
+        stampLine(message);
         _lines.emplace(std::move(message));
         _task_messages.erase(iter);
     }
@@ -77,6 +98,7 @@ size_t MessageOutputClass::write(const uint8_t *buffer, size_t size)
 
         if (c == '\n') {
             serialWrite(message);
+            stampLine(message);
             _lines.emplace(std::move(message));
             message.clear();
             message.reserve(size - idx - 1);
@@ -104,21 +126,168 @@ void MessageOutputClass::loop()
     }
 
     while (!_lines.empty()) {
-        Syslog.write(_lines.front().data(), _lines.front().size());
-        if (_ws) {
-            auto msg = std::make_shared<message_t>(std::move(_lines.front()));
-            for (auto& client : _ws->getClients()) {
-                if (client.queueIsFull()) { continue; }
-
-                client.text(msg);
-
-                if (client.queueIsFull()) {
-                    static char const warningStr[] = "WARNING: dropping log line(s) as websocket client's queue is full\r\n";
-                    message_t warningVec(warningStr, warningStr + sizeof(warningStr) - 1);
-                    msg->swap(warningVec);
-                }
-            }
+        // the timestamp is only meant for the websocket clients
+        auto& line = _lines.front();
+        Syslog.write(line.data() + TimestampLength, line.size() - TimestampLength);
+
+        if (_backlogCapacity > 0) {
+            appendBacklog(line);
+        } else if (_ws) {
+            forwardLine(std::move(line));
         }
+
         _lines.pop();
     }
+
+    if (_ws && _backlogCapacity > 0) { serveWebsocketClients(); }
+}
+
+void MessageOutputClass::stampLine(MessageOutputClass::message_t& m)
+{
+    // the websocket clients are sent lines from the backlog long after they
+    // were logged, hence they are stamped with the time they were logged at.
+    // the uptime is used until the local time is known.
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    struct tm t;
+    localtime_r(&tv.tv_sec, &t);
+    uint32_t ms = tv.tv_usec / 1000;
+
+    if (t.tm_year < (2016 - 1900)) {
+        uint32_t uptime = millis();
+        ms = uptime % 1000;
+        t.tm_sec = (uptime / 1000) % 60;
+        t.tm_min = (uptime / (60 * 1000)) % 60;
+        t.tm_hour = (uptime / (60 * 60 * 1000)) % 100;
+    }
+
+    char stamp[TimestampLength + 1];
+    snprintf(stamp, sizeof(stamp), "%02d:%02d:%02d.%03u > ",
+            t.tm_hour, t.tm_min, t.tm_sec, static_cast<unsigned>(ms));
+
+    m.insert(m.begin(), stamp, stamp + TimestampLength);
+}
+
+void MessageOutputClass::forwardLine(MessageOutputClass::message_t&& m)
+{
+    // without a backlog, lines are sent to the clients as they come in
+    auto msg = std::make_shared<message_t>(std::move(m));
+    for (auto& client : _ws->getClients()) {
+        if (client.queueIsFull()) { continue; }
+
+        client.text(msg);
+
+        if (client.queueIsFull()) {
+            static char const warningStr[] = "WARNING: dropping log line(s) as websocket client's queue is full\r\n";
+            client.text(warningStr);
+        }
+    }
+}
+
+void MessageOutputClass::appendBacklog(MessageOutputClass::message_t const& m)
+{
+    if (_backlogCapacity == 0) { return; }
+
+    // only the end of a line longer than the whole backlog is kept
+    size_t skip = (m.size() > _backlogCapacity) ? m.size() - _backlogCapacity : 0;
+    uint8_t const* data = m.data() + skip;
+    size_t len = m.size() - skip;
+
+    size_t offset = _backlogEnd % _backlogCapacity;
+    size_t first = std::min(len, _backlogCapacity - offset);
+    memcpy(_backlog + offset, data, first);
+    memcpy(_backlog, data + first, len - first);
+
+    _backlogEnd += len;
+    _backlogFill = std::min(_backlogFill + len, _backlogCapacity);
+}
+
+uint32_t MessageOutputClass::getOldestBacklogLine() const
+{
+    uint32_t oldest = _backlogEnd - _backlogFill;
+    if (_backlogFill < _backlogCapacity) { return oldest; }
+
+    // the oldest line was partially overwritten, skip its remainder
+    for (uint32_t pos = oldest; pos != _backlogEnd; ++pos) {
+        if (_backlog[pos % _backlogCapacity] == '\n') { return pos + 1; }
+    }
+
+    return oldest;
+}
+
+std::shared_ptr<MessageOutputClass::message_t> MessageOutputClass::createFrame(uint32_t start, uint32_t& end) const
+{
+    size_t len = std::min<size_t>(_backlogEnd - start, MaxFrameSize);
+
+    // frames end with a complete line, unless a single line exceeds the
+    // frame size. the backlog only ever contains complete lines.
+    if (start + len != _backlogEnd) {
+        for (size_t i = len; i > 0; --i) {
+            if (_backlog[(start + i - 1) % _backlogCapacity] == '\n') {
+                len = i;
+                break;
+            }
+        }
+    }
+
+    auto spFrame = std::make_shared<message_t>(len);
+    for (size_t i = 0; i < len; ++i) {
+        (*spFrame)[i] = _backlog[(start + i) % _backlogCapacity];
+    }
+
+    end = start + len;
+    return spFrame;
+}
+
+void MessageOutputClass::serveWebsocketClients()
+{
+    // clients that are in sync are sent the very same frames
+    struct Frame {
+        uint32_t start;
+        uint32_t end;
+        std::shared_ptr<message_t> spData;
+    };
+    std::vector<Frame> frames;
+
+    std::unordered_map<uint32_t, uint32_t> positions;
+
+    for (auto& client : _ws->getClients()) {
+        if (client.status() != WS_CONNECTED) { continue; }
+
+        auto iter = _wsPositions.find(client.id());
+        bool newClient = (iter == _wsPositions.end());
+        uint32_t position = newClient ? getOldestBacklogLine() : iter->second;
+
+        // the lines due for this client were overwritten while its queue
+        // was full. it continues with the oldest line still available.
+        if (!newClient && _backlogEnd - position > _backlogFill && !client.queueIsFull()) {
+            char warning[96];
+            snprintf(warning, sizeof(warning),
+                    "WARNING: dropped %u bytes of log output as websocket client's queue was full\r\n",
+                    static_cast<unsigned>(_backlogEnd - _backlogFill - position));
+            client.text(warning);
+            position = getOldestBacklogLine();
+        }
+
+        while (position != _backlogEnd && !client.queueIsFull()) {
+            auto frameIter = std::find_if(frames.begin(), frames.end(),
+                    [position](Frame const& f) { return f.start == position; });
+
+            if (frameIter == frames.end()) {
+                Frame frame;
+                frame.start = position;
+                frame.spData = createFrame(position, frame.end);
+                frames.push_back(frame);
+                frameIter = frames.end() - 1;
+            }
+
+            client.text(frameIter->spData);
+            position = frameIter->end;
+        }
+
+        positions[client.id()] = position;
+    }
+
+    // forgets about disconnected clients
+    _wsPositions = std::move(positions);
 }
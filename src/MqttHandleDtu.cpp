@@ -6,6 +6,7 @@
 #include "Configuration.h"
 #include "MqttSettings.h"
 #include "NetworkSettings.h"
+#include "TaskProfiler.h"
 #include <Hoymiles.h>
 #include <CpuTemperature.h>
 
@@ -48,4 +49,17 @@ void MqttHandleDtuClass::loop()
     if (!std::isnan(temperature)) {
         MqttSettings.publish("dtu/temperature", String(temperature));
     }
+
+#ifdef TASK_PROFILER
+    auto reports = TaskProfiler.getReports();
+    reports.insert(reports.begin(), TaskProfiler.getLoopReport());
+    for (auto const& report : reports) {
+        String topic = "dtu/tasks/" + report.name + "/";
+        MqttSettings.publish(topic + "calls", String(report.calls));
+        MqttSettings.publish(topic + "runtime_us", String(report.totalUs));
+        MqttSettings.publish(topic + "max_us", String(report.maxUs));
+        MqttSettings.publish(topic + "p99_us", String(report.p99Us));
+        MqttSettings.publish(topic + "overruns", String(report.overruns));
+    }
+#endif
 }
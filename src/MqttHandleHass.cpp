@@ -3,6 +3,7 @@
  * Copyright (C) 2022-2024 Thomas Basler and others
  */
 #include "MqttHandleHass.h"
+#include "MqttHassRegistry.h"
 #include "MqttHandleInverter.h"
 #include "MqttSettings.h"
 #include "NetworkSettings.h"
@@ -12,6 +13,10 @@
 
 MqttHandleHassClass MqttHandleHass;
 
+uint16_t MqttHandleHassClass::_stepDocument = 0;
+uint16_t MqttHandleHassClass::_resumeDocument = 0;
+bool MqttHandleHassClass::_stepDeferred = false;
+
 MqttHandleHassClass::MqttHandleHassClass()
     : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&MqttHandleHassClass::loop, this))
 {
@@ -37,6 +42,37 @@ void MqttHandleHassClass::loop()
     } else if (!MqttSettings.getConnected() && _wasConnected) {
         // Connection lost
         _wasConnected = false;
+        _publishing = false;
+    }
+
+    if (!_publishing && MqttHassRegistry.takeInvalidated(MqttHassRegistryClass::Owner::Dtu)) {
+        publishConfig();
+    }
+
+    // the DTU and the inverters are handled one at a time, each once the
+    // registry is ready to send a burst of documents, to spread the load
+    // over many loops. if documents were deferred, the step is repeated.
+    if (!_publishing || !MqttHassRegistry.isReady()) {
+        return;
+    }
+
+    _stepDocument = 0;
+    _stepDeferred = false;
+
+    if (_nextStep == 0) {
+        publishDtuConfig();
+    } else {
+        publishInverterConfig(Hoymiles.getInverterByPos(_nextStep - 1));
+    }
+
+    if (MqttHassRegistry.takeDeferred(MqttHassRegistryClass::Owner::Dtu)) {
+        return;
+    }
+
+    _resumeDocument = 0;
+
+    if (++_nextStep > Hoymiles.getNumInverters()) {
+        _publishing = false;
     }
 }
 
@@ -55,6 +91,14 @@ void MqttHandleHassClass::publishConfig()
         return;
     }
 
+    MqttHassRegistry.takeDeferred(MqttHassRegistryClass::Owner::Dtu);
+    _nextStep = 0;
+    _resumeDocument = 0;
+    _publishing = true;
+}
+
+void MqttHandleHassClass::publishDtuConfig()
+{
     const CONFIG_T& config = Configuration.get();
 
     // publish DTU sensors
@@ -73,43 +117,47 @@ void MqttHandleHassClass::publishConfig()
     publishDtuSensor("DC Power", "dc/power", "W", "", DEVICE_CLS_PWR, STATE_CLS_MEASUREMENT, CATEGORY_NONE);  
 
     publishDtuBinarySensor("Status", config.Mqtt.Lwt.Topic, config.Mqtt.Lwt.Value_Online, config.Mqtt.Lwt.Value_Offline, DEVICE_CLS_CONNECTIVITY, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
+}
+
+void MqttHandleHassClass::publishInverterConfig(std::shared_ptr<InverterAbstract> inv)
+{
+    if (inv == nullptr) {
+        return;
+    }
+
+    const CONFIG_T& config = Configuration.get();
 
-    // Loop all inverters
-    for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
-        auto inv = Hoymiles.getInverterByPos(i);
-
-        publishInverterButton(inv, "Turn Inverter Off", "cmd/power", "0", "mdi:power-plug-off", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_CONFIG);
-        publishInverterButton(inv, "Turn Inverter On", "cmd/power", "1", "mdi:power-plug", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_CONFIG);
-        publishInverterButton(inv, "Restart Inverter", "cmd/restart", "1", "", DEVICE_CLS_RESTART, STATE_CLS_NONE, CATEGORY_CONFIG);
-        publishInverterButton(inv, "Reset Radio Statistics", "cmd/reset_rf_stats", "1", "", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_CONFIG);
-
-        publishInverterNumber(inv, "Limit NonPersistent Relative", "status/limit_relative", "cmd/limit_nonpersistent_relative", 0, 100, 0.1, "%", "mdi:speedometer", STATE_CLS_NONE, CATEGORY_CONFIG);
-        publishInverterNumber(inv, "Limit Persistent Relative", "status/limit_relative", "cmd/limit_persistent_relative", 0, 100, 0.1, "%", "mdi:speedometer", STATE_CLS_NONE, CATEGORY_CONFIG);
-
-        publishInverterNumber(inv, "Limit NonPersistent Absolute", "status/limit_absolute", "cmd/limit_nonpersistent_absolute", 0, MAX_INVERTER_LIMIT, 1, "W", "mdi:speedometer", STATE_CLS_NONE, CATEGORY_CONFIG);
-        publishInverterNumber(inv, "Limit Persistent Absolute", "status/limit_absolute", "cmd/limit_persistent_absolute", 0, MAX_INVERTER_LIMIT, 1, "W", "mdi:speedometer", STATE_CLS_NONE, CATEGORY_CONFIG);
-
-        publishInverterBinarySensor(inv, "Reachable", "status/reachable", "1", "0", DEVICE_CLS_CONNECTIVITY, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
-        publishInverterBinarySensor(inv, "Producing", "status/producing", "1", "0", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_NONE);
-
-        publishInverterSensor(inv, "TX Requests", "radio/tx_request", "", "", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
-        publishInverterSensor(inv, "RX Success", "radio/rx_success", "", "", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
-        publishInverterSensor(inv, "RX Fail Receive Nothing", "radio/rx_fail_nothing", "", "", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
-        publishInverterSensor(inv, "RX Fail Receive Partial", "radio/rx_fail_partial", "", "", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
-        publishInverterSensor(inv, "RX Fail Receive Corrupt", "radio/rx_fail_corrupt", "", "", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
-        publishInverterSensor(inv, "TX Re-Request Fragment", "radio/tx_re_request", "", "", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
-        publishInverterSensor(inv, "RSSI", "radio/rssi", "dBm", "", DEVICE_CLS_SIGNAL_STRENGTH, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
-
-        // Loop all channels
-        for (auto& t : inv->Statistics()->getChannelTypes()) {
-            for (auto& c : inv->Statistics()->getChannelsByType(t)) {
-                for (uint8_t f = 0; f < DEVICE_CLS_ASSIGN_LIST_LEN; f++) {
-                    bool clear = false;
-                    if (t == TYPE_DC && !config.Mqtt.Hass.IndividualPanels) {
-                        clear = true;
-                    }
-                    publishInverterField(inv, t, c, deviceFieldAssignment[f], clear);
+    publishInverterButton(inv, "Turn Inverter Off", "cmd/power", "0", "mdi:power-plug-off", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_CONFIG);
+    publishInverterButton(inv, "Turn Inverter On", "cmd/power", "1", "mdi:power-plug", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_CONFIG);
+    publishInverterButton(inv, "Restart Inverter", "cmd/restart", "1", "", DEVICE_CLS_RESTART, STATE_CLS_NONE, CATEGORY_CONFIG);
+    publishInverterButton(inv, "Reset Radio Statistics", "cmd/reset_rf_stats", "1", "", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_CONFIG);
+
+    publishInverterNumber(inv, "Limit NonPersistent Relative", "status/limit_relative", "cmd/limit_nonpersistent_relative", 0, 100, 0.1, "%", "mdi:speedometer", STATE_CLS_NONE, CATEGORY_CONFIG);
+    publishInverterNumber(inv, "Limit Persistent Relative", "status/limit_relative", "cmd/limit_persistent_relative", 0, 100, 0.1, "%", "mdi:speedometer", STATE_CLS_NONE, CATEGORY_CONFIG);
+
+    publishInverterNumber(inv, "Limit NonPersistent Absolute", "status/limit_absolute", "cmd/limit_nonpersistent_absolute", 0, MAX_INVERTER_LIMIT, 1, "W", "mdi:speedometer", STATE_CLS_NONE, CATEGORY_CONFIG);
+    publishInverterNumber(inv, "Limit Persistent Absolute", "status/limit_absolute", "cmd/limit_persistent_absolute", 0, MAX_INVERTER_LIMIT, 1, "W", "mdi:speedometer", STATE_CLS_NONE, CATEGORY_CONFIG);
+
+    publishInverterBinarySensor(inv, "Reachable", "status/reachable", "1", "0", DEVICE_CLS_CONNECTIVITY, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
+    publishInverterBinarySensor(inv, "Producing", "status/producing", "1", "0", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_NONE);
+
+    publishInverterSensor(inv, "TX Requests", "radio/tx_request", "", "", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
+    publishInverterSensor(inv, "RX Success", "radio/rx_success", "", "", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
+    publishInverterSensor(inv, "RX Fail Receive Nothing", "radio/rx_fail_nothing", "", "", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
+    publishInverterSensor(inv, "RX Fail Receive Partial", "radio/rx_fail_partial", "", "", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
+    publishInverterSensor(inv, "RX Fail Receive Corrupt", "radio/rx_fail_corrupt", "", "", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
+    publishInverterSensor(inv, "TX Re-Request Fragment", "radio/tx_re_request", "", "", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
+    publishInverterSensor(inv, "RSSI", "radio/rssi", "dBm", "", DEVICE_CLS_SIGNAL_STRENGTH, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
+
+    // Loop all channels
+    for (auto& t : inv->Statistics()->getChannelTypes()) {
+        for (auto& c : inv->Statistics()->getChannelsByType(t)) {
+            for (uint8_t f = 0; f < DEVICE_CLS_ASSIGN_LIST_LEN; f++) {
+                bool clear = false;
+                if (t == TYPE_DC && !config.Mqtt.Hass.IndividualPanels) {
+                    clear = true;
                 }
+                publishInverterField(inv, t, c, deviceFieldAssignment[f], clear);
             }
         }
     }
@@ -117,6 +165,10 @@ void MqttHandleHassClass::publishConfig()
 
 void MqttHandleHassClass::publishInverterField(std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const byteAssign_fieldDeviceClass_t fieldType, const bool clear)
 {
+    if (skipDocument()) {
+        return;
+    }
+
     if (!inv->Statistics()->hasChannelFieldValue(type, channel, fieldType.fieldId)) {
         return;
     }
@@ -177,6 +229,10 @@ void MqttHandleHassClass::publishInverterButton(
     const String& icon,
     const DeviceClassType device_class, const StateClassType state_class, const CategoryType category)
 {
+    if (skipDocument()) {
+        return;
+    }
+
     const String serial = inv->serialString();
 
     String buttonId = name;
@@ -208,6 +264,10 @@ void MqttHandleHassClass::publishInverterNumber(
     const String& unit_of_measure, const String& icon,
     const StateClassType state_class, const CategoryType category)
 {
+    if (skipDocument()) {
+        return;
+    }
+
     const String serial = inv->serialString();
 
     String buttonId = name;
@@ -291,12 +351,21 @@ String MqttHandleHassClass::getDtuUrl()
     return String("http://") + NetworkSettings.localIP().toString();
 }
 
+bool MqttHandleHassClass::skipDocument()
+{
+    // the documents of a step are counted in the order they are built.
+    // documents before the resume position were sent in a previous pass
+    // of the same step and are not built again, neither are documents
+    // after the first one which was deferred in this pass.
+    return _stepDocument++ < _resumeDocument || _stepDeferred;
+}
+
 void MqttHandleHassClass::publish(const String& subtopic, const String& payload)
 {
-    String topic = Configuration.get().Mqtt.Hass.Topic;
-    topic += subtopic;
-    MqttSettings.publishGeneric(topic, payload, Configuration.get().Mqtt.Hass.Retain);
-    yield();
+    if (!MqttHassRegistry.publish(MqttHassRegistryClass::Owner::Dtu, subtopic, payload)) {
+        _stepDeferred = true;
+        _resumeDocument = _stepDocument - 1;
+    }
 }
 
 void MqttHandleHassClass::publish(const String& subtopic, const JsonDocument& doc)
@@ -356,6 +425,10 @@ void MqttHandleHassClass::publishDtuBinarySensor(
     const String& name, const String& state_topic, const String& payload_on, const String& payload_off,
     const DeviceClassType device_class, const StateClassType state_class, const CategoryType category)
 {
+    if (skipDocument()) {
+        return;
+    }
+
     const String dtuId = getDtuUniqueId();
 
     JsonDocument root;
@@ -367,6 +440,10 @@ void MqttHandleHassClass::publishInverterBinarySensor(
     std::shared_ptr<InverterAbstract> inv, const String& name, const String& state_topic, const String& payload_on, const String& payload_off,
     const DeviceClassType device_class, const StateClassType state_class, const CategoryType category)
 {
+    if (skipDocument()) {
+        return;
+    }
+
     const String serial = inv->serialString();
 
     JsonDocument root;
@@ -404,6 +481,10 @@ void MqttHandleHassClass::publishDtuSensor(
     const String& unit_of_measure, const String& icon,
     const DeviceClassType device_class, const StateClassType state_class, const CategoryType category)
 {
+    if (skipDocument()) {
+        return;
+    }
+
     const String dtuId = getDtuUniqueId();
 
     JsonDocument root;
@@ -416,6 +497,10 @@ void MqttHandleHassClass::publishInverterSensor(
     const String& unit_of_measure, const String& icon,
     const DeviceClassType device_class, const StateClassType state_class, const CategoryType category)
 {
+    if (skipDocument()) {
+        return;
+    }
+
     const String serial = inv->serialString();
 
     JsonDocument root;
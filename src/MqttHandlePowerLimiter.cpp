@@ -6,6 +6,7 @@
 #include "MqttSettings.h"
 #include "MqttHandlePowerLimiter.h"
 #include "PowerLimiter.h"
+#include "RealtimeScheduler.h"
 #include <ctime>
 #include <string>
 
@@ -72,7 +73,7 @@ void MqttHandlePowerLimiterClass::loop()
         return;
     }
 
-    for (auto& callback : _mqttCallbacks) { callback(); }
+    for (auto& callback : _mqttCallbacks) { RealtimeScheduler.post(callback); }
     _mqttCallbacks.clear();
 
     mqttLock.unlock();
@@ -94,6 +95,19 @@ void MqttHandlePowerLimiterClass::loop()
 
     MqttSettings.publish("powerlimiter/status/inverter_update_timeouts", String(PowerLimiter.getInverterUpdateTimeouts()));
 
+    MqttSettings.publish("powerlimiter/status/limit_commands", String(PowerLimiter.getLimitCommands()));
+
+    MqttSettings.publish("powerlimiter/status/failsafe", String(PowerLimiter.isFailsafeActive() ? 1 : 0));
+    MqttSettings.publish("powerlimiter/status/failsafe_time", String(PowerLimiter.getFailsafeMillis() / 1000));
+    MqttSettings.publish("powerlimiter/status/failsafe_entries", String(PowerLimiter.getFailsafeEntries()));
+
+    MqttSettings.publish("powerlimiter/status/load_prediction_error", String(PowerLimiter.getLoadPredictionError()));
+
+    auto oPredictedLoad = PowerLimiter.getPredictedLoad();
+    if (oPredictedLoad) {
+        MqttSettings.publish("powerlimiter/status/predicted_load", String(*oPredictedLoad));
+    }
+
     // no thresholds are relevant for setups without a battery
     if (!PowerLimiter.usesBatteryPoweredInverter()) { return; }
 
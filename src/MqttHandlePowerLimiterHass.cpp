@@ -4,6 +4,7 @@
  */
 #include "MqttHandlePowerLimiterHass.h"
 #include "MqttHandleHass.h"
+#include "MqttHassRegistry.h"
 #include "Configuration.h"
 #include "MqttSettings.h"
 #include "NetworkSettings.h"
@@ -24,9 +25,6 @@ void MqttHandlePowerLimiterHassClass::init(Scheduler& scheduler)
 
 void MqttHandlePowerLimiterHassClass::loop()
 {
-    if (!Configuration.get().PowerLimiter.Enabled) {
-        return;
-    }
     if (_updateForced) {
         publishConfig();
         _updateForced = false;
@@ -40,6 +38,13 @@ void MqttHandlePowerLimiterHassClass::loop()
         // Connection lost
         _wasConnected = false;
     }
+
+    using Owner = MqttHassRegistryClass::Owner;
+    if (MqttHassRegistry.isReady() &&
+            (MqttHassRegistry.takeDeferred(Owner::PowerLimiter) ||
+             MqttHassRegistry.takeInvalidated(Owner::PowerLimiter))) {
+        publishConfig();
+    }
 }
 
 void MqttHandlePowerLimiterHassClass::forceUpdate()
@@ -59,6 +64,17 @@ void MqttHandlePowerLimiterHassClass::publishConfig()
         return;
     }
 
+    // entities which are not published (anymore) due to the current
+    // configuration are removed from Home Assistant.
+    MqttHassRegistry.beginRound(MqttHassRegistryClass::Owner::PowerLimiter);
+    publishEntities();
+    MqttHassRegistry.endRound(MqttHassRegistryClass::Owner::PowerLimiter);
+}
+
+void MqttHandlePowerLimiterHassClass::publishEntities()
+{
+    auto const& config = Configuration.get();
+
     if (!config.PowerLimiter.Enabled) {
         return;
     }
@@ -247,7 +263,5 @@ void MqttHandlePowerLimiterHassClass::createDeviceInfo(JsonDocument& root)
 
 void MqttHandlePowerLimiterHassClass::publish(const String& subtopic, const String& payload)
 {
-    String topic = Configuration.get().Mqtt.Hass.Topic;
-    topic += subtopic;
-    MqttSettings.publishGeneric(topic.c_str(), payload.c_str(), Configuration.get().Mqtt.Hass.Retain);
+    MqttHassRegistry.publish(MqttHassRegistryClass::Owner::PowerLimiter, subtopic, payload);
 }
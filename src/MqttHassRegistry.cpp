@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "MqttHassRegistry.h"
+#include "Configuration.h"
+#include "MqttSettings.h"
+#include <algorithm>
+
+MqttHassRegistryClass MqttHassRegistry;
+
+void MqttHassRegistryClass::init()
+{
+    MqttSettings.onConnect(std::bind(&MqttHassRegistryClass::onMqttConnect, this));
+}
+
+void MqttHassRegistryClass::onMqttConnect()
+{
+    // called in the context of the MQTT client's task. the actual work is
+    // done by handleConnect() in the context of the main loop.
+    ++_connectCounter;
+}
+
+uint32_t MqttHassRegistryClass::hash(const String& value)
+{
+    // FNV-1a
+    uint32_t res = 2166136261U;
+    for (size_t i = 0; i < value.length(); ++i) {
+        res ^= static_cast<uint8_t>(value[i]);
+        res *= 16777619U;
+    }
+    return res;
+}
+
+uint32_t MqttHassRegistryClass::hash(const String& payload, bool retain)
+{
+    uint32_t res = hash(payload) ^ (retain ? 1 : 0);
+    return (res == InvalidHash) ? 1 : res;
+}
+
+void MqttHassRegistryClass::handleConnect()
+{
+    uint32_t connects = _connectCounter.load();
+    if (connects == _handledConnects) { return; }
+    _handledConnects = connects;
+
+    for (auto& [topicHash, entity] : _entities) { entity.hash = InvalidHash; }
+
+    _invalidated = bit(Owner::Dtu) | bit(Owner::PowerLimiter) |
+        bit(Owner::Battery) | bit(Owner::SolarCharger);
+}
+
+bool MqttHassRegistryClass::publish(Owner owner, const String& subtopic, const String& payload)
+{
+    handleConnect();
+
+    auto const& config = Configuration.get();
+
+    String topic = config.Mqtt.Hass.Topic;
+    topic += subtopic;
+
+    uint32_t topicHash = hash(topic);
+    uint32_t payloadHash = hash(payload, config.Mqtt.Hass.Retain);
+
+    auto [it, inserted] = _entities.try_emplace(topicHash, Entity { InvalidHash, owner, true });
+    auto& entity = it->second;
+    entity.owner = owner;
+    entity.seen = true;
+
+    if ((_roundsActive & bit(owner)) != 0) {
+        _roundTopics.try_emplace(topicHash, topic);
+    }
+
+    if (entity.hash == payloadHash) { return true; }
+
+    refillTokens();
+    if (_tokens < 1) {
+        _deferred |= bit(owner);
+        return false;
+    }
+
+    MqttSettings.publishGeneric(topic, payload, config.Mqtt.Hass.Retain);
+    entity.hash = payloadHash;
+    _tokens -= 1;
+    return true;
+}
+
+void MqttHassRegistryClass::beginRound(Owner owner)
+{
+    handleConnect();
+
+    _roundsActive |= bit(owner);
+
+    for (auto& [topicHash, entity] : _entities) {
+        if (entity.owner == owner) { entity.seen = false; }
+    }
+}
+
+void MqttHassRegistryClass::endRound(Owner owner)
+{
+    _roundsActive &= ~bit(owner);
+
+    bool retain = Configuration.get().Mqtt.Hass.Retain;
+
+    for (auto it = _entities.begin(); it != _entities.end(); ) {
+        if (it->second.owner != owner || it->second.seen) {
+            ++it;
+            continue;
+        }
+
+        auto topicIt = _roundTopics.find(it->first);
+        if (topicIt != _roundTopics.end()) {
+            refillTokens();
+            if (_tokens < 1) {
+                // removed in the owner's next round
+                _deferred |= bit(owner);
+                ++it;
+                continue;
+            }
+
+            MqttSettings.publishGeneric(topicIt->second, "", retain);
+            _tokens -= 1;
+            _roundTopics.erase(topicIt);
+        }
+
+        it = _entities.erase(it);
+    }
+}
+
+bool MqttHassRegistryClass::isReady()
+{
+    handleConnect();
+    refillTokens();
+    return _tokens >= BucketCapacity;
+}
+
+bool MqttHassRegistryClass::takeDeferred(Owner owner)
+{
+    bool res = (_deferred & bit(owner)) != 0;
+    _deferred &= ~bit(owner);
+    return res;
+}
+
+bool MqttHassRegistryClass::takeInvalidated(Owner owner)
+{
+    handleConnect();
+    bool res = (_invalidated & bit(owner)) != 0;
+    _invalidated &= ~bit(owner);
+    return res;
+}
+
+void MqttHassRegistryClass::refillTokens()
+{
+    uint32_t now = millis();
+    _tokens += (now - _lastRefillMillis) * TokensPerSecond / 1000;
+    _tokens = std::min(_tokens, BucketCapacity);
+    _lastRefillMillis = now;
+}
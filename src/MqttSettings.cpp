@@ -32,21 +32,34 @@ void MqttSettingsClass::onMqttConnect(const bool sessionPresent)
     const CONFIG_T& config = Configuration.get();
     publish(config.Mqtt.Lwt.Topic, config.Mqtt.Lwt.Value_Online);
 
+    for (auto const& cb : _connectCallbacks) { cb(); }
+
     std::lock_guard<std::mutex> lock(_clientLock);
     if (_mqttClient != nullptr) {
-        for (const auto& cb : _mqttSubscribeParser.get_callbacks()) {
-            _mqttClient->subscribe(cb.topic.c_str(), cb.qos);
-        }
+        _mqttSubscribeParser.for_each_subscription([this](const std::string& topic, uint8_t qos) {
+            _mqttClient->subscribe(topic.c_str(), qos);
+        });
     }
 }
 
-void MqttSettingsClass::subscribe(const String& topic, const uint8_t qos, const espMqttClientTypes::OnMessageCallback& cb)
+void MqttSettingsClass::onConnect(ConnectCb cb)
+{
+    _connectCallbacks.push_back(cb);
+}
+
+MqttSubscribeParser::handle_t MqttSettingsClass::subscribe(const String& topic, const uint8_t qos, const espMqttClientTypes::OnMessageCallback& cb)
 {
-    _mqttSubscribeParser.register_callback(topic.c_str(), qos, cb);
+    auto handle = _mqttSubscribeParser.register_callback(topic.c_str(), qos, cb);
+    if (handle == MqttSubscribeParser::invalid_handle) {
+        MessageOutput.printf("Invalid MQTT topic filter: %s\r\n", topic.c_str());
+        return handle;
+    }
+
     std::lock_guard<std::mutex> lock(_clientLock);
     if (_mqttClient != nullptr) {
         _mqttClient->subscribe(topic.c_str(), qos);
     }
+    return handle;
 }
 
 void MqttSettingsClass::unsubscribe(const String& topic)
@@ -58,6 +71,24 @@ void MqttSettingsClass::unsubscribe(const String& topic)
     }
 }
 
+void MqttSettingsClass::unsubscribe(MqttSubscribeParser::handle_t handle)
+{
+    std::string topic;
+    if (!_mqttSubscribeParser.unregister_callback(handle, topic)) {
+        return;
+    }
+
+    // other callbacks might still be registered for the same topic filter
+    if (_mqttSubscribeParser.has_callback(topic)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_clientLock);
+    if (_mqttClient != nullptr) {
+        _mqttClient->unsubscribe(topic.c_str());
+    }
+}
+
 void MqttSettingsClass::onMqttDisconnect(espMqttClientTypes::DisconnectReason reason)
 {
     MessageOutput.println("Disconnected from MQTT.");
@@ -7,6 +7,9 @@
 #include <battery/Stats.h>
 #include <powermeter/Controller.h>
 #include "PowerLimiter.h"
+#include "BootProfiler.h"
+#include "PowerLimiterAllocator.h"
+#include <Hoymiles.h>
 #include "Configuration.h"
 #include "MqttSettings.h"
 #include "NetworkSettings.h"
@@ -15,6 +18,7 @@
 #include "MessageOutput.h"
 #include <ctime>
 #include <cmath>
+#include <algorithm>
 #include <limits>
 #include <frozen/map.h>
 #include "SunPosition.h"
@@ -95,6 +99,8 @@ void PowerLimiterClass::reloadConfig()
 
     _verboseLogging = config.PowerLimiter.VerboseLogging;
 
+    std::unique_lock<std::mutex> lock(_invertersMutex);
+
     if (!config.PowerLimiter.Enabled || Mode::Disabled == _mode) {
         _retirees.insert(
             _retirees.end(),
@@ -137,6 +143,8 @@ void PowerLimiterClass::reloadConfig()
         if (upInv) { _inverters.push_back(std::move(upInv)); }
     }
 
+    lock.unlock();
+
     calcNextInverterRestart();
 
     _reloadConfigFlag = false;
@@ -146,9 +154,11 @@ void PowerLimiterClass::loop()
 {
     auto const& config = Configuration.get();
 
-    // we know that the Hoymiles library refuses to send any message to any
+    updateFailsafe();
+
+    // we know that the Hoymiles library refuses to request any data from any
     // inverter until the system has valid time information. until then we can
-    // do nothing, not even shutdown the inverter.
+    // do nothing but apply the fail-safe limit (see above).
     struct tm timeinfo;
     if (!getLocalTime(&timeinfo, 5)) {
         return announceStatus(Status::WaitingForValidTimestamp);
@@ -185,6 +195,14 @@ void PowerLimiterClass::loop()
             return announceStatus(Status::InverterStatsPending);
         }
 
+        // the predictive mode accounts for the inverters' response delay: it
+        // waits for stats showing that the output reached the new limit, as
+        // a calculation based on an output that is still ramping down would
+        // underestimate the load and overshoot.
+        if (config.PowerLimiter.PredictiveEnabled && upInv->isRampingDown()) {
+            return announceStatus(Status::InverterStatsPending);
+        }
+
         latestInverterStats = std::max(*oStatsMillis, latestInverterStats);
     }
 
@@ -198,11 +216,9 @@ void PowerLimiterClass::loop()
     // if the power meter is being used, i.e., if its data is valid, we want to
     // wait for a new reading after adjusting the inverter limit. otherwise, we
     // proceed as we will use a fallback limit independent of the power meter.
-    // the power meter reading is expected to be at most 2 seconds old when it
-    // arrives. this can be the case for readings provided by networked meter
-    // readers, where a packet needs to travel through the network for some
-    // time after the actual measurement was done by the reader.
-    if (PowerMeter.isDataValid() && PowerMeter.getLastUpdate() <= (latestInverterStats + 2000)) {
+    // a reading arriving shortly after the inverter stats might still reflect
+    // the situation before, see getMeterSettleMillis().
+    if (PowerMeter.isDataValid() && PowerMeter.getLastUpdate() <= (latestInverterStats + getMeterSettleMillis())) {
         return announceStatus(Status::PowerMeterPending);
     }
 
@@ -321,6 +337,13 @@ void PowerLimiterClass::loop()
             config.PowerLimiter.ConductionLosses);
     };
 
+    BootProfiler.reach(BootProfilerClass::Milestone::FirstDplCalculation);
+
+    // the regular calculation falls back to the base load itself while the
+    // power meter data is not valid, respecting the battery's limits, which
+    // the fail-safe limit does not. hence it takes over from here.
+    leaveFailsafe();
+
     uint16_t inverterTotalPower = calcTargetOutput();
 
     auto totalAllowance = config.PowerLimiter.TotalUpperPowerLimit;
@@ -352,6 +375,114 @@ void PowerLimiterClass::loop()
     _calculationBackoffMs = _calculationBackoffMsDefault;
 }
 
+void PowerLimiterClass::updateFailsafe()
+{
+    auto const& config = Configuration.get();
+
+    bool meterValid = PowerMeter.isDataValid();
+    bool meterWentStale = _meterWasValid && !meterValid;
+    _meterWasValid = meterValid;
+
+    // without a power meter, the DPL always works with the base load, so
+    // there is nothing the fail-safe limit would protect against.
+    if (!config.PowerLimiter.Enabled || !config.PowerLimiter.FailsafeEnabled ||
+            !config.PowerMeter.Enabled || Mode::Normal != _mode) {
+        _failsafeAtBoot = false;
+        return leaveFailsafe();
+    }
+
+    if (meterValid) {
+        _failsafeAtBoot = false;
+        return leaveFailsafe();
+    }
+
+    if (!_oFailsafeSince && (_failsafeAtBoot || meterWentStale)) {
+        enterFailsafe(_failsafeAtBoot ? "booting" : "power meter data is stale");
+    }
+    _failsafeAtBoot = false;
+
+    // the limit command does not need valid time information, unlike the
+    // requests for inverter data. a command is not accepted while another
+    // limit command is pending, so we try again on the next iteration.
+    auto iter = _failsafePending.begin();
+    while (iter != _failsafePending.end()) {
+        auto spInverter = Hoymiles.getInverterBySerial(iter->first);
+        if (spInverter && !spInverter->sendActivePowerControlRequest(iter->second,
+                    PowerLimitControlType::AbsolutNonPersistent)) {
+            ++iter;
+            continue;
+        }
+
+        if (spInverter) {
+            MessageOutput.printf("[DPL] fail-safe limit of %u W sent to inverter %s\r\n",
+                    iter->second, spInverter->serialString().c_str());
+        }
+
+        iter = _failsafePending.erase(iter);
+    }
+}
+
+void PowerLimiterClass::enterFailsafe(char const* reason)
+{
+    auto const& config = Configuration.get();
+
+    // the base load is what the DPL itself falls back to without power
+    // meter data. it is shared among the battery-powered inverters in
+    // proportion to their upper limits. solar-powered and smart-buffer
+    // inverters run at full output without power meter data anyways.
+    auto isEligible = [](PowerLimiterInverterConfig const& invConfig) -> bool {
+        return invConfig.IsGoverned &&
+            invConfig.PowerSource == PowerLimiterInverterConfig::InverterPowerSource::Battery;
+    };
+
+    uint32_t totalUpperLimits = 0;
+    for (size_t i = 0; i < INV_MAX_COUNT; ++i) {
+        auto const& invConfig = config.PowerLimiter.Inverters[i];
+        if (invConfig.Serial == 0ULL) { break; }
+        if (isEligible(invConfig)) { totalUpperLimits += invConfig.UpperPowerLimit; }
+    }
+
+    if (totalUpperLimits == 0) { return; }
+
+    uint32_t limit = std::min(config.PowerLimiter.BaseLoadLimit, config.PowerLimiter.TotalUpperPowerLimit);
+
+    _failsafePending.clear();
+    for (size_t i = 0; i < INV_MAX_COUNT; ++i) {
+        auto const& invConfig = config.PowerLimiter.Inverters[i];
+        if (invConfig.Serial == 0ULL) { break; }
+        if (!isEligible(invConfig)) { continue; }
+
+        uint16_t share = limit * invConfig.UpperPowerLimit / totalUpperLimits;
+        _failsafePending.push_back({ invConfig.Serial, share });
+    }
+
+    MessageOutput.printf("[DPL] entering fail-safe state (%s), limiting to %u W in total\r\n",
+            reason, limit);
+
+    _oFailsafeSince = millis();
+    ++_failsafeEntries;
+}
+
+void PowerLimiterClass::leaveFailsafe()
+{
+    _failsafePending.clear();
+
+    if (!_oFailsafeSince) { return; }
+
+    uint32_t duration = millis() - *_oFailsafeSince;
+    _failsafeMillis += duration;
+    _oFailsafeSince = std::nullopt;
+
+    MessageOutput.printf("[DPL] leaving fail-safe state after %u ms\r\n", duration);
+}
+
+uint32_t PowerLimiterClass::getFailsafeMillis() const
+{
+    auto oSince = _oFailsafeSince;
+    if (!oSince) { return _failsafeMillis; }
+    return _failsafeMillis + (millis() - *oSince);
+}
+
 std::pair<float, char const*> PowerLimiterClass::getInverterDcVoltage() {
     auto const& config = Configuration.get();
 
@@ -457,6 +588,7 @@ void PowerLimiterClass::unconditionalFullSolarPassthrough()
 
 uint8_t PowerLimiterClass::getInverterUpdateTimeouts() const
 {
+    std::lock_guard<std::mutex> lock(_invertersMutex);
     uint8_t res = 0;
     for (auto const& upInv : _inverters) {
         res += upInv->getUpdateTimeouts();
@@ -466,6 +598,7 @@ uint8_t PowerLimiterClass::getInverterUpdateTimeouts() const
 
 uint8_t PowerLimiterClass::getPowerLimiterState()
 {
+    std::lock_guard<std::mutex> lock(_invertersMutex);
     bool reachable = false;
     bool producing = false;
     for (auto const& upInv : _inverters) {
@@ -500,7 +633,11 @@ uint16_t PowerLimiterClass::calcTargetOutput()
                 (meterValid?"valid":"stale"));
     }
 
-    if (!meterValid) { return baseLoad; }
+    if (!meterValid) {
+        _loadPredictor.reset();
+        _oPredictedLoad = std::nullopt;
+        return baseLoad;
+    }
 
     // the desired total output of all eligible inverters is whatever they are
     // producing right now plus the difference between the target consumption
@@ -543,9 +680,39 @@ uint16_t PowerLimiterClass::calcTargetOutput()
         currentTotalOutput += upInv->getCurrentOutputAcWatts();
     }
 
+    // the load the eligible inverters are supposed to cover. this value is
+    // negative if generators other than DPL-governed inverters export power.
+    int16_t load = currentTotalOutput + roundedMeterValue;
+
+    // the loop waits for a power meter reading which is younger than the
+    // inverter stats, so both values belong together. feed each reading once.
+    auto meterUpdate = PowerMeter.getLastUpdate();
+    if (meterUpdate != _lastLoadSampleMillis) {
+        _lastLoadSampleMillis = meterUpdate;
+        _loadPredictor.addSample(load, meterUpdate);
+    }
+
+    _oPredictedLoad = std::nullopt;
+    if (config.PowerLimiter.PredictiveEnabled) {
+        // predict the load for the time the new limits become effective
+        auto horizon = getPredictionHorizon();
+        _oPredictedLoad = _loadPredictor.predict(horizon);
+
+        if (_oPredictedLoad) {
+            if (_verboseLogging) {
+                MessageOutput.printf("[DPL] load is %d W, predicted %.0f W in %u ms "
+                        "(trend %.1f W/s, mean error %.0f W)\r\n", load,
+                        *_oPredictedLoad, horizon, _loadPredictor.getTrend(),
+                        _loadPredictor.getMeanAbsoluteError());
+            }
+
+            load = static_cast<int16_t>(std::round(*_oPredictedLoad));
+        }
+    }
+
     // this value is negative if we are exporting more than "targetConsumption"
     // power to the grid using generators other than DPL-governed inverters.
-    int16_t targetOutput = currentTotalOutput + roundedMeterValue - targetConsumption;
+    int16_t targetOutput = load - targetConsumption;
 
     // if we are already exporting more power than the (negative) target
     // consumption value allows us to, we don't want DPL-governed inverters to
@@ -555,6 +722,65 @@ uint16_t PowerLimiterClass::calcTargetOutput()
     return static_cast<uint16_t>(targetOutput);
 }
 
+/**
+ * the time a power meter reading may be old when it arrives. this can be the
+ * case for readings provided by networked meter readers, where a packet needs
+ * to travel through the network for some time after the actual measurement
+ * was done by the reader. this is assumed to take up to 2 seconds, which also
+ * gives the inverters time to ramp. meters which update less often may report
+ * an average over their update interval, so the time is extended to the
+ * intervals observed between the readings received recently. the percentile
+ * is used rather than mean and deviation, such that a single outage of the
+ * meter does not extend the time for the whole sample history.
+ */
+uint32_t PowerLimiterClass::getMeterSettleMillis()
+{
+    auto stats = PowerMeter.getIntervalStats();
+    if (stats.count < 8) { return 2000; }
+
+    return std::clamp<uint32_t>(stats.p90, 2000, 10000);
+}
+
+/**
+ * the time from the last power meter reading until new limits become
+ * effective: the age of the reading plus the time the slowest eligible
+ * inverter usually takes to acknowledge a new limit.
+ */
+uint32_t PowerLimiterClass::getPredictionHorizon()
+{
+    uint32_t latency = 0;
+    for (auto const& upInv : _inverters) {
+        if (PowerLimiterInverter::Eligibility::Eligible != upInv->isEligible()) { continue; }
+
+        auto oLatency = upInv->getLimitLatencyMillis();
+        if (oLatency) { latency = std::max(latency, *oLatency); }
+    }
+
+    return PowerMeter.getDataAgeMillis() + latency;
+}
+
+/**
+ * the maximum increase of the given inverter's output as per the configured
+ * ramp rate, based on the time since its last limit was set. the time is
+ * capped such that the ramp also applies after longer stable periods.
+ * inverters in standby are exempt, as waking them up already implies a jump
+ * to their lower power limit.
+ */
+uint16_t PowerLimiterClass::getRampAllowance(PowerLimiterInverter const& inverter)
+{
+    auto const& config = Configuration.get();
+    auto rampRate = config.PowerLimiter.RampRateLimit;
+
+    if (rampRate == 0 || !inverter.isProducing()) {
+        return std::numeric_limits<uint16_t>::max();
+    }
+
+    uint32_t elapsed = millis() - inverter.getLastLimitCommandMillis();
+    elapsed = std::clamp<uint32_t>(elapsed, 1000, PowerLimiterLoadPredictor::MaxHorizon);
+
+    return std::min<uint32_t>(std::numeric_limits<uint16_t>::max(), rampRate * elapsed / 1000);
+}
+
 /**
  * assigns new limits to all inverters matching the filter. returns the total
  * amount of power these inverters are expected to produce after the new limits
@@ -594,6 +820,26 @@ uint16_t PowerLimiterClass::updateInverterLimits(uint16_t powerRequested,
 
     uint16_t covered = 0;
 
+    // the allocator decides which inverters shall change their output. the
+    // resulting plan is dispatched to all inverters at once, as all of them
+    // are updated in the same DPL loop and each radio has its own queue.
+    PowerLimiterAllocator::Plan plan;
+    std::vector<PowerLimiterAllocator::Candidate> candidates;
+
+    auto isPlanned = [&plan](PowerLimiterInverter const* pInv) -> bool {
+        return std::any_of(plan.begin(), plan.end(),
+                [pInv](auto const& assignment) { return assignment.pInverter == pInv; });
+    };
+
+    auto logPlan = [this,&plan](char sign) -> void {
+        if (!_verboseLogging) { return; }
+
+        for (auto const& assignment : plan) {
+            MessageOutput.printf("[DPL] planned change for inverter %s: %c%u W\r\n",
+                    assignment.pInverter->getSerialStr(), sign, assignment.change);
+        }
+    };
+
     if (diff < 0) {
         uint16_t reduction = static_cast<uint16_t>(diff * -1);
 
@@ -606,6 +852,20 @@ uint16_t PowerLimiterClass::updateInverterLimits(uint16_t powerRequested,
         // standby to achieve the requested reduction.
         bool allowStandby = (totalMaxReduction < reduction);
 
+        for (auto pInv : matchingInverters) {
+            auto maxReduction = pInv->getMaxReductionWatts(allowStandby);
+            if (maxReduction >= hysteresis) { candidates.push_back({ pInv, maxReduction }); }
+        }
+
+        plan = PowerLimiterAllocator::plan(candidates, reduction, false);
+        logPlan('-');
+
+        for (auto const& assignment : plan) {
+            reduction -= assignment.pInverter->applyReduction(assignment.change, allowStandby);
+        }
+
+        // inverters might achieve less than planned. the remainder is
+        // requested from the other inverters, largest reduction first.
         std::sort(matchingInverters.begin(), matchingInverters.end(),
                 [allowStandby](auto const a, auto const b) {
                     auto aReduction = a->getMaxReductionWatts(allowStandby);
@@ -615,7 +875,7 @@ uint16_t PowerLimiterClass::updateInverterLimits(uint16_t powerRequested,
 
         for (auto pInv : matchingInverters) {
             auto maxReduction = pInv->getMaxReductionWatts(allowStandby);
-            if (reduction >= hysteresis && maxReduction >= hysteresis) {
+            if (!isPlanned(pInv) && reduction >= hysteresis && maxReduction >= hysteresis) {
                 reduction -= pInv->applyReduction(reduction, allowStandby);
             }
             covered += pInv->getExpectedOutputAcWatts();
@@ -624,15 +884,29 @@ uint16_t PowerLimiterClass::updateInverterLimits(uint16_t powerRequested,
     else {
         uint16_t increase = static_cast<uint16_t>(diff);
 
+        for (auto pInv : matchingInverters) {
+            auto maxIncrease = std::min(pInv->getMaxIncreaseWatts(), getRampAllowance(*pInv));
+            if (maxIncrease >= hysteresis) { candidates.push_back({ pInv, maxIncrease }); }
+        }
+
+        plan = PowerLimiterAllocator::plan(candidates, increase, true);
+        logPlan('+');
+
+        for (auto const& assignment : plan) {
+            increase -= assignment.pInverter->applyIncrease(assignment.change);
+        }
+
+        // inverters in standby are not woken up for less than their lower
+        // power limit. the remainder is requested from the other inverters.
         std::sort(matchingInverters.begin(), matchingInverters.end(),
                 [](auto const a, auto const b) {
                     return a->getMaxIncreaseWatts() > b->getMaxIncreaseWatts();
                 });
 
         for (auto pInv : matchingInverters) {
-            auto maxIncrease = pInv->getMaxIncreaseWatts();
-            if (increase >= hysteresis && maxIncrease >= hysteresis) {
-                increase -= pInv->applyIncrease(increase);
+            auto maxIncrease = std::min(pInv->getMaxIncreaseWatts(), getRampAllowance(*pInv));
+            if (!isPlanned(pInv) && increase >= hysteresis && maxIncrease >= hysteresis) {
+                increase -= pInv->applyIncrease(std::min(increase, maxIncrease));
             }
             covered += pInv->getExpectedOutputAcWatts();
         }
@@ -936,6 +1210,7 @@ bool PowerLimiterClass::isFullSolarPassthroughActive()
 
 bool PowerLimiterClass::usesBatteryPoweredInverter()
 {
+    std::lock_guard<std::mutex> lock(_invertersMutex);
     for (auto const& upInv : _inverters) {
         if (upInv->isBatteryPowered()) { return true; }
     }
@@ -945,6 +1220,7 @@ bool PowerLimiterClass::usesBatteryPoweredInverter()
 
 bool PowerLimiterClass::usesSmartBufferPoweredInverter()
 {
+    std::lock_guard<std::mutex> lock(_invertersMutex);
     for (auto const& upInv : _inverters) {
         if (upInv->isSmartBufferPowered()) { return true; }
     }
@@ -954,6 +1230,7 @@ bool PowerLimiterClass::usesSmartBufferPoweredInverter()
 
 bool PowerLimiterClass::isGovernedBatteryPoweredInverterProducing()
 {
+    std::lock_guard<std::mutex> lock(_invertersMutex);
     for (auto const& upInv : _inverters) {
         if (upInv->isBatteryPowered() && upInv->isProducing()) { return true; }
     }
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "PowerLimiterAllocator.h"
+#include <algorithm>
+#include <limits>
+
+PowerLimiterAllocator::Plan PowerLimiterAllocator::plan(std::vector<Candidate> const& candidates,
+        uint16_t change, bool increase)
+{
+    size_t count = std::min(candidates.size(), MaxCandidates);
+
+    // the minimum amount of inverters needed is found by using the
+    // inverters with the largest capacity first.
+    std::vector<uint16_t> capacities;
+    for (size_t i = 0; i < count; ++i) { capacities.push_back(candidates[i].capacity); }
+    std::sort(capacities.begin(), capacities.end(), std::greater<uint16_t>());
+
+    size_t needed = 0;
+    uint32_t achievable = 0;
+    while (needed < count && achievable < change) { achievable += capacities[needed++]; }
+
+    if (achievable < change) { change = achievable; }
+
+    Plan best;
+    float bestCost = std::numeric_limits<float>::max();
+    Plan plan;
+
+    // at most 1024 subsets for as many inverters as can be configured,
+    // which is cheap compared to sending a single command.
+    for (uint32_t subset = 1; subset < (1U << count); ++subset) {
+        if (static_cast<size_t>(__builtin_popcount(subset)) != needed) { continue; }
+
+        uint32_t capacity = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (subset & (1U << i)) { capacity += candidates[i].capacity; }
+        }
+        if (capacity < change) { continue; }
+
+        // share the change in proportion to the inverters' capacity
+        plan.clear();
+        uint16_t remaining = change;
+        for (size_t i = 0; i < count; ++i) {
+            if (!(subset & (1U << i))) { continue; }
+
+            uint16_t share = static_cast<uint32_t>(change) * candidates[i].capacity / capacity;
+            plan.push_back({ candidates[i].pInverter, share });
+            remaining -= share;
+        }
+
+        // rounding leftovers go to the first inverters that have room left
+        auto iter = plan.begin();
+        for (size_t i = 0; i < count && remaining > 0; ++i) {
+            if (!(subset & (1U << i))) { continue; }
+
+            uint16_t extra = std::min<uint16_t>(remaining, candidates[i].capacity - iter->change);
+            iter->change += extra;
+            remaining -= extra;
+            ++iter;
+        }
+
+        float cost = getCost(plan, increase);
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = plan;
+        }
+    }
+
+    return best;
+}
+
+float PowerLimiterAllocator::getCost(Plan const& plan, bool increase)
+{
+    auto losses = [](PowerLimiterInverter const* pInv, uint16_t acWatts) -> float {
+        if (acWatts == 0) { return 0; }
+        return acWatts * (1 / pInv->getEfficiency(acWatts) - 1);
+    };
+
+    float lossesChange = 0; // W
+    float change = 0; // W
+    float failureLosses = 0; // Ws
+    uint32_t latency = 0; // ms
+
+    for (auto const& assignment : plan) {
+        auto pInv = assignment.pInverter;
+        uint16_t before = pInv->getCurrentOutputAcWatts();
+        uint16_t after = increase ? before + assignment.change :
+            before - std::min(before, assignment.change);
+
+        lossesChange += losses(pInv, after) - losses(pInv, before);
+        change += assignment.change;
+        failureLosses += pInv->getFailureRate() * assignment.change * TimeoutMillis / 1000;
+
+        // the inverters ramp towards a new limit at a rate relative to their
+        // nominal power, so small inverters take longer for the same change.
+        uint32_t ramp = 0;
+        if (pInv->getInverterMaxPowerWatts() > 0) {
+            ramp = static_cast<uint32_t>(assignment.change) * FullScaleRampMillis / pInv->getInverterMaxPowerWatts();
+        }
+        latency = std::max(latency, pInv->getLimitLatencyMillis().value_or(0) + ramp);
+    }
+
+    return lossesChange * LossHorizonMillis / 1000 + change * latency / 1000 + failureLosses;
+}
@@ -1,3 +1,4 @@
+#include "BootProfiler.h"
 #include "RestartHelper.h"
 #include "MessageOutput.h"
 #include "PowerLimiterInverter.h"
@@ -5,6 +6,8 @@
 #include "PowerLimiterSolarInverter.h"
 #include "PowerLimiterSmartBufferInverter.h"
 
+uint32_t PowerLimiterInverter::_limitCommandsSent = 0;
+
 std::unique_ptr<PowerLimiterInverter> PowerLimiterInverter::create(
         bool verboseLogging, PowerLimiterInverterConfig const& config)
 {
@@ -63,6 +66,8 @@ PowerLimiterInverter::Eligibility PowerLimiterInverter::isEligible() const
 
 bool PowerLimiterInverter::update()
 {
+    updateEfficiency();
+
     auto reset = [this]() -> bool {
         _oTargetPowerState = std::nullopt;
         _oTargetPowerLimitWatts = std::nullopt;
@@ -102,6 +107,7 @@ bool PowerLimiterInverter::update()
 
     auto updateFailure = [this,&reset]() -> bool {
         ++_updateTimeouts;
+        _failureRate += 0.25f * (1 - _failureRate);
 
         // NOTE that these thresholds are not correlated to a specific time, since
         // this counts timeouts and failures, not absolute time. after any timeout or
@@ -210,6 +216,12 @@ bool PowerLimiterInverter::update()
 
             _oTargetPowerLimitWatts = std::nullopt;
 
+            if (CMD_OK == lastLimitCommandState) {
+                uint32_t latency = lastLimitCommandMillis - *_oUpdateStartMillis;
+                _oLimitLatencyMillis = _oLimitLatencyMillis ?
+                    (*_oLimitLatencyMillis * 3 + latency) / 4 : latency;
+            }
+
             if (CMD_OK != lastLimitCommandState) {
                 // we don't retry a failed limit command, since it might as well
                 // be outdated by now. the DPL will calculate a new limit for
@@ -227,6 +239,8 @@ bool PowerLimiterInverter::update()
 
         _spInverter->sendActivePowerControlRequest(newRelativeLimit,
                 PowerLimitControlType::RelativNonPersistent);
+        ++_limitCommandsSent;
+        BootProfiler.reach(BootProfilerClass::Milestone::FirstLimitCommand);
 
         return true;
     };
@@ -241,6 +255,7 @@ bool PowerLimiterInverter::update()
     if (switchPowerState(true)) { return true; }
 
     _updateTimeouts = 0;
+    _failureRate -= 0.25f * _failureRate;
 
     return reset();
 }
@@ -285,6 +300,51 @@ std::optional<uint32_t> PowerLimiterInverter::getLatestStatsMillis() const
     return _oStatsMillis;
 }
 
+uint32_t PowerLimiterInverter::getLastLimitCommandMillis() const
+{
+    return _spInverter->SystemConfigPara()->getLastUpdateCommand();
+}
+
+void PowerLimiterInverter::updateEfficiency()
+{
+    auto pStats = _spInverter->Statistics();
+    auto lastUpdate = pStats->getLastUpdate();
+    if (lastUpdate == _lastEfficiencyUpdate) { return; }
+    _lastEfficiencyUpdate = lastUpdate;
+
+    auto maxPower = getInverterMaxPowerWatts();
+    if (maxPower == 0 || !isProducing()) { return; }
+
+    // the efficiency is calculated from the AC and DC power, which is not
+    // reliable if the inverter produces very little power.
+    auto output = getCurrentOutputAcWatts();
+    if (output < maxPower / 20) { return; }
+
+    float efficiency = pStats->getChannelFieldValue(TYPE_INV, CH0, FLD_EFF) / 100;
+    if (efficiency < 0.5 || efficiency > 1) { return; }
+
+    auto& bucket = _efficiencyCurve[std::min<size_t>(output * 10 / maxPower, _efficiencyCurve.size() - 1)];
+    bucket += 0.1f * (efficiency - bucket);
+}
+
+float PowerLimiterInverter::getEfficiency(uint16_t acWatts) const
+{
+    auto maxPower = getInverterMaxPowerWatts();
+    if (maxPower == 0) { return _efficiencyCurve.back(); }
+
+    return _efficiencyCurve[std::min<size_t>(acWatts * 10 / maxPower, _efficiencyCurve.size() - 1)];
+}
+
+bool PowerLimiterInverter::isRampingDown() const
+{
+    if (!isProducing()) { return false; }
+
+    if ((millis() - getLastLimitCommandMillis()) > MaxRampMillis) { return false; }
+
+    // tolerate deviations of 2 % of the max power
+    return getCurrentOutputAcWatts() > getCurrentLimitWatts() + getInverterMaxPowerWatts() / 50;
+}
+
 uint16_t PowerLimiterInverter::getInverterMaxPowerWatts() const
 {
     return _spInverter->DevInfo()->getMaxPower();
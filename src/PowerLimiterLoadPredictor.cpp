@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "PowerLimiterLoadPredictor.h"
+#include <algorithm>
+#include <cmath>
+
+void PowerLimiterLoadPredictor::reset()
+{
+    _oLastSample = std::nullopt;
+    _level = 0;
+    _trend = 0;
+    _meanAbsoluteError = 0;
+    _loadSteps = 0;
+}
+
+void PowerLimiterLoadPredictor::addSample(float load, uint32_t timestamp)
+{
+    if (!_oLastSample) {
+        _oLastSample = timestamp;
+        _level = load;
+        _trend = 0;
+        return;
+    }
+
+    uint32_t elapsed = timestamp - *_oLastSample;
+    if (elapsed == 0) { return; }
+
+    _oLastSample = timestamp;
+
+    float forecast = _level + _trend * elapsed / 1000;
+    float error = load - forecast;
+
+    float errorAlpha = 1 - std::exp(-(elapsed / ErrorTimeConstant));
+    _meanAbsoluteError += errorAlpha * (std::abs(error) - _meanAbsoluteError);
+
+    if (std::abs(error) > StepThreshold) {
+        // the load changed in a step, the history does not tell anything
+        // about the future anymore.
+        _level = load;
+        _trend = 0;
+        ++_loadSteps;
+        return;
+    }
+
+    float levelAlpha = 1 - std::exp(-(elapsed / LevelTimeConstant));
+    float trendAlpha = 1 - std::exp(-(elapsed / TrendTimeConstant));
+
+    float previousLevel = _level;
+    _level = forecast + levelAlpha * error;
+    _trend += trendAlpha * ((_level - previousLevel) * 1000 / elapsed - _trend);
+}
+
+std::optional<float> PowerLimiterLoadPredictor::predict(uint32_t horizon) const
+{
+    if (!_oLastSample) { return std::nullopt; }
+
+    horizon = std::min(horizon, MaxHorizon);
+    return _level + _trend * horizon / 1000;
+}
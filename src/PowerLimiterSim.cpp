@@ -0,0 +1,310 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#ifdef DPL_SIM
+
+#include "PowerLimiterSim.h"
+#include "Configuration.h"
+#include "MessageOutput.h"
+#include <Hoymiles.h>
+#include <algorithm>
+#include <cmath>
+
+#define DPL_SIM_PROFILE_FILE "/dplsim.csv"
+#define DPL_SIM_REPORT_INTERVAL (10 * 60 * 1000)
+
+PowerLimiterSimClass PowerLimiterSim;
+
+PowerLimiterSimClass::PowerLimiterSimClass()
+    : _loopTask(100 * TASK_MILLISECOND, TASK_FOREVER, std::bind(&PowerLimiterSimClass::loop, this))
+{
+}
+
+void PowerLimiterSimClass::init(Scheduler& scheduler)
+{
+    scheduler.addTask(_loopTask);
+    _loopTask.enable();
+
+    _start = _lastUpdate = _lastReport = millis();
+    resetMetrics();
+
+    if (LittleFS.exists(DPL_SIM_PROFILE_FILE)) {
+        _profile = LittleFS.open(DPL_SIM_PROFILE_FILE, "r");
+    }
+
+    if (_profile && readProfileSample(_profileCurrent) && readProfileSample(_profileNext)) {
+        MessageOutput.println("[DPL Sim] replaying load profile " DPL_SIM_PROFILE_FILE);
+        return;
+    }
+
+    if (_profile) { _profile.close(); }
+    MessageOutput.println("[DPL Sim] using synthetic load profile");
+}
+
+void PowerLimiterSimClass::resetMetrics()
+{
+    _metrics = {};
+    _metricsStart = millis();
+    _limitCommandsOffset = Hoymiles.getRadioSim()->getStatistics().limitCommands;
+    _oStepMillis = std::nullopt;
+    _oInBandSince = std::nullopt;
+}
+
+std::optional<float> PowerLimiterSimClass::getMeterReading()
+{
+    auto res = _oMeterReading;
+    _oMeterReading = std::nullopt;
+    return res;
+}
+
+float PowerLimiterSimClass::getBatteryVoltage() const
+{
+    // 16S LiFePO4, very much simplified: linear between 48 V (empty) and
+    // 54 V (full), plus a voltage drop proportional to the current.
+    return 48.0f + 0.06f * _batterySoC + 0.02f * _batteryCurrent;
+}
+
+void PowerLimiterSimClass::loop()
+{
+    uint32_t now = millis();
+    float elapsed = (now - _lastUpdate) / 1000.0f;
+    _lastUpdate = now;
+
+    auto pRadio = Hoymiles.getRadioSim();
+    pRadio->setIrradiation(getIrradiation());
+
+    auto const& config = Configuration.get();
+
+    auto getInverterConfig = [&config](uint64_t serial) -> PowerLimiterInverterConfig const* {
+        for (auto const& inv : config.PowerLimiter.Inverters) {
+            if (inv.Serial == serial) { return &inv; }
+        }
+        return nullptr;
+    };
+
+    float production = 0; // AC power registered by the power meter
+    float batteryDraw = 0; // DC power drawn by battery-powered inverters
+
+    for (size_t i = 0; i < Hoymiles.getNumInverters(); ++i) {
+        auto inv = Hoymiles.getInverterByPos(i);
+        auto pConfig = getInverterConfig(inv->serial());
+
+        // smart buffers are modelled like batteries, they are charged by the
+        // same PV modules as the battery is.
+        bool batteryPowered = pConfig != nullptr &&
+            pConfig->PowerSource != PowerLimiterInverterConfig::InverterPowerSource::Solar;
+
+        if (batteryPowered) {
+            float available = (_batterySoC > 0) ? BatteryMaxDischarge : 0;
+            pRadio->setDcSource(inv->serial(), available, getBatteryVoltage());
+        }
+
+        float acPower = pRadio->getAcPower(inv->serial());
+        if (batteryPowered) { batteryDraw += acPower / InverterEfficiency; }
+        if (pConfig == nullptr || pConfig->IsBehindPowerMeter) { production += acPower; }
+    }
+
+    updateBattery(batteryDraw, elapsed);
+
+    float load = getLoad();
+    float gridPower = load - production;
+
+    if (now - _lastMeterSample >= MeterInterval) {
+        _lastMeterSample = now;
+        // readings are quantized to 0.1 W and jitter by a few watts
+        float noise = static_cast<int32_t>(nextRandom() % 61) / 10.0f - 3.0f;
+        _meterSamples.emplace_back(now + MeterLatency, std::round((gridPower + noise) * 10) / 10);
+    }
+
+    while (!_meterSamples.empty() && static_cast<int32_t>(now - _meterSamples.front().first) >= 0) {
+        _oMeterReading = _meterSamples.front().second;
+        _meterSamples.pop_front();
+    }
+
+    _metrics.loadEnergy += load * elapsed / 3600;
+    if (gridPower > 0) {
+        _metrics.gridImport += gridPower * elapsed / 3600;
+    } else {
+        _metrics.gridExport -= gridPower * elapsed / 3600;
+    }
+
+    _metrics.duration = (now - _metricsStart) / 1000;
+    _metrics.limitCommands = pRadio->getStatistics().limitCommands - _limitCommandsOffset;
+
+    updateSettling(gridPower, load);
+
+    if (now - _lastReport >= DPL_SIM_REPORT_INTERVAL) {
+        _lastReport = now;
+        printReport(MessageOutput);
+    }
+}
+
+void PowerLimiterSimClass::updateBattery(float dcPower, float elapsed)
+{
+    float chargePower = BatteryChargerPeak * getIrradiation();
+
+    // the charger is curtailed once the battery is full
+    if (_batterySoC >= 100 && chargePower > dcPower) { chargePower = dcPower; }
+
+    float netPower = chargePower - dcPower;
+    _batterySoC += netPower * elapsed / 3600 / BatteryCapacity * 100;
+    _batterySoC = std::clamp(_batterySoC, 0.0f, 100.0f);
+    _batteryCurrent = netPower / getBatteryVoltage();
+}
+
+/**
+ * a load step is any change of the household load by more than
+ * LoadStepThreshold since the last step. the grid power is settled once it
+ * stayed within SettleBand around the target consumption for SettleHoldTime.
+ * the settling time is the time from the load step until the grid power
+ * entered that band for good. steps superseded by another step before
+ * settling are neither counted as settled nor as unsettled.
+ */
+void PowerLimiterSimClass::updateSettling(float gridPower, float load)
+{
+    uint32_t now = millis();
+
+    if (std::abs(load - _referenceLoad) >= LoadStepThreshold) {
+        _referenceLoad = load;
+        ++_metrics.loadSteps;
+        _oStepMillis = now;
+        _oInBandSince = std::nullopt;
+    }
+
+    if (!_oStepMillis) { return; }
+
+    auto target = Configuration.get().PowerLimiter.TargetPowerConsumption;
+    if (std::abs(gridPower - target) > SettleBand) {
+        _oInBandSince = std::nullopt;
+    } else if (!_oInBandSince) {
+        _oInBandSince = now;
+    }
+
+    if (_oInBandSince && (now - *_oInBandSince) >= SettleHoldTime) {
+        uint32_t settlingTime = *_oInBandSince - *_oStepMillis;
+        ++_metrics.settled;
+        _metrics.settlingTimeTotal += settlingTime;
+        _metrics.settlingTimeMax = std::max(_metrics.settlingTimeMax, settlingTime);
+        _oStepMillis = std::nullopt;
+        _oInBandSince = std::nullopt;
+        return;
+    }
+
+    if ((now - *_oStepMillis) > SettleTimeout) {
+        ++_metrics.unsettled;
+        _oStepMillis = std::nullopt;
+        _oInBandSince = std::nullopt;
+    }
+}
+
+float PowerLimiterSimClass::getLoad()
+{
+    if (!_profile) { return getSyntheticLoad(); }
+
+    uint32_t seconds = (millis() - _start) / 1000;
+
+    // the recorded load is held until the next sample is due
+    while (seconds >= _profileNext.first) {
+        _profileCurrent = _profileNext;
+        if (readProfileSample(_profileNext)) { continue; }
+
+        // start over, the first sample follows the last one by one second
+        _profileOffset = _profileCurrent.first + 1;
+        _profile.seek(0);
+        if (!readProfileSample(_profileNext)) {
+            _profile.close();
+            return getSyntheticLoad();
+        }
+    }
+
+    return _profileCurrent.second;
+}
+
+bool PowerLimiterSimClass::readProfileSample(std::pair<uint32_t, float>& sample)
+{
+    while (_profile.available()) {
+        String line = _profile.readStringUntil('\n');
+
+        unsigned seconds;
+        float watts;
+        if (sscanf(line.c_str(), "%u,%f", &seconds, &watts) != 2) { continue; } // header or garbage
+
+        sample = { _profileOffset + seconds, watts };
+        return true;
+    }
+
+    return false;
+}
+
+float PowerLimiterSimClass::getSyntheticLoad()
+{
+    struct tm timeinfo;
+    if (!getLocalTime(&timeinfo, 5)) { return 150; }
+
+    uint16_t minute = timeinfo.tm_hour * 60 + timeinfo.tm_min;
+    auto between = [minute](uint16_t from, uint16_t to) {
+        return minute >= from && minute < to;
+    };
+
+    float load = 120; // standby consumers, network equipment, ...
+
+    // fridge compressor running 12 of 40 minutes
+    if (minute % 40 < 12) { load += 90; }
+
+    // lights, computers and small appliances switch on and off at random
+    // while the household is awake
+    uint32_t now = millis();
+    if (static_cast<int32_t>(now - _nextApplianceChange) >= 0) {
+        bool awake = between(6 * 60 + 30, 23 * 60);
+        _applianceLoad = awake ? (nextRandom() % 700) : 0;
+        _nextApplianceChange = now + (30 + nextRandom() % 570) * 1000;
+    }
+    load += _applianceLoad;
+
+    // kettle
+    if (between(7 * 60, 7 * 60 + 4) || between(16 * 60, 16 * 60 + 4)) { load += 2000; }
+
+    // cooking
+    if (between(12 * 60, 12 * 60 + 30) || between(18 * 60 + 30, 19 * 60 + 15)) { load += 1400; }
+
+    // washing machine: heating, then washing
+    if (between(10 * 60, 10 * 60 + 20)) { load += 2000; }
+    else if (between(10 * 60 + 20, 11 * 60 + 20)) { load += 250; }
+
+    return load;
+}
+
+uint32_t PowerLimiterSimClass::nextRandom()
+{
+    // xorshift32, such that the synthetic profile is reproducible
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+    return _random;
+}
+
+float PowerLimiterSimClass::getIrradiation()
+{
+    struct tm timeinfo;
+    if (!getLocalTime(&timeinfo, 5)) { return 0; }
+
+    // clear sky between 06:00 and 20:00, peaking at 13:00
+    float hour = timeinfo.tm_hour + timeinfo.tm_min / 60.0f + timeinfo.tm_sec / 3600.0f;
+    if (hour <= 6 || hour >= 20) { return 0; }
+
+    return std::sin(static_cast<float>(M_PI) * (hour - 6) / 14);
+}
+
+void PowerLimiterSimClass::printReport(Print& output) const
+{
+    output.printf("[DPL Sim] %u s simulated, load %.0f Wh, grid import %.0f Wh, "
+            "grid export %.0f Wh, %u limit commands\r\n",
+            _metrics.duration, _metrics.loadEnergy, _metrics.gridImport,
+            _metrics.gridExport, _metrics.limitCommands);
+
+    uint32_t avg = _metrics.settled > 0 ? _metrics.settlingTimeTotal / _metrics.settled : 0;
+    output.printf("[DPL Sim] %u load steps, %u settled after %u ms on average "
+            "(max %u ms), %u unsettled, battery SoC %.1f %%\r\n",
+            _metrics.loadSteps, _metrics.settled, avg, _metrics.settlingTimeMax,
+            _metrics.unsettled, _batterySoC);
+}
+
+#endif // DPL_SIM
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "RealtimeScheduler.h"
+#include "MessageOutput.h"
+#include "Scheduler.h"
+
+RealtimeSchedulerClass RealtimeScheduler;
+
+#ifdef REALTIME_CORE
+
+void RealtimeSchedulerClass::init()
+{
+    // above the Arduino loop task, such that it does not matter whether the
+    // realtime scheduler shares its core, but below the network stack.
+    uint32_t constexpr stackSize = 8192;
+    if (pdPASS != xTaskCreatePinnedToCore(RealtimeSchedulerClass::taskLoopHelper,
+            "realtime", stackSize, this, 2/*prio*/, &_taskHandle, REALTIME_CORE)) {
+        MessageOutput.println("[RealtimeScheduler] failed to create task");
+        return;
+    }
+
+    MessageOutput.printf("[RealtimeScheduler] running on core %d\r\n", REALTIME_CORE);
+}
+
+Scheduler& RealtimeSchedulerClass::get()
+{
+    return _scheduler;
+}
+
+void RealtimeSchedulerClass::post(std::function<void()> const& func)
+{
+    _messages.push(func);
+}
+
+void RealtimeSchedulerClass::taskLoopHelper(void* context)
+{
+    auto pInstance = static_cast<RealtimeSchedulerClass*>(context);
+    pInstance->taskLoop();
+}
+
+void RealtimeSchedulerClass::taskLoop()
+{
+    while (true) {
+        while (auto oFunc = _messages.pop()) { (*oFunc)(); }
+
+        _scheduler.execute();
+
+        // the DPL and the radio tasks run on every pass, so we never idle.
+        // the idle task of this core must run to feed the task watchdog.
+        vTaskDelay(1);
+    }
+}
+
+#else
+
+void RealtimeSchedulerClass::init()
+{
+}
+
+Scheduler& RealtimeSchedulerClass::get()
+{
+    return scheduler;
+}
+
+void RealtimeSchedulerClass::post(std::function<void()> const& func)
+{
+    func();
+}
+
+#endif
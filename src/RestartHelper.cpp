@@ -4,6 +4,7 @@
  */
 #include "RestartHelper.h"
 #include "Display_Graphic.h"
+#include "HistoryLog.h"
 #include "Led_Single.h"
 #include <Esp.h>
 
@@ -30,6 +31,7 @@ void RestartHelperClass::loop()
     if (_rebootTask.isFirstIteration()) {
         LedSingle.turnAllOff();
         Display.setStatus(false);
+        HistoryLog.flush();
     } else {
         ESP.restart();
     }
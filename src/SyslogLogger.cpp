@@ -4,6 +4,8 @@
  */
 #include <HardwareSerial.h>
 #include <ESPmDNS.h>
+#include <WiFi.h>
+#include <sys/time.h>
 #include "defaults.h"
 #include "SyslogLogger.h"
 #include "Configuration.h"
@@ -12,6 +14,7 @@
 
 SyslogLogger::SyslogLogger()
     : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&SyslogLogger::loop, this))
+    , _sink(std::bind(&SyslogLogger::send, this, std::placeholders::_1, std::placeholders::_2))
 {
 }
 
@@ -37,20 +40,18 @@ void SyslogLogger::updateSettings(const String&& hostname)
     }
 
     _port = config.Port;
+    _useTcp = config.UseTcp;
     _syslog_hostname = config.Hostname;
     if (_syslog_hostname.isEmpty()) {
         MessageOutput.println("[SyslogLogger] Hostname not configured");
         return;
     }
 
-    MessageOutput.printf("[SyslogLogger] Logging to %s!\r\n", _syslog_hostname.c_str());
+    MessageOutput.printf("[SyslogLogger] Logging to %s via %s!\r\n",
+            _syslog_hostname.c_str(), (_useTcp ? "TCP" : "UDP"));
 
-    _header = "<14>1 - ";  // RFC5424: Facility USER, severity INFO, version 1, NIL timestamp.
-    _header += hostname;
-    _header += " OpenDTU ";
-    _header += _proc_id;
-    // NIL values for message id and structured data
-    _header += " - - ";
+    _batcher.setHeader(hostname.c_str(), "OpenDTU", _proc_id.c_str());
+    _batcher.setFraming(_useTcp ? SyslogBatcher::Framing::OctetCounting : SyslogBatcher::Framing::Datagram);
 
     // Enable logger.
     enable();
@@ -62,28 +63,60 @@ void SyslogLogger::write(const uint8_t *buffer, size_t size)
     if (!_enabled || !isResolved()) {
         return;
     }
-    for (int i = 0; i < size; i++) {
-        uint8_t c = buffer[i];
-        bool overflow = false;
-        if (c != '\r' && c != '\n') {
-            // Replace control and non-ASCII characters with '?'.
-            overflow = !_udp.write(c >= 0x20 && c < 0x7f ? c : '?');
-        }
-        if (c == '\n' || overflow) {
-            _udp.endPacket();
-            _udp.beginPacket(_address, _port);
-            _udp.print(_header);
-        }
+
+    // lines are collected into batches, which are sent once full or
+    // once they are due in the loop
+    _batcher.add(reinterpret_cast<char const*>(buffer), size, millis(), getTimestamp(), _sink);
+}
+
+std::string SyslogLogger::getTimestamp()
+{
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+
+    // NIL timestamp while the time is not synchronized yet
+    if (tv.tv_sec < 1577836800) { return ""; }
+
+    struct tm timeinfo;
+    gmtime_r(&tv.tv_sec, &timeinfo);
+
+    char buffer[32];
+    size_t len = strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &timeinfo);
+    snprintf(buffer + len, sizeof(buffer) - len, ".%03ldZ", static_cast<long>(tv.tv_usec / 1000));
+    return buffer;
+}
+
+void SyslogLogger::send(char const* data, size_t size)
+{
+    auto bytes = reinterpret_cast<uint8_t const*>(data);
+
+    if (_useTcp) {
+        // batches are discarded while the connection is down or while the
+        // TCP task does not keep up
+        if (!_tcpConnected) { return; }
+
+        std::lock_guard<std::mutex> lock(_tcpMutex);
+        if (_tcpQueue.size() >= MaxPendingBatches) { return; }
+        _tcpQueue.emplace_back(data, size);
+        _tcpCv.notify_one();
+        return;
     }
+
+    if (!_udp.beginPacket(_address, _port)) { return; }
+    _udp.write(bytes, size);
+    _udp.endPacket();
 }
 
 void SyslogLogger::disable()
 {
     MessageOutput.println("[SyslogLogger] Disable");
+    stopTcpTask();
+
     std::lock_guard<std::mutex> lock(_mutex);
     if (_enabled) {
         _enabled = false;
         _address = INADDR_NONE;
+        _batcher.reset();
         _udp.stop();
     }
 }
@@ -91,7 +124,7 @@ void SyslogLogger::disable()
 void SyslogLogger::enable()
 {
     // Bind random source port.
-    if (!_udp.begin(0)) {
+    if (!_useTcp && !_udp.begin(0)) {
         MessageOutput.println("[SyslogLogger] No sockets available");
         return;
     }
@@ -105,33 +138,124 @@ bool SyslogLogger::resolveAndStart()
     if (Configuration.get().Mdns.Enabled) {
         _address = MDNS.queryHost(_syslog_hostname); // INADDR_NONE if failed
     }
-    if (_address != INADDR_NONE) {
-        if (!_udp.beginPacket(_address, _port)) {
-            return false;
-        }
-    } else {
-        if (!_udp.beginPacket(_syslog_hostname.c_str(), _port)) {
+    if (_address == INADDR_NONE) {
+        if (!WiFiGenericClass::hostByName(_syslog_hostname.c_str(), _address)) {
+            _address = INADDR_NONE;
             return false;
         }
-        _address = _udp.remoteIP();  // Store resolved address.
     }
-    _udp.print(_header);
-    _udp.print("[SyslogLogger] Logging to ");
-    _udp.print(_syslog_hostname);
-    _udp.endPacket();
-    _udp.beginPacket(_address, _port);
-    _udp.print(_header);
+
+    if (_useTcp) { startTcpTask(); }
+
+    String message = "[SyslogLogger] Logging to " + _syslog_hostname;
+    _batcher.add(message.c_str(), message.length(), millis(), getTimestamp(), _sink);
     return true;
 }
 
+void SyslogLogger::startTcpTask()
+{
+    if (_tcpTaskHandle != nullptr) { return; }
+
+    std::unique_lock<std::mutex> lock(_tcpMutex);
+    _stopTcp = false;
+    _tcpQueue.clear();
+    lock.unlock();
+
+    _tcpTaskDone = false;
+
+    uint32_t constexpr stackSize = 4096;
+    xTaskCreate(SyslogLogger::tcpLoopHelper, "SyslogTcp",
+            stackSize, this, 1/*prio*/, &_tcpTaskHandle);
+}
+
+void SyslogLogger::stopTcpTask()
+{
+    if (_tcpTaskHandle == nullptr) { return; }
+
+    std::unique_lock<std::mutex> lock(_tcpMutex);
+    _stopTcp = true;
+    lock.unlock();
+
+    _tcpCv.notify_all();
+
+    while (!_tcpTaskDone) { delay(10); }
+    _tcpTaskHandle = nullptr;
+}
+
+void SyslogLogger::tcpLoopHelper(void* context)
+{
+    auto pInstance = static_cast<SyslogLogger*>(context);
+    pInstance->tcpLoop();
+    pInstance->_tcpTaskDone = true;
+    vTaskDelete(nullptr);
+}
+
+void SyslogLogger::tcpLoop()
+{
+    std::unique_lock<std::mutex> lock(_tcpMutex);
+    uint32_t lastConnectAttempt = 0;
+    bool firstAttempt = true;
+
+    while (!_stopTcp) {
+        if (!_tcp.connected()) {
+            _tcpConnected = false;
+            _tcpQueue.clear();
+
+            auto elapsedMillis = millis() - lastConnectAttempt;
+            if (!firstAttempt && elapsedMillis < ReconnectIntervalMillis) {
+                auto sleepMs = ReconnectIntervalMillis - elapsedMillis;
+                _tcpCv.wait_for(lock, std::chrono::milliseconds(sleepMs),
+                        [this] { return _stopTcp; }); // releases the mutex
+                continue;
+            }
+
+            firstAttempt = false;
+            lastConnectAttempt = millis();
+
+            lock.unlock(); // connecting takes up to the connect timeout
+            _tcp.stop();
+            bool connected = _tcp.connect(_address, _port, ConnectTimeoutMillis);
+            lock.lock();
+
+            _tcpConnected = connected;
+            continue;
+        }
+
+        if (_tcpQueue.empty()) {
+            // wakes up once in a while to notice a lost connection
+            _tcpCv.wait_for(lock, std::chrono::seconds(1),
+                    [this] { return _stopTcp || !_tcpQueue.empty(); });
+            continue;
+        }
+
+        std::string batch = std::move(_tcpQueue.front());
+        _tcpQueue.pop_front();
+
+        lock.unlock(); // writing blocks while the socket's send buffer is full
+        _tcp.write(reinterpret_cast<uint8_t const*>(batch.data()), batch.size());
+        lock.lock();
+    }
+
+    _tcpConnected = false;
+    _tcp.stop();
+}
+
 void SyslogLogger::loop()
 {
     std::lock_guard<std::mutex> lock(_mutex);
-    if (!_enabled || !NetworkSettings.isConnected() || isResolved()) {
+    if (!_enabled || !NetworkSettings.isConnected()) {
         return;
     }
-    if (!resolveAndStart()) {
-        _enabled = false;
+
+    if (!isResolved()) {
+        if (!resolveAndStart()) {
+            _enabled = false;
+        }
+        return;
+    }
+
+    if (_batcher.isFlushDue(millis())) {
+        _batcher.flush(_sink);
     }
 }
 
@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "TaskProfiler.h"
+
+TaskProfilerClass TaskProfiler;
+
+#ifdef TASK_PROFILER
+
+#include <algorithm>
+#include <cmath>
+
+void TaskProfilerClass::nameNewTasks(Scheduler& scheduler, char const* label)
+{
+    // the chain contains probes once initialized
+    if (_upStartProbe) { return; }
+
+    std::vector<Task*> newTasks;
+    for (Task* pTask = scheduler.getFirstTask(); pTask != nullptr; pTask = pTask->getNextTask()) {
+        if (findEntry(pTask) == nullptr) { newTasks.push_back(pTask); }
+    }
+
+    if (newTasks.size() == 1) {
+        addEntry(newTasks.front(), label);
+        return;
+    }
+
+    for (size_t i = 0; i < newTasks.size(); ++i) {
+        addEntry(newTasks[i], String(label) + "/" + String(i + 1));
+    }
+}
+
+void TaskProfilerClass::init(Scheduler& scheduler)
+{
+    _pScheduler = &scheduler;
+
+    std::vector<Task*> tasks;
+    for (Task* pTask = scheduler.getFirstTask(); pTask != nullptr; pTask = pTask->getNextTask()) {
+        tasks.push_back(pTask);
+    }
+
+    for (Task* pTask : tasks) { scheduler.deleteTask(*pTask); }
+
+    _upStartProbe = std::make_unique<Task>(TASK_IMMEDIATE, TASK_FOREVER,
+            std::bind(&TaskProfilerClass::onStartProbe, this));
+    scheduler.addTask(*_upStartProbe);
+    _upStartProbe->enable();
+
+    for (Task* pTask : tasks) {
+        Entry* pEntry = findEntry(pTask);
+        if (pEntry == nullptr) { pEntry = &addEntry(pTask, "unnamed"); }
+
+        scheduler.addTask(*pTask);
+        insertProbe(*pEntry);
+    }
+
+    _lastProbeUs = micros();
+}
+
+std::vector<TaskProfilerClass::Report> TaskProfilerClass::getReports() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<Report> reports;
+    reports.reserve(_entries.size());
+    for (auto const& upEntry : _entries) {
+        reports.push_back(createReport(upEntry->name,
+                upEntry->pTask->getInterval(), upEntry->stats));
+    }
+
+    return reports;
+}
+
+TaskProfilerClass::Report TaskProfilerClass::getLoopReport() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return createReport("loop", 0, _loopStats);
+}
+
+TaskProfilerClass::Entry& TaskProfilerClass::addEntry(Task* pTask, String const& name)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _entries.push_back(std::make_unique<Entry>());
+    auto& entry = *_entries.back();
+    entry.pTask = pTask;
+    entry.name = name;
+    return entry;
+}
+
+TaskProfilerClass::Entry* TaskProfilerClass::findEntry(Task* pTask)
+{
+    for (auto const& upEntry : _entries) {
+        if (upEntry->pTask == pTask) { return upEntry.get(); }
+    }
+
+    return nullptr;
+}
+
+void TaskProfilerClass::insertProbe(Entry& entry)
+{
+    if (entry.upProbe) { _pScheduler->deleteTask(*entry.upProbe); }
+
+    entry.upProbe = std::make_unique<Task>(TASK_IMMEDIATE, TASK_FOREVER,
+            [this, &entry]() { onProbe(entry); });
+    entry.lastRunCounter = entry.pTask->getRunCounter();
+
+    _pScheduler->addTask(*entry.upProbe);
+    entry.upProbe->enable();
+    _pLastProbe = entry.upProbe.get();
+}
+
+void TaskProfilerClass::onProbe(Entry& entry)
+{
+    uint32_t now = micros();
+
+    // the task was removed from the chain, another probe precedes this one
+    bool inChain = entry.upProbe->getPreviousTask() == entry.pTask;
+
+    auto runCounter = entry.pTask->getRunCounter();
+    if (inChain && runCounter != entry.lastRunCounter) {
+        entry.lastRunCounter = runCounter;
+
+        uint32_t budgetUs = OverrunThresholdUs;
+        if (entry.pTask->getInterval() > 0) {
+            budgetUs = std::min<uint32_t>(budgetUs, entry.pTask->getInterval() * 1000);
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        entry.stats.record(now - _lastProbeUs, budgetUs);
+    }
+
+    // excludes the time spent in the probe itself
+    _lastProbeUs = micros();
+}
+
+void TaskProfilerClass::onStartProbe()
+{
+    uint32_t now = micros();
+
+    if (_passStarted) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _loopStats.record(now - _passStartUs, OverrunThresholdUs);
+    }
+    _passStarted = true;
+    _passStartUs = now;
+
+    // tasks added at runtime are appended to the chain, i.e., they follow
+    // the last probe. they are moved behind probes of their own. we are the
+    // first task in the chain, so modifying the end of it is safe.
+    if (_pScheduler->getLastTask() != _pLastProbe) {
+        std::vector<Task*> newTasks;
+        for (Task* pTask = _pScheduler->getLastTask(); pTask != _pLastProbe; pTask = pTask->getPreviousTask()) {
+            newTasks.insert(newTasks.begin(), pTask);
+        }
+
+        for (Task* pTask : newTasks) { _pScheduler->deleteTask(*pTask); }
+
+        for (Task* pTask : newTasks) {
+            Entry* pEntry = findEntry(pTask);
+            if (pEntry == nullptr) { pEntry = &addEntry(pTask, "unnamed"); }
+
+            _pScheduler->addTask(*pTask);
+            insertProbe(*pEntry);
+        }
+    }
+
+    _lastProbeUs = micros();
+}
+
+TaskProfilerClass::Report TaskProfilerClass::createReport(String const& name,
+        uint32_t interval, Stats const& stats) const
+{
+    Report report;
+    report.name = name;
+    report.interval = interval;
+    report.calls = stats.calls;
+    report.totalUs = stats.totalUs;
+    report.maxUs = stats.maxUs;
+    report.p99Us = stats.getPercentile(0.99);
+    report.overruns = stats.overruns;
+    return report;
+}
+
+void TaskProfilerClass::Stats::record(uint32_t us, uint32_t budgetUs)
+{
+    ++calls;
+    totalUs += us;
+    maxUs = std::max(maxUs, us);
+    if (us > budgetUs) { ++overruns; }
+
+    // the histogram is scaled down rather than saturated, which gives
+    // recent executions a higher weight after a long uptime.
+    auto& counter = histogram[getBucket(us)];
+    if (counter == UINT16_MAX) {
+        for (auto& c : histogram) { c /= 2; }
+    }
+    ++counter;
+}
+
+uint32_t TaskProfilerClass::Stats::getPercentile(float fraction) const
+{
+    uint32_t total = 0;
+    for (auto c : histogram) { total += c; }
+    if (total == 0) { return 0; }
+
+    uint32_t target = std::ceil(total * fraction);
+    uint32_t cumulative = 0;
+    for (size_t bucket = 0; bucket < HistogramBuckets; ++bucket) {
+        cumulative += histogram[bucket];
+        if (cumulative < target) { continue; }
+
+        if (bucket == HistogramBuckets - 1) { return maxUs; }
+        return std::min(getBucketUpperBound(bucket), maxUs);
+    }
+
+    return maxUs;
+}
+
+// buckets 0 and 1 hold the respective value, every following pair of
+// buckets splits one power of two into halves.
+size_t TaskProfilerClass::getBucket(uint32_t us)
+{
+    if (us < 2) { return us; }
+
+    uint8_t msb = 31 - __builtin_clz(us);
+    uint8_t upperHalf = (us >> (msb - 1)) & 1;
+    return std::min<size_t>(2 * msb + upperHalf, HistogramBuckets - 1);
+}
+
+uint32_t TaskProfilerClass::getBucketUpperBound(size_t bucket)
+{
+    if (bucket < 2) { return bucket; }
+
+    uint8_t msb = bucket / 2;
+    uint32_t halfWidth = 1U << (msb - 1);
+    uint32_t lower = (1U << msb) + (bucket % 2) * halfWidth;
+    return lower + halfWidth - 1;
+}
+
+#endif
@@ -4,6 +4,7 @@
  */
 #include "WebApi_eventlog.h"
 #include "WebApi.h"
+#include "I18n.h"
 #include <AsyncJson.h>
 #include <Hoymiles.h>
 
@@ -24,15 +25,20 @@ void WebApiEventlogClass::onEventlogStatus(AsyncWebServerRequest* request)
     auto& root = response->getRoot();
     auto serial = WebApi.parseSerialFromRequest(request);
 
+    // english, german and french messages are built into the firmware,
+    // other languages are provided by language packs (falling back to
+    // english for messages missing in the language pack).
     AlarmMessageLocale_t locale = AlarmMessageLocale_t::EN;
+    String langPackLocale;
     if (request->hasParam("locale")) {
         String s = request->getParam("locale")->value();
         s.toLowerCase();
         if (s == "de") {
             locale = AlarmMessageLocale_t::DE;
-        }
-        if (s == "fr") {
+        } else if (s == "fr") {
             locale = AlarmMessageLocale_t::FR;
+        } else if (s != "en") {
+            langPackLocale = s;
         }
     }
 
@@ -51,7 +57,12 @@ void WebApiEventlogClass::onEventlogStatus(AsyncWebServerRequest* request)
             inv->EventLog()->getLogEntry(logEntry, entry, locale);
 
             eventsObject["message_id"] = entry.MessageId;
-            eventsObject["message"] = entry.Message;
+
+            JsonVariant message = eventsObject["message"].to<JsonVariant>();
+            if (langPackLocale.length() == 0 || !I18n.getAlarmMessage(langPackLocale, entry.MessageId, message)) {
+                // static string, marked as such to be stored by reference
+                message.set(JsonString(entry.Message, true));
+            }
             eventsObject["start_time"] = entry.StartTime;
             eventsObject["end_time"] = entry.EndTime;
         }
@@ -0,0 +1,288 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "WebApi_history.h"
+#include "Configuration.h"
+#include "History.h"
+#include "HistoryLog.h"
+#include "WebApi.h"
+#include "WebApi_errors.h"
+#include "defaults.h"
+#include "helper.h"
+#include <AsyncJson.h>
+#include <cmath>
+
+void WebApiHistoryClass::init(AsyncWebServer& server, Scheduler& scheduler)
+{
+    using std::placeholders::_1;
+
+    server.on("/api/history/status", HTTP_GET, std::bind(&WebApiHistoryClass::onHistoryStatus, this, _1));
+    server.on("/api/history/log", HTTP_GET, std::bind(&WebApiHistoryClass::onHistoryLog, this, _1));
+    server.on("/api/history/config", HTTP_GET, std::bind(&WebApiHistoryClass::onHistoryAdminGet, this, _1));
+    server.on("/api/history/config", HTTP_POST, std::bind(&WebApiHistoryClass::onHistoryAdminPost, this, _1));
+}
+
+void WebApiHistoryClass::onHistoryStatus(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentialsReadonly(request)) {
+        return;
+    }
+
+    using History::Resolution;
+
+    Resolution resolution = Resolution::Raw;
+    if (request->hasParam("resolution")) {
+        String s = request->getParam("resolution")->value();
+        if (s == "1m") {
+            resolution = Resolution::OneMinute;
+        }
+        if (s == "15m") {
+            resolution = Resolution::FifteenMinutes;
+        }
+    }
+
+    String seriesFilter;
+    if (request->hasParam("series")) {
+        seriesFilter = request->getParam("series")->value();
+    }
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    auto& root = response->getRoot();
+
+    auto lock = HistoryRecorder.lock();
+
+    root["interval"] = History::Recorder::getInterval(resolution);
+    root["age"] = millis() / 1000 - HistoryRecorder.getLastSampleUptime();
+
+    JsonObject seriesObj = root["series"].to<JsonObject>();
+
+    auto addValue = [](JsonArray& arr, History::Series const& series, History::Sample sample) {
+        if (sample == History::InvalidSample) {
+            arr.add(nullptr);
+            return;
+        }
+        arr.add(series.decode(sample));
+    };
+
+    auto addAggregates = [&addValue](JsonObject& obj, History::Series const& series, auto const& buffer) {
+        JsonArray min = obj["min"].to<JsonArray>();
+        JsonArray max = obj["max"].to<JsonArray>();
+        JsonArray avg = obj["avg"].to<JsonArray>();
+        buffer.forEach([&](History::Aggregate const& aggregate) {
+            addValue(min, series, aggregate.min);
+            addValue(max, series, aggregate.max);
+            addValue(avg, series, aggregate.avg);
+        });
+    };
+
+    for (size_t i = 0; i < static_cast<size_t>(History::Recorder::SeriesId::Count); ++i) {
+        auto const& series = HistoryRecorder.getSeries(static_cast<History::Recorder::SeriesId>(i));
+        if (!seriesFilter.isEmpty() && seriesFilter != series.getName()) {
+            continue;
+        }
+
+        JsonObject obj = seriesObj[series.getName()].to<JsonObject>();
+        obj["unit"] = series.getUnit();
+
+        switch (resolution) {
+        case Resolution::Raw: {
+            JsonArray values = obj["values"].to<JsonArray>();
+            series.getRaw().forEach([&](History::Sample sample) {
+                addValue(values, series, sample);
+            });
+            break;
+        }
+        case Resolution::OneMinute:
+            addAggregates(obj, series, series.getMinutes());
+            break;
+        case Resolution::FifteenMinutes:
+            addAggregates(obj, series, series.getQuarters());
+            break;
+        }
+    }
+
+    lock.unlock();
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+}
+
+// streams the records of the on-flash log as JSON, decoding one record at
+// a time, such that the response size is not limited by available RAM.
+class HistoryLogStreamer {
+public:
+    explicit HistoryLogStreamer(std::unique_ptr<History::FlashLog::Cursor> upCursor)
+        : _upCursor(std::move(upCursor)) { }
+
+    size_t fill(uint8_t* buffer, size_t maxLen)
+    {
+        size_t written = 0;
+
+        while (written < maxLen) {
+            if (_offset >= _length && !render()) { break; }
+
+            size_t chunk = std::min(maxLen - written, _length - _offset);
+            memcpy(buffer + written, _text + _offset, chunk);
+            _offset += chunk;
+            written += chunk;
+        }
+
+        return written;
+    }
+
+private:
+    // renders the next piece of the document into _text. returns false
+    // once the document is complete.
+    bool render()
+    {
+        _offset = 0;
+        _length = 0;
+
+        if (_state == State::Header) {
+            append("{\"channels\":[\"timestamp\"");
+            for (uint8_t c = 0; c < History::FlashLog::ChannelCount; ++c) {
+                append(",\"%s\"", History::FlashLog::getChannelName(static_cast<History::FlashLog::Channel>(c)));
+            }
+            append("],\"records\":[");
+            _state = State::Records;
+            return true;
+        }
+
+        if (_state == State::Records) {
+            uint32_t timestamp;
+            History::FlashLog::Values values;
+            if (!_upCursor->next(timestamp, values)) {
+                append("]}");
+                _state = State::Done;
+                return true;
+            }
+
+            append("%s[%" PRIu32, _first ? "" : ",", timestamp);
+            for (float value : values) {
+                if (std::isnan(value)) {
+                    append(",null");
+                } else {
+                    append(",%g", value);
+                }
+            }
+            append("]");
+            _first = false;
+            return true;
+        }
+
+        return false;
+    }
+
+    template <typename... Args>
+    void append(char const* format, Args... args)
+    {
+        int res = snprintf(_text + _length, sizeof(_text) - _length, format, args...);
+        if (res > 0) { _length = std::min(sizeof(_text) - 1, _length + res); }
+    }
+
+    enum class State { Header, Records, Done };
+
+    std::unique_ptr<History::FlashLog::Cursor> _upCursor;
+    State _state = State::Header;
+    bool _first = true;
+    char _text[256];
+    size_t _length = 0;
+    size_t _offset = 0;
+};
+
+void WebApiHistoryClass::onHistoryLog(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentialsReadonly(request)) {
+        return;
+    }
+
+    uint32_t start = 0;
+    uint32_t end = UINT32_MAX;
+    if (request->hasParam("start")) {
+        start = strtoul(request->getParam("start")->value().c_str(), nullptr, 10);
+    }
+    if (request->hasParam("end")) {
+        end = strtoul(request->getParam("end")->value().c_str(), nullptr, 10);
+    }
+
+    auto spStreamer = std::make_shared<HistoryLogStreamer>(HistoryLog.query(start, end));
+
+    auto response = request->beginChunkedResponse("application/json",
+        [spStreamer](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            return spStreamer->fill(buffer, maxLen);
+        });
+
+    request->send(response);
+}
+
+void WebApiHistoryClass::onHistoryAdminGet(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentials(request)) {
+        return;
+    }
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    auto& root = response->getRoot();
+    auto const& config = Configuration.get();
+
+    root["enabled"] = config.History.Enabled;
+    root["interval"] = config.History.Interval;
+    root["max_size_kb"] = config.History.MaxSizeKb;
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+}
+
+void WebApiHistoryClass::onHistoryAdminPost(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentials(request)) {
+        return;
+    }
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    JsonDocument root;
+    if (!WebApi.parseRequestData(request, response, root)) {
+        return;
+    }
+
+    auto& retMsg = response->getRoot();
+
+    if (!(root["enabled"].is<bool>()
+            && root["interval"].is<uint32_t>()
+            && root["max_size_kb"].is<uint32_t>())) {
+        retMsg["message"] = "Values are missing!";
+        retMsg["code"] = WebApiError::GenericValueMissing;
+        WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+        return;
+    }
+
+    if (root["interval"].as<uint32_t>() < HISTORY_INTERVAL_MIN
+            || root["interval"].as<uint32_t>() > HISTORY_INTERVAL_MAX) {
+        retMsg["message"] = "Interval must be a number between " STR(HISTORY_INTERVAL_MIN) " and " STR(HISTORY_INTERVAL_MAX) "!";
+        retMsg["code"] = WebApiError::HistoryInvalidInterval;
+        retMsg["param"]["min"] = HISTORY_INTERVAL_MIN;
+        retMsg["param"]["max"] = HISTORY_INTERVAL_MAX;
+        WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+        return;
+    }
+
+    if (root["max_size_kb"].as<uint32_t>() < HISTORY_MAX_SIZE_KB_MIN
+            || root["max_size_kb"].as<uint32_t>() > HISTORY_MAX_SIZE_KB_MAX) {
+        retMsg["message"] = "Storage size must be a number between " STR(HISTORY_MAX_SIZE_KB_MIN) " and " STR(HISTORY_MAX_SIZE_KB_MAX) "!";
+        retMsg["code"] = WebApiError::HistoryInvalidMaxSize;
+        retMsg["param"]["min"] = HISTORY_MAX_SIZE_KB_MIN;
+        retMsg["param"]["max"] = HISTORY_MAX_SIZE_KB_MAX;
+        WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+        return;
+    }
+
+    {
+        auto guard = Configuration.getWriteGuard();
+        auto& config = guard.getConfig();
+        config.History.Enabled = root["enabled"].as<bool>();
+        config.History.Interval = root["interval"].as<uint32_t>();
+        config.History.MaxSizeKb = root["max_size_kb"].as<uint32_t>();
+    }
+
+    WebApi.writeConfig(retMsg);
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+
+    HistoryLog.updateSettings();
+}
@@ -80,6 +80,7 @@ void WebApiNetworkClass::onNetworkAdminGet(AsyncWebServerRequest* request)
     root["syslogenabled"] = config.Syslog.Enabled;
     root["sysloghostname"] = config.Syslog.Hostname;
     root["syslogport"] = config.Syslog.Port;
+    root["syslogusetcp"] = config.Syslog.UseTcp;
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
@@ -229,6 +230,7 @@ void WebApiNetworkClass::onNetworkAdminPost(AsyncWebServerRequest* request)
         config.Syslog.Enabled = root["syslogenabled"].as<bool>();
         strlcpy(config.Syslog.Hostname, root["sysloghostname"].as<String>().c_str(), sizeof(config.Syslog.Hostname));
         config.Syslog.Port = root["syslogport"].as<uint>();
+        config.Syslog.UseTcp = root["syslogusetcp"].as<bool>();
     }
 
     WebApi.writeConfig(retMsg);
@@ -22,6 +22,7 @@ void WebApiPowerMeterClass::init(AsyncWebServer& server, Scheduler& scheduler)
     _server = &server;
 
     _server->on("/api/powermeter/status", HTTP_GET, std::bind(&WebApiPowerMeterClass::onStatus, this, _1));
+    _server->on("/api/powermeter/samples", HTTP_GET, std::bind(&WebApiPowerMeterClass::onSamples, this, _1));
     _server->on("/api/powermeter/config", HTTP_GET, std::bind(&WebApiPowerMeterClass::onAdminGet, this, _1));
     _server->on("/api/powermeter/config", HTTP_POST, std::bind(&WebApiPowerMeterClass::onAdminPost, this, _1));
     _server->on("/api/powermeter/testhttpjsonrequest", HTTP_POST, std::bind(&WebApiPowerMeterClass::onTestHttpJsonRequest, this, _1));
@@ -57,6 +58,42 @@ void WebApiPowerMeterClass::onStatus(AsyncWebServerRequest* request)
     auto udpVictron = root["udp_victron"].to<JsonObject>();
     Configuration.serializePowerMeterUdpVictronConfig(config.PowerMeter.UdpVictron, udpVictron);
 
+    auto fusion = root["fusion"].to<JsonObject>();
+    Configuration.serializePowerMeterFusionConfig(config.PowerMeter.Fusion, fusion);
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+}
+
+void WebApiPowerMeterClass::onSamples(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentialsReadonly(request)) {
+        return;
+    }
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    auto& root = response->getRoot();
+
+    root["valid"] = PowerMeter.isDataValid();
+    root["data_age_ms"] = PowerMeter.getDataAgeMillis();
+
+    auto stats = PowerMeter.getIntervalStats();
+    auto intervals = root["intervals"].to<JsonObject>();
+    intervals["count"] = stats.count;
+    intervals["mean_ms"] = stats.mean;
+    intervals["jitter_ms"] = stats.jitter;
+    intervals["min_ms"] = stats.min;
+    intervals["max_ms"] = stats.max;
+    intervals["p90_ms"] = stats.p90;
+
+    // oldest first, the age is relative to the time of this response
+    uint32_t now = millis();
+    auto samples = root["samples"].to<JsonArray>();
+    PowerMeter.getSamples().forEach([&](::PowerMeters::Provider::Sample const& sample) {
+        auto obj = samples.add<JsonObject>();
+        obj["age_ms"] = now - sample.timestamp;
+        obj["power"] = sample.power;
+    });
+
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
 
@@ -119,7 +156,35 @@ void WebApiPowerMeterClass::onAdminPost(AsyncWebServerRequest* request)
         return true;
     };
 
-    if (static_cast<::PowerMeters::Provider::Type>(root["source"].as<uint8_t>()) == ::PowerMeters::Provider::Type::HTTP_JSON) {
+    using Type = ::PowerMeters::Provider::Type;
+    auto source = static_cast<Type>(root["source"].as<uint8_t>());
+    auto fastSource = static_cast<Type>(root["fusion"]["fast_source"].as<uint8_t>());
+    auto slowSource = static_cast<Type>(root["fusion"]["slow_source"].as<uint8_t>());
+
+    // the fusion provider uses the configuration of its two power meters
+    auto usesSource = [&](Type type) -> bool {
+        if (source == type) { return true; }
+        if (source != Type::FUSION) { return false; }
+        return fastSource == type || slowSource == type;
+    };
+
+    if (source == Type::FUSION) {
+        if (fastSource == slowSource || fastSource >= Type::FUSION || slowSource >= Type::FUSION) {
+            retMsg["message"] = "Fusion requires two different power meters!";
+            response->setLength();
+            request->send(response);
+            return;
+        }
+
+        if (root["fusion"]["correction_time_constant"].as<uint16_t>() == 0) {
+            retMsg["message"] = "Correction time constant must be greater than 0 s!";
+            response->setLength();
+            request->send(response);
+            return;
+        }
+    }
+
+    if (usesSource(Type::HTTP_JSON)) {
         JsonObject httpJson = root["http_json"];
         JsonArray valueConfigs = httpJson["values"];
         for (uint8_t i = 0; i < valueConfigs.size(); i++) {
@@ -145,14 +210,14 @@ void WebApiPowerMeterClass::onAdminPost(AsyncWebServerRequest* request)
         }
     }
 
-    if (static_cast<::PowerMeters::Provider::Type>(root["source"].as<uint8_t>()) == ::PowerMeters::Provider::Type::HTTP_SML) {
+    if (usesSource(Type::HTTP_SML)) {
         JsonObject httpSml = root["http_sml"];
         if (!checkHttpConfig(httpSml["http_request"].as<JsonObject>())) {
             return;
         }
     }
 
-    if (static_cast<::PowerMeters::Provider::Type>(root["source"].as<uint8_t>()) == ::PowerMeters::Provider::Type::UDP_VICTRON) {
+    if (usesSource(Type::UDP_VICTRON)) {
         JsonObject udpVictron = root["udp_victron"];
         if (!udpVictron["ip_address"].is<String>()
                 || udpVictron["ip_address"].as<String>().length() == 0) {
@@ -192,6 +257,9 @@ void WebApiPowerMeterClass::onAdminPost(AsyncWebServerRequest* request)
 
         Configuration.deserializePowerMeterUdpVictronConfig(root["udp_victron"].as<JsonObject>(),
                 config.PowerMeter.UdpVictron);
+
+        Configuration.deserializePowerMeterFusionConfig(root["fusion"].as<JsonObject>(),
+                config.PowerMeter.Fusion);
     }
 
     WebApi.writeConfig(retMsg);
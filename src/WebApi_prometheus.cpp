@@ -7,6 +7,9 @@
 #include "Configuration.h"
 #include "MessageOutput.h"
 #include "NetworkSettings.h"
+#include "SyslogLogger.h"
+#include <powermeter/Controller.h>
+#include "TaskProfiler.h"
 #include "WebApi.h"
 #include <Hoymiles.h>
 #include "__compiled_constants.h"
@@ -56,6 +59,10 @@ void WebApiPrometheusClass::onPrometheusMetricsGet(AsyncWebServerRequest* reques
         stream->print("# TYPE opendtu_heap_min_free gauge\n");
         stream->printf("opendtu_heap_min_free %" PRId32 "\n", ESP.getMinFreeHeap());
 
+        stream->print("# HELP opendtu_syslog_dropped_lines Log lines not sent to the syslog server due to its rate limit\n");
+        stream->print("# TYPE opendtu_syslog_dropped_lines counter\n");
+        stream->printf("opendtu_syslog_dropped_lines %" PRIu32 "\n", Syslog.getDroppedLines());
+
         stream->print("# HELP wifi_rssi WiFi RSSI\n");
         stream->print("# TYPE wifi_rssi gauge\n");
         stream->printf("wifi_rssi %" PRId8 "\n", WiFi.RSSI());
@@ -64,6 +71,65 @@ void WebApiPrometheusClass::onPrometheusMetricsGet(AsyncWebServerRequest* reques
         stream->print("# TYPE wifi_station gauge\n");
         stream->printf("wifi_station{bssid=\"%s\"} 1\n", WiFi.BSSIDstr().c_str());
 
+#ifdef TASK_PROFILER
+        auto reports = TaskProfiler.getReports();
+        reports.insert(reports.begin(), TaskProfiler.getLoopReport());
+
+        stream->print("# HELP opendtu_task_calls Executions of a scheduler task\n");
+        stream->print("# TYPE opendtu_task_calls counter\n");
+        for (auto const& report : reports) {
+            stream->printf("opendtu_task_calls{task=\"%s\"} %" PRIu32 "\n", report.name.c_str(), report.calls);
+        }
+
+        stream->print("# HELP opendtu_task_runtime_us Total execution time of a scheduler task in us\n");
+        stream->print("# TYPE opendtu_task_runtime_us counter\n");
+        for (auto const& report : reports) {
+            stream->printf("opendtu_task_runtime_us{task=\"%s\"} %" PRIu64 "\n", report.name.c_str(), report.totalUs);
+        }
+
+        stream->print("# HELP opendtu_task_runtime_max_us Longest execution of a scheduler task in us\n");
+        stream->print("# TYPE opendtu_task_runtime_max_us gauge\n");
+        for (auto const& report : reports) {
+            stream->printf("opendtu_task_runtime_max_us{task=\"%s\"} %" PRIu32 "\n", report.name.c_str(), report.maxUs);
+        }
+
+        stream->print("# HELP opendtu_task_runtime_p99_us 99th percentile of the execution time of a scheduler task in us\n");
+        stream->print("# TYPE opendtu_task_runtime_p99_us gauge\n");
+        for (auto const& report : reports) {
+            stream->printf("opendtu_task_runtime_p99_us{task=\"%s\"} %" PRIu32 "\n", report.name.c_str(), report.p99Us);
+        }
+
+        stream->print("# HELP opendtu_task_overruns Executions of a scheduler task exceeding its budget\n");
+        stream->print("# TYPE opendtu_task_overruns counter\n");
+        for (auto const& report : reports) {
+            stream->printf("opendtu_task_overruns{task=\"%s\"} %" PRIu32 "\n", report.name.c_str(), report.overruns);
+        }
+#endif
+
+        if (Configuration.get().PowerMeter.Enabled) {
+            auto stats = PowerMeter.getIntervalStats();
+
+            stream->print("# HELP opendtu_powermeter_data_age_ms Time since the last power meter reading in ms\n");
+            stream->print("# TYPE opendtu_powermeter_data_age_ms gauge\n");
+            stream->printf("opendtu_powermeter_data_age_ms %" PRIu32 "\n", PowerMeter.getDataAgeMillis());
+
+            stream->print("# HELP opendtu_powermeter_interval_mean_ms Mean time between recent power meter readings in ms\n");
+            stream->print("# TYPE opendtu_powermeter_interval_mean_ms gauge\n");
+            stream->printf("opendtu_powermeter_interval_mean_ms %f\n", stats.mean);
+
+            stream->print("# HELP opendtu_powermeter_interval_jitter_ms Standard deviation of the time between recent power meter readings in ms\n");
+            stream->print("# TYPE opendtu_powermeter_interval_jitter_ms gauge\n");
+            stream->printf("opendtu_powermeter_interval_jitter_ms %f\n", stats.jitter);
+
+            stream->print("# HELP opendtu_powermeter_interval_p90_ms 90th percentile of the time between recent power meter readings in ms\n");
+            stream->print("# TYPE opendtu_powermeter_interval_p90_ms gauge\n");
+            stream->printf("opendtu_powermeter_interval_p90_ms %" PRIu32 "\n", stats.p90);
+
+            stream->print("# HELP opendtu_powermeter_interval_max_ms Longest time between recent power meter readings in ms\n");
+            stream->print("# TYPE opendtu_powermeter_interval_max_ms gauge\n");
+            stream->printf("opendtu_powermeter_interval_max_ms %" PRIu32 "\n", stats.max);
+        }
+
         for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
             auto inv = Hoymiles.getInverterByPos(i);
 
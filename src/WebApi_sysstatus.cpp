@@ -3,10 +3,12 @@
  * Copyright (C) 2022-2024 Thomas Basler and others
  */
 #include "WebApi_sysstatus.h"
+#include "BootProfiler.h"
 #include "Configuration.h"
 #include "NetworkSettings.h"
 #include "PinMapping.h"
 #include "SerialPortManager.h"
+#include "TaskProfiler.h"
 #include "WebApi.h"
 #include "__compiled_constants.h"
 #include <AsyncJson.h>
@@ -20,6 +22,9 @@ void WebApiSysstatusClass::init(AsyncWebServer& server, Scheduler& scheduler)
     using std::placeholders::_1;
 
     server.on("/api/system/status", HTTP_GET, std::bind(&WebApiSysstatusClass::onSystemStatus, this, _1));
+#ifdef TASK_PROFILER
+    server.on("/api/system/tasks", HTTP_GET, std::bind(&WebApiSysstatusClass::onTasksStatus, this, _1));
+#endif
 }
 
 void WebApiSysstatusClass::onSystemStatus(AsyncWebServerRequest* request)
@@ -54,8 +59,8 @@ void WebApiSysstatusClass::onSystemStatus(AsyncWebServerRequest* request)
     root["flashsize"] = ESP.getFlashChipSize();
 
     JsonArray taskDetails = root["task_details"].to<JsonArray>();
-    static std::array<char const*, 13> constexpr task_names = {
-        "IDLE0", "IDLE1", "wifi", "tiT", "loopTask", "async_tcp", "mqttclient",
+    static std::array<char const*, 14> constexpr task_names = {
+        "IDLE0", "IDLE1", "wifi", "tiT", "loopTask", "realtime", "async_tcp", "mqttclient",
         "HuaweiHwIfc", "HuaweiTwai", "PM:SDM", "PM:HTTP+JSON", "PM:SML", "PM:HTTP+SML"
     };
     for (char const* task_name : task_names) {
@@ -86,6 +91,21 @@ void WebApiSysstatusClass::onSystemStatus(AsyncWebServerRequest* request)
 
     root["uptime"] = esp_timer_get_time() / 1000000;
 
+    JsonObject boot = root["boot"].to<JsonObject>();
+    JsonArray bootStages = boot["stages"].to<JsonArray>();
+    for (auto const& stage : BootProfiler.getStages()) {
+        JsonObject obj = bootStages.add<JsonObject>();
+        obj["name"] = stage.name;
+        obj["duration_us"] = stage.durationUs;
+    }
+    JsonObject milestones = boot["milestones"].to<JsonObject>();
+    for (uint8_t i = 0; i < static_cast<uint8_t>(BootProfilerClass::Milestone::Count); ++i) {
+        auto milestone = static_cast<BootProfilerClass::Milestone>(i);
+        uint32_t ms = BootProfiler.getMillis(milestone);
+        if (ms == 0) { continue; }
+        milestones[BootProfilerClass::getName(milestone)] = ms;
+    }
+
     root["nrf_configured"] = PinMapping.isValidNrf24Config();
     root["nrf_connected"] = Hoymiles.getRadioNrf()->isConnected();
     root["nrf_pvariant"] = Hoymiles.getRadioNrf()->isPVariant();
@@ -102,3 +122,35 @@ void WebApiSysstatusClass::onSystemStatus(AsyncWebServerRequest* request)
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
+
+#ifdef TASK_PROFILER
+void WebApiSysstatusClass::onTasksStatus(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentialsReadonly(request)) {
+        return;
+    }
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    auto& root = response->getRoot();
+
+    auto addReport = [](JsonObject obj, TaskProfilerClass::Report const& report) {
+        obj["name"] = report.name;
+        obj["interval"] = report.interval;
+        obj["calls"] = report.calls;
+        obj["total_us"] = report.totalUs;
+        obj["max_us"] = report.maxUs;
+        obj["p99_us"] = report.p99Us;
+        obj["overruns"] = report.overruns;
+    };
+
+    root["overrun_threshold_us"] = TaskProfilerClass::OverrunThresholdUs;
+    addReport(root["loop"].to<JsonObject>(), TaskProfiler.getLoopReport());
+
+    JsonArray tasks = root["tasks"].to<JsonArray>();
+    for (auto const& report : TaskProfiler.getReports()) {
+        addReport(tasks.add<JsonObject>(), report);
+    }
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+}
+#endif
@@ -6,6 +6,9 @@
 #include <battery/pylontech/Provider.h>
 #include <battery/pytes/Provider.h>
 #include <battery/sbs/Provider.h>
+#ifdef DPL_SIM
+#include <battery/sim/Provider.h>
+#endif
 #include <battery/victronsmartshunt/Provider.h>
 #include <battery/zendure/Provider.h>
 #include <Configuration.h>
@@ -51,6 +54,12 @@ void Controller::updateSettings()
 
     bool verboseLogging = config.Battery.VerboseLogging;
 
+#ifdef DPL_SIM
+    _upProvider = std::make_unique<Sim::Provider>();
+    _upProvider->init(verboseLogging);
+    return;
+#endif
+
     switch (config.Battery.Provider) {
         case 0:
             _upProvider = std::make_unique<Pylontech::Provider>();
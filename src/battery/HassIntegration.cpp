@@ -6,6 +6,7 @@
 #include <Configuration.h>
 #include <MqttSettings.h>
 #include <MqttHandleHass.h>
+#include <MqttHassRegistry.h>
 #include <Utils.h>
 #include <__compiled_constants.h>
 
@@ -26,11 +27,20 @@ void HassIntegration::hassLoop()
         return;
     }
 
+    using Owner = MqttHassRegistryClass::Owner;
+    if (MqttHassRegistry.isReady() &&
+            (MqttHassRegistry.takeDeferred(Owner::Battery) ||
+             MqttHassRegistry.takeInvalidated(Owner::Battery))) {
+        _publishSensors = true;
+    }
+
     if (!_publishSensors ||
         !_spStats->getManufacturer().has_value() ||
         !_spStats->getHassDeviceName().has_value()) { return; }
 
+    MqttHassRegistry.beginRound(MqttHassRegistryClass::Owner::Battery);
     publishSensors();
+    MqttHassRegistry.endRound(MqttHassRegistryClass::Owner::Battery);
 
     _publishSensors = false;
 }
@@ -159,9 +169,7 @@ void HassIntegration::createDeviceInfo(JsonObject& object) const
 
 void HassIntegration::publish(const String& subtopic, const String& payload) const
 {
-    String topic = Configuration.get().Mqtt.Hass.Topic;
-    topic += subtopic;
-    MqttSettings.publishGeneric(topic.c_str(), payload.c_str(), Configuration.get().Mqtt.Hass.Retain);
+    MqttHassRegistry.publish(MqttHassRegistryClass::Owner::Battery, subtopic, payload);
 }
 
 String HassIntegration::sanitizeUniqueId(const char* value) {
@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#ifdef DPL_SIM
+
+#include <battery/sim/Provider.h>
+#include <PowerLimiterSim.h>
+
+namespace Batteries::Sim {
+
+bool Provider::init(bool)
+{
+    _stats->setManufacturer("DPL simulation");
+    return true;
+}
+
+void Provider::loop()
+{
+    // a BMS reports about once per second
+    if ((millis() - _lastUpdate) < 1000) { return; }
+    _lastUpdate = millis();
+
+    _stats->setSoC(PowerLimiterSim.getBatterySoC(), 1/*precision*/, _lastUpdate);
+    _stats->setVoltage(PowerLimiterSim.getBatteryVoltage(), _lastUpdate);
+    _stats->setCurrent(PowerLimiterSim.getBatteryCurrent(), 1/*precision*/, _lastUpdate);
+}
+
+} // namespace Batteries::Sim
+
+#endif // DPL_SIM
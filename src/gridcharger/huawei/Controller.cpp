@@ -160,9 +160,9 @@ void Controller::loop()
     }
 
     if (_batteryEmergencyCharging && !stats->getImmediateChargingRequest()) {
-        // Battery request has changed. Set current to 0, wait for PSU to respond and then clear state
-        // TODO(schlimmchen): this is repeated very often for up to (polling interval) seconds. maybe
-        // trigger sending request for data immediately? otherwise implement a backoff instead.
+        // Battery request has changed. Set current to 0, wait for PSU to respond and then clear state.
+        // this is repeated until the PSU reports a low output current. the hardware interface
+        // suppresses the redundant writes, so only the first one is actually put on the bus.
         _setParameter(0, Setting::OnlineCurrent);
         if (oOutputCurrent && *oOutputCurrent < 1) {
             _batteryEmergencyCharging = false;
@@ -386,6 +386,16 @@ void Controller::getJsonData(JsonVariant& root) const
         root["efficiency"]["v"] = *_dataPoints.get<Label::Efficiency>() * 100;
         root["efficiency"]["u"] = oEfficiency->getUnitText();
     }
+
+    if (_upHardwareInterface) {
+        auto txStats = _upHardwareInterface->getTxStats();
+        auto can = root["can_tx"].to<JsonObject>();
+        can["pending"] = txStats.pending;
+        can["sent"] = txStats.sent;
+        can["suppressed"] = txStats.suppressed;
+        can["coalesced"] = txStats.coalesced;
+        can["failed"] = txStats.failed;
+    }
 }
 
 } // namespace GridCharger::Huawei
@@ -117,21 +117,31 @@ void HardwareInterface::loop()
         }
     }
 
-    size_t queueSize = _sendQueue.size();
-    for (size_t i = 0; i < queueSize; ++i) {
-        auto [setting, val] = _sendQueue.front();
-        _sendQueue.pop();
+    for (size_t i = 0; i < SettingCount; ++i) {
+        auto& state = _settings[i];
+        if (!state.pending) { continue; }
+
+        // rate limit: a newer value is kept pending until it's time to send
+        if (state.lastSent && millis() - state.lastSentMillis < MinSendIntervalMillis) { continue; }
+
+        uint16_t val = *state.pending;
 
         std::array<uint8_t, 8> data = {
-            0x01, static_cast<uint8_t>(setting), 0x00, 0x00,
+            0x01, static_cast<uint8_t>(settingByIndex(i)), 0x00, 0x00,
             0x00, 0x00, static_cast<uint8_t>((val & 0xFF00) >> 8),
             static_cast<uint8_t>(val & 0xFF)
         };
 
         if (!sendMessage(0x108180FE, data)) {
             MessageOutput.print("[Huawei::HwIfc] Failed to set parameter\r\n");
-            _sendQueue.push({setting, val});
+            ++_txStats.failed;
+            continue; // try again in the next iteration
         }
+
+        state.pending = std::nullopt;
+        state.lastSent = val;
+        state.lastSentMillis = millis();
+        ++_txStats.sent;
     }
 
     if (_nextRequestMillis < millis()) {
@@ -168,12 +178,62 @@ void HardwareInterface::setParameter(HardwareInterface::Setting setting, float v
             break;
     }
 
-    _sendQueue.push({setting, static_cast<uint16_t>(val)});
+    uint16_t encoded = static_cast<uint16_t>(val);
+    auto& state = _settings[settingIndex(setting)];
+
+    if (state.pending && *state.pending == encoded) {
+        ++_txStats.suppressed;
+        return;
+    }
+
+    if (state.pending) { ++_txStats.coalesced; }
+
+    if (state.lastSent && *state.lastSent == encoded &&
+            millis() - state.lastSentMillis < RepeatIntervalMillis) {
+        // the PSU already uses this value, discard a pending other value
+        state.pending = std::nullopt;
+        ++_txStats.suppressed;
+        return;
+    }
+
+    state.pending = encoded;
     _nextRequestMillis = millis() - 1; // request param feedback immediately
 
     xTaskNotifyGive(_taskHandle);
 }
 
+size_t HardwareInterface::settingIndex(Setting setting)
+{
+    switch (setting) {
+        case Setting::OnlineVoltage: return 0;
+        case Setting::OfflineVoltage: return 1;
+        case Setting::OnlineCurrent: return 2;
+        case Setting::OfflineCurrent: return 3;
+    }
+    return 0;
+}
+
+HardwareInterface::Setting HardwareInterface::settingByIndex(size_t idx)
+{
+    static std::array<Setting, SettingCount> constexpr settings = {
+        Setting::OnlineVoltage, Setting::OfflineVoltage,
+        Setting::OnlineCurrent, Setting::OfflineCurrent
+    };
+    return settings[idx];
+}
+
+HardwareInterface::TxStats HardwareInterface::getTxStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    TxStats stats = _txStats;
+    stats.pending = 0;
+    for (auto const& state : _settings) {
+        if (state.pending) { ++stats.pending; }
+    }
+    return stats;
+}
+
 std::unique_ptr<DataPointContainer> HardwareInterface::getCurrentData()
 {
     std::unique_ptr<DataPointContainer> upData = nullptr;
@@ -2,9 +2,12 @@
 /*
  * Copyright (C) 2022-2024 Thomas Basler and others
  */
+#include "BootProfiler.h"
 #include "Configuration.h"
 #include "Datastore.h"
 #include "Display_Graphic.h"
+#include "History.h"
+#include "HistoryLog.h"
 #include "I18n.h"
 #include "InverterSettings.h"
 #include "Led_Single.h"
@@ -14,6 +17,7 @@
 #include <gridcharger/huawei/Controller.h>
 #include "MqttHandleDtu.h"
 #include "MqttHandleHass.h"
+#include "MqttHassRegistry.h"
 #include "MqttHandleInverter.h"
 #include "MqttHandleInverterTotal.h"
 #include "MqttHandleHuawei.h"
@@ -23,13 +27,18 @@
 #include "NetworkSettings.h"
 #include "NtpSettings.h"
 #include "PinMapping.h"
+#include "RealtimeScheduler.h"
 #include "RestartHelper.h"
 #include "Scheduler.h"
 #include "SunPosition.h"
+#include "TaskProfiler.h"
 #include "Utils.h"
 #include "WebApi.h"
 #include <powermeter/Controller.h>
 #include "PowerLimiter.h"
+#ifdef DPL_SIM
+#include "PowerLimiterSim.h"
+#endif
 #include "defaults.h"
 #include <solarcharger/Controller.h>
 #include <Arduino.h>
@@ -37,6 +46,17 @@
 #include <SpiManager.h>
 #include <TaskScheduler.h>
 #include <esp_heap_caps.h>
+#include <functional>
+
+// runs one initialization step of the setup. the tasks the step adds to
+// the main scheduler are named after it for the task profiler and the time
+// it took is recorded as a boot stage.
+static void initStage(char const* name, std::function<void()> const& init)
+{
+    init();
+    TaskProfiler.nameNewTasks(scheduler, name);
+    BootProfiler.endStage(name);
+}
 
 void setup()
 {
@@ -50,134 +70,172 @@ void setup()
 #endif
 
     // Initialize serial output
-    Serial.begin(SERIAL_BAUDRATE);
+    initStage("MessageOutput", [] {
+        Serial.begin(SERIAL_BAUDRATE);
 #if !ARDUINO_USB_CDC_ON_BOOT
-    // Only wait for serial interface to be set up when not using CDC
-    while (!Serial)
-        yield();
+        // Only wait for serial interface to be set up when not using CDC
+        while (!Serial)
+            yield();
 #endif
-    MessageOutput.init(scheduler);
-    MessageOutput.println();
-    MessageOutput.println("Starting OpenDTU");
+        MessageOutput.init(scheduler);
+        MessageOutput.println();
+        MessageOutput.println("Starting OpenDTU");
+    });
 
     // Initialize file system
-    MessageOutput.print("Initialize FS... ");
-    if (!LittleFS.begin(false)) { // Do not format if mount failed
-        MessageOutput.print("failed... trying to format...");
-        if (!LittleFS.begin(true)) {
-            MessageOutput.print("success");
+    initStage("FS", [] {
+        MessageOutput.print("Initialize FS... ");
+        if (!LittleFS.begin(false)) { // Do not format if mount failed
+            MessageOutput.print("failed... trying to format...");
+            if (!LittleFS.begin(true)) {
+                MessageOutput.print("success");
+            } else {
+                MessageOutput.print("failed");
+            }
         } else {
-            MessageOutput.print("failed");
+            MessageOutput.println("done");
         }
-    } else {
-        MessageOutput.println("done");
-    }
+    });
 
     // Read configuration values
-    Configuration.init(scheduler);
-    MessageOutput.print("Reading configuration... ");
-    if (!Configuration.read()) {
-        if (Configuration.write()) {
-            MessageOutput.print("written... ");
-        } else {
-            MessageOutput.print("failed... ");
+    initStage("Configuration", [] {
+        Configuration.init(scheduler);
+        MessageOutput.print("Reading configuration... ");
+        if (!Configuration.read()) {
+            if (Configuration.write()) {
+                MessageOutput.print("written... ");
+            } else {
+                MessageOutput.print("failed... ");
+            }
+        }
+        if (Configuration.get().Cfg.Version != CONFIG_VERSION) {
+            MessageOutput.print("migrated... ");
+            Configuration.migrate();
         }
-    }
-    if (Configuration.get().Cfg.Version != CONFIG_VERSION) {
-        MessageOutput.print("migrated... ");
-        Configuration.migrate();
-    }
-    if (Configuration.get().Cfg.VersionOnBattery != CONFIG_VERSION_ONBATTERY) {
-        Configuration.migrateOnBattery();
-        MessageOutput.print("migrated OpenDTU-OnBattery-specific config... ");
-    }
+        if (Configuration.get().Cfg.VersionOnBattery != CONFIG_VERSION_ONBATTERY) {
+            Configuration.migrateOnBattery();
+            MessageOutput.print("migrated OpenDTU-OnBattery-specific config... ");
+        }
+        MessageOutput.println("done");
+    });
     auto& config = Configuration.get();
-    MessageOutput.println("done");
 
     // Read languate pack
-    MessageOutput.print("Reading language pack... ");
-    I18n.init(scheduler);
-    MessageOutput.println("done");
+    initStage("I18n", [] {
+        MessageOutput.print("Reading language pack... ");
+        I18n.init(scheduler);
+        MessageOutput.println("done");
+    });
 
     // Load PinMapping
-    MessageOutput.print("Reading PinMapping... ");
-    if (PinMapping.init(Configuration.get().Dev_PinMapping)) {
-        MessageOutput.print("found valid mapping ");
-    } else {
-        MessageOutput.print("using default config ");
-    }
+    initStage("PinMapping", [] {
+        MessageOutput.print("Reading PinMapping... ");
+        if (PinMapping.init(Configuration.get().Dev_PinMapping)) {
+            MessageOutput.print("found valid mapping ");
+        } else {
+            MessageOutput.print("using default config ");
+        }
+        MessageOutput.println("done");
+    });
     const auto& pin = PinMapping.get();
-    MessageOutput.println("done");
 
     SerialPortManager.init();
 
     // Initialize Network
-    MessageOutput.print("Initialize Network... ");
-    NetworkSettings.init(scheduler);
-    MessageOutput.println("done");
-    NetworkSettings.applyConfig();
+    initStage("NetworkSettings", [] {
+        MessageOutput.print("Initialize Network... ");
+        NetworkSettings.init(scheduler);
+        MessageOutput.println("done");
+        NetworkSettings.applyConfig();
+    });
 
     // Initialize NTP
-    MessageOutput.print("Initialize NTP... ");
-    NtpSettings.init();
-    MessageOutput.println("done");
+    initStage("NTP", [] {
+        MessageOutput.print("Initialize NTP... ");
+        NtpSettings.init();
+        MessageOutput.println("done");
+    });
 
     // Initialize SunPosition
-    MessageOutput.print("Initialize SunPosition... ");
-    SunPosition.init(scheduler);
-    MessageOutput.println("done");
+    initStage("SunPosition", [] {
+        MessageOutput.print("Initialize SunPosition... ");
+        SunPosition.init(scheduler);
+        MessageOutput.println("done");
+    });
 
     // Initialize MqTT
     MessageOutput.print("Initialize MqTT... ");
-    MqttSettings.init();
-    MqttHandleDtu.init(scheduler);
-    MqttHandleInverter.init(scheduler);
-    MqttHandleInverterTotal.init(scheduler);
-    MqttHandleHass.init(scheduler);
-    MqttHandleHuawei.init(scheduler);
-    MqttHandlePowerLimiter.init(scheduler);
-    MqttHandlePowerLimiterHass.init(scheduler);
+    initStage("MqttSettings", [] { MqttSettings.init(); });
+    initStage("MqttHandleDtu", [] { MqttHandleDtu.init(scheduler); });
+    initStage("MqttHandleInverter", [] { MqttHandleInverter.init(scheduler); });
+    initStage("MqttHandleInverterTotal", [] { MqttHandleInverterTotal.init(scheduler); });
+    initStage("MqttHassRegistry", [] { MqttHassRegistry.init(); });
+    initStage("MqttHandleHass", [] { MqttHandleHass.init(scheduler); });
+    initStage("MqttHandleHuawei", [] { MqttHandleHuawei.init(scheduler); });
+    initStage("MqttHandlePowerLimiter", [] { MqttHandlePowerLimiter.init(scheduler); });
+    initStage("MqttHandlePowerLimiterHass", [] { MqttHandlePowerLimiterHass.init(scheduler); });
     MessageOutput.println("done");
 
     // Initialize WebApi
-    MessageOutput.print("Initialize WebApi... ");
-    WebApi.init(scheduler);
-    MessageOutput.println("done");
+    initStage("WebApi", [] {
+        MessageOutput.print("Initialize WebApi... ");
+        WebApi.init(scheduler);
+        MessageOutput.println("done");
+    });
 
     // Initialize Display
-    MessageOutput.print("Initialize Display... ");
-    Display.init(
-        scheduler,
-        static_cast<DisplayType_t>(pin.display_type),
-        pin.display_data,
-        pin.display_clk,
-        pin.display_cs,
-        pin.display_reset);
-    Display.setDiagramMode(static_cast<DiagramMode_t>(config.Display.Diagram.Mode));
-    Display.setOrientation(config.Display.Rotation);
-    Display.enablePowerSafe = config.Display.PowerSafe;
-    Display.enableScreensaver = config.Display.ScreenSaver;
-    Display.setContrast(config.Display.Contrast);
-    Display.setLocale(config.Display.Locale);
-    Display.setStartupDisplay();
-    MessageOutput.println("done");
+    initStage("Display", [&] {
+        MessageOutput.print("Initialize Display... ");
+        Display.init(
+            scheduler,
+            static_cast<DisplayType_t>(pin.display_type),
+            pin.display_data,
+            pin.display_clk,
+            pin.display_cs,
+            pin.display_reset);
+        Display.setDiagramMode(static_cast<DiagramMode_t>(config.Display.Diagram.Mode));
+        Display.setOrientation(config.Display.Rotation);
+        Display.enablePowerSafe = config.Display.PowerSafe;
+        Display.enableScreensaver = config.Display.ScreenSaver;
+        Display.setContrast(config.Display.Contrast);
+        Display.setLocale(config.Display.Locale);
+        Display.setStartupDisplay();
+        MessageOutput.println("done");
+    });
 
     // Initialize Single LEDs
-    MessageOutput.print("Initialize LEDs... ");
-    LedSingle.init(scheduler);
-    MessageOutput.println("done");
-
-    InverterSettings.init(scheduler);
+    initStage("LedSingle", [] {
+        MessageOutput.print("Initialize LEDs... ");
+        LedSingle.init(scheduler);
+        MessageOutput.println("done");
+    });
 
-    Datastore.init(scheduler);
-    RestartHelper.init(scheduler);
+    initStage("InverterSettings", [] { InverterSettings.init(scheduler, RealtimeScheduler.get()); });
+    initStage("Datastore", [] { Datastore.init(scheduler); });
+    initStage("RestartHelper", [] { RestartHelper.init(scheduler); });
 
     // OpenDTU-OnBattery-specific initializations go below
-    SolarCharger.init(scheduler);
-    PowerMeter.init(scheduler);
-    PowerLimiter.init(scheduler);
-    HuaweiCan.init(scheduler);
-    Battery.init(scheduler);
+    initStage("SolarCharger", [] { SolarCharger.init(scheduler); });
+    initStage("PowerMeter", [] { PowerMeter.init(scheduler); });
+    initStage("HuaweiCan", [] { HuaweiCan.init(scheduler); });
+    initStage("Battery", [] { Battery.init(scheduler); });
+    initStage("PowerLimiter", [] { PowerLimiter.init(RealtimeScheduler.get()); });
+#ifdef DPL_SIM
+    initStage("PowerLimiterSim", [] { PowerLimiterSim.init(RealtimeScheduler.get()); });
+#endif
+
+    // everything the DPL depends on is initialized, so the radio and the
+    // DPL may start if they run on a core of their own, while the remaining
+    // modules are still being initialized.
+    RealtimeScheduler.init();
+
+    initStage("HistoryRecorder", [] { HistoryRecorder.init(scheduler); });
+    initStage("HistoryLog", [] { HistoryLog.init(scheduler); });
+
+    TaskProfiler.init(scheduler);
+
+    BootProfiler.reach(BootProfilerClass::Milestone::SetupDone);
+    BootProfiler.printSummary();
 }
 
 void loop()
@@ -1,11 +1,15 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #include <powermeter/Controller.h>
 #include <Configuration.h>
+#include <powermeter/fusion/Provider.h>
 #include <powermeter/json/http/Provider.h>
 #include <powermeter/json/mqtt/Provider.h>
 #include <powermeter/sdm/serial/Provider.h>
 #include <powermeter/sml/http/Provider.h>
 #include <powermeter/sml/serial/Provider.h>
+#ifdef DPL_SIM
+#include <powermeter/sim/Provider.h>
+#endif
 #include <powermeter/udp/smahm/Provider.h>
 #include <powermeter/udp/victron/Provider.h>
 
@@ -33,38 +37,47 @@ void Controller::updateSettings()
 
     if (!pmcfg.Enabled) { return; }
 
-    switch(static_cast<Provider::Type>(pmcfg.Source)) {
+#ifdef DPL_SIM
+    _upProvider = std::make_unique<::PowerMeters::Sim::Provider>();
+    _upProvider->init();
+    return;
+#endif
+
+    _upProvider = createProvider(static_cast<Provider::Type>(pmcfg.Source));
+
+    if (!_upProvider || !_upProvider->init()) {
+        _upProvider = nullptr;
+    }
+}
+
+std::unique_ptr<Provider> Controller::createProvider(Provider::Type type)
+{
+    auto const& pmcfg = Configuration.get().PowerMeter;
+
+    switch(type) {
         case Provider::Type::MQTT:
-            _upProvider = std::make_unique<::PowerMeters::Json::Mqtt::Provider>(pmcfg.Mqtt);
-            break;
+            return std::make_unique<::PowerMeters::Json::Mqtt::Provider>(pmcfg.Mqtt);
         case Provider::Type::SDM1PH:
-            _upProvider = std::make_unique<::PowerMeters::Sdm::Serial::Provider>(
+            return std::make_unique<::PowerMeters::Sdm::Serial::Provider>(
                     ::PowerMeters::Sdm::Serial::Provider::Phases::One, pmcfg.SerialSdm);
-            break;
         case Provider::Type::SDM3PH:
-            _upProvider = std::make_unique<::PowerMeters::Sdm::Serial::Provider>(
+            return std::make_unique<::PowerMeters::Sdm::Serial::Provider>(
                     ::PowerMeters::Sdm::Serial::Provider::Phases::Three, pmcfg.SerialSdm);
-            break;
         case Provider::Type::HTTP_JSON:
-            _upProvider = std::make_unique<::PowerMeters::Json::Http::Provider>(pmcfg.HttpJson);
-            break;
+            return std::make_unique<::PowerMeters::Json::Http::Provider>(pmcfg.HttpJson);
         case Provider::Type::SERIAL_SML:
-            _upProvider = std::make_unique<::PowerMeters::Sml::Serial::Provider>();
-            break;
+            return std::make_unique<::PowerMeters::Sml::Serial::Provider>();
         case Provider::Type::SMAHM2:
-            _upProvider = std::make_unique<::PowerMeters::Udp::SmaHM::Provider>();
-            break;
+            return std::make_unique<::PowerMeters::Udp::SmaHM::Provider>();
         case Provider::Type::HTTP_SML:
-            _upProvider = std::make_unique<::PowerMeters::Sml::Http::Provider>(pmcfg.HttpSml);
-            break;
+            return std::make_unique<::PowerMeters::Sml::Http::Provider>(pmcfg.HttpSml);
         case Provider::Type::UDP_VICTRON:
-            _upProvider = std::make_unique<::PowerMeters::Udp::Victron::Provider>(pmcfg.UdpVictron);
-            break;
+            return std::make_unique<::PowerMeters::Udp::Victron::Provider>(pmcfg.UdpVictron);
+        case Provider::Type::FUSION:
+            return std::make_unique<::PowerMeters::Fusion::Provider>(pmcfg.Fusion);
     }
 
-    if (!_upProvider->init()) {
-        _upProvider = nullptr;
-    }
+    return nullptr;
 }
 
 float Controller::getPowerTotal() const
@@ -88,6 +101,20 @@ bool Controller::isDataValid() const
     return _upProvider->isDataValid();
 }
 
+Provider::SampleHistory Controller::getSamples() const
+{
+    std::lock_guard<std::mutex> l(_mutex);
+    if (!_upProvider) { return {}; }
+    return _upProvider->getSamples();
+}
+
+Provider::IntervalStats Controller::getIntervalStats() const
+{
+    std::lock_guard<std::mutex> l(_mutex);
+    if (!_upProvider) { return {}; }
+    return _upProvider->getIntervalStats();
+}
+
 void Controller::loop()
 {
     std::lock_guard<std::mutex> lock(_mutex);
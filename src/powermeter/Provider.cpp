@@ -1,6 +1,9 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #include <powermeter/Provider.h>
 #include <MqttSettings.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
 
 namespace PowerMeters {
 
@@ -19,6 +22,60 @@ float Provider::getPowerTotal() const
         + _dataCurrent.get<DataPointLabel::PowerL3>().value_or(0.0f);
 }
 
+void Provider::recordSample()
+{
+    float power = getPowerTotal();
+
+    std::lock_guard<std::mutex> lock(_samplesMutex);
+    _samples.push({ millis(), power });
+}
+
+Provider::SampleHistory Provider::getSamples() const
+{
+    std::lock_guard<std::mutex> lock(_samplesMutex);
+    return _samples;
+}
+
+Provider::IntervalStats Provider::getIntervalStats() const
+{
+    std::lock_guard<std::mutex> lock(_samplesMutex);
+
+    IntervalStats stats;
+    if (_samples.size() < 2) { return stats; }
+
+    stats.count = _samples.size() - 1;
+    stats.min = std::numeric_limits<uint32_t>::max();
+
+    auto interval = [this](size_t i) -> uint32_t {
+        return _samples[i].timestamp - _samples[i - 1].timestamp;
+    };
+
+    float sum = 0;
+    for (size_t i = 1; i < _samples.size(); ++i) {
+        stats.min = std::min(stats.min, interval(i));
+        stats.max = std::max(stats.max, interval(i));
+        sum += interval(i);
+    }
+    stats.mean = sum / stats.count;
+
+    float squares = 0;
+    for (size_t i = 1; i < _samples.size(); ++i) {
+        float deviation = interval(i) - stats.mean;
+        squares += deviation * deviation;
+    }
+    stats.jitter = std::sqrt(squares / stats.count);
+
+    std::array<uint32_t, SampleHistorySize - 1> intervals;
+    for (size_t i = 1; i < _samples.size(); ++i) {
+        intervals[i - 1] = interval(i);
+    }
+    auto nth = intervals.begin() + (stats.count * 9 + 9) / 10 - 1;
+    std::nth_element(intervals.begin(), nth, intervals.begin() + stats.count);
+    stats.p90 = *nth;
+
+    return stats;
+}
+
 void Provider::mqttLoop() const
 {
     if (!MqttSettings.getConnected()) { return; }
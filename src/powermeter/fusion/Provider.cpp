@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include <powermeter/fusion/Provider.h>
+#include <powermeter/Controller.h>
+#include <MessageOutput.h>
+#include <algorithm>
+#include <cmath>
+
+namespace PowerMeters::Fusion {
+
+Provider::Provider(PowerMeterFusionConfig const& cfg)
+    : _cfg(cfg)
+{
+}
+
+bool Provider::init()
+{
+    using Type = ::PowerMeters::Provider::Type;
+    auto fast = static_cast<Type>(_cfg.FastSource);
+    auto slow = static_cast<Type>(_cfg.SlowSource);
+
+    if (fast == slow || fast == Type::FUSION || slow == Type::FUSION) {
+        MessageOutput.printf("[PowerMeters::Fusion] invalid power meters %u and %u\r\n",
+                static_cast<unsigned>(_cfg.FastSource), static_cast<unsigned>(_cfg.SlowSource));
+        return false;
+    }
+
+    _upFast = Controller::createProvider(fast);
+    _upSlow = Controller::createProvider(slow);
+
+    if (!_upFast || !_upFast->init()) {
+        MessageOutput.println("[PowerMeters::Fusion] fast power meter failed to initialize");
+        return false;
+    }
+
+    if (!_upSlow || !_upSlow->init()) {
+        MessageOutput.println("[PowerMeters::Fusion] slow power meter failed to initialize");
+        return false;
+    }
+
+    return true;
+}
+
+void Provider::loop()
+{
+    _upFast->loop();
+    _upSlow->loop();
+
+    if (_upFast->getLastUpdate() != _lastFastUpdate && _upFast->isDataValid()) {
+        onFastUpdate();
+    }
+
+    if (_upSlow->getLastUpdate() != _lastSlowUpdate && _upSlow->isDataValid()) {
+        onSlowUpdate();
+    }
+}
+
+bool Provider::isDataValid() const
+{
+    return ::PowerMeters::Provider::isDataValid()
+        && (_upFast->isDataValid() || _upSlow->isDataValid());
+}
+
+void Provider::onFastUpdate()
+{
+    _lastFastUpdate = _upFast->getLastUpdate();
+
+    float power = _upFast->getPowerTotal();
+
+    float fused = power + _oOffset.value_or(0);
+    _dataCurrent.add<DataPointLabel::PowerTotal>(fused);
+    recordSample();
+
+    if (_verboseLogging) {
+        MessageOutput.printf("[PowerMeters::Fusion] fast meter %.1f W, offset %.1f W, "
+                "reporting %.1f W\r\n", power, _oOffset.value_or(0), fused);
+    }
+}
+
+void Provider::onSlowUpdate()
+{
+    uint32_t previous = _lastSlowUpdate;
+    _lastSlowUpdate = _upSlow->getLastUpdate();
+
+    float power = _upSlow->getPowerTotal();
+
+    // the slow meter's reading is compared with the fast meter's readings
+    // taken in the same period of time.
+    uint32_t window = MaxAlignmentWindowMillis;
+    if (previous != 0) { window = std::min(window, _lastSlowUpdate - previous); }
+
+    auto oReference = getFastAverage(_lastSlowUpdate - window, _lastSlowUpdate);
+    if (oReference) {
+        float error = power - *oReference;
+
+        if (!_oOffset) {
+            _oOffset = error;
+        } else {
+            float tau = _cfg.CorrectionTimeConstant * 1000.0f;
+            float alpha = 1 - std::exp(-(window / tau));
+            *_oOffset += alpha * (error - *_oOffset);
+        }
+    }
+
+    if (_verboseLogging) {
+        MessageOutput.printf("[PowerMeters::Fusion] slow meter %.1f W, fast meter "
+                "average %.1f W, offset %.1f W\r\n", power, oReference.value_or(NAN),
+                _oOffset.value_or(0));
+    }
+
+    // fall back to the slow meter while the fast one does not deliver
+    if (!_upFast->isDataValid() || _lastSlowUpdate - _lastFastUpdate > FastMeterTimeoutMillis) {
+        _dataCurrent.add<DataPointLabel::PowerTotal>(power);
+        recordSample();
+    }
+}
+
+std::optional<float> Provider::getFastAverage(uint32_t from, uint32_t to) const
+{
+    auto samples = _upFast->getSamples();
+    if (samples.size() < 2) { return std::nullopt; }
+
+    float sum = 0;
+    size_t count = 0;
+    uint32_t first = to;
+    uint32_t last = from;
+
+    samples.forEach([&](Sample const& sample) {
+        // unsigned arithmetic handles millis() rollover
+        if (sample.timestamp - from > to - from) { return; }
+        if (count == 0) { first = sample.timestamp; }
+        last = sample.timestamp;
+        sum += sample.power;
+        ++count;
+    });
+
+    // the readings must cover the whole period, otherwise a change of the
+    // load while the fast meter did not update would be mistaken for an
+    // offset. the fast meter's usual update interval is tolerated.
+    uint32_t interval = _upFast->getIntervalStats().p90;
+    uint32_t tolerance = interval + interval / 2;
+    if (count == 0 || first - from > tolerance || to - last > tolerance) {
+        return std::nullopt;
+    }
+
+    return sum / count;
+}
+
+} // namespace PowerMeters::Fusion
@@ -99,6 +99,8 @@ void Provider::pollingLoop()
             continue;
         }
 
+        recordSample();
+
         MessageOutput.printf("[PowerMeters::Json::Http] New total: %.2f\r\n", getPowerTotal());
     }
 }
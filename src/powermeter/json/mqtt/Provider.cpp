@@ -12,14 +12,15 @@ bool Provider::init()
     auto subscribe = [this](PowerMeterMqttValue const& val, uint8_t phaseIndex) {
         char const* topic = val.Topic;
         if (strlen(topic) == 0) { return; }
-        MqttSettings.subscribe(topic, 0,
+        auto handle = MqttSettings.subscribe(topic, 0,
                 std::bind(&Provider::onMessage,
                     this, std::placeholders::_1, std::placeholders::_2,
                     std::placeholders::_3, std::placeholders::_4,
                     std::placeholders::_5, std::placeholders::_6,
                     phaseIndex, &val)
                 );
-        _mqttSubscriptions.push_back(topic);
+        if (handle == MqttSubscribeParser::invalid_handle) { return; }
+        _mqttSubscriptions.push_back(handle);
     };
 
     for (uint8_t i = 0; i < POWERMETER_MQTT_MAX_VALUES; ++i) {
@@ -31,7 +32,7 @@ bool Provider::init()
 
 Provider::~Provider()
 {
-    for (auto const& t: _mqttSubscriptions) { MqttSettings.unsubscribe(t); }
+    for (auto const& h: _mqttSubscriptions) { MqttSettings.unsubscribe(h); }
     _mqttSubscriptions.clear();
 }
 
@@ -81,6 +82,8 @@ void Provider::onMessage(Provider::MsgProperties const& properties,
         }
     }
 
+    recordSample();
+
     if (_verboseLogging) {
         MessageOutput.printf("[PowerMeters::Json::Mqtt] Topic '%s': new value: %5.2f, "
                 "total: %5.2f\r\n", topic, newValue, getPowerTotal());
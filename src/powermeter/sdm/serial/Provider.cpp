@@ -199,6 +199,8 @@ void Provider::pollingLoop()
             }
         }
 
+        recordSample();
+
         MessageOutput.printf("[PowerMeters::Sdm::Serial] TotalPower: %5.2f\r\n", getPowerTotal());
     }
 }
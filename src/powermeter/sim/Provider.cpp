@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#ifdef DPL_SIM
+
+#include <powermeter/sim/Provider.h>
+#include <PowerLimiterSim.h>
+#include <MessageOutput.h>
+
+namespace PowerMeters::Sim {
+
+void Provider::loop()
+{
+    auto oReading = PowerLimiterSim.getMeterReading();
+    if (!oReading) { return; }
+
+    _dataCurrent.add<DataPointLabel::PowerTotal>(*oReading);
+    recordSample();
+
+    if (_verboseLogging) {
+        MessageOutput.printf("[PowerMeters::Sim] %.1f W\r\n", *oReading);
+    }
+}
+
+} // namespace PowerMeters::Sim
+
+#endif // DPL_SIM
@@ -82,6 +82,7 @@ void Provider::processSmlByte(uint8_t byte)
             break;
         case SML_FINAL:
             _dataCurrent.updateFrom(_dataInFlight);
+            recordSample();
             reset();
             MessageOutput.printf("[%s] TotalPower: %5.2f\r\n",
                     _user.c_str(), getPowerTotal());
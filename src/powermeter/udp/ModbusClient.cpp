@@ -0,0 +1,242 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include <powermeter/udp/ModbusClient.h>
+#include <Arduino.h>
+#include <MessageOutput.h>
+#include <algorithm>
+
+namespace PowerMeters::Udp {
+
+static constexpr uint8_t sFunctionReadHoldingRegisters = 0x03;
+static constexpr uint8_t sExceptionFlag = 0x80;
+static constexpr size_t sMbapHeaderSize = 7; // including the unit ID
+
+// used until the first response was received
+static constexpr uint32_t sInitialTimeoutMicros = 1000 * 1000;
+
+static uint16_t read16(uint8_t const* p)
+{
+    return (p[0] << 8) | p[1];
+}
+
+static void write16(uint8_t* p, uint16_t value)
+{
+    p[0] = value >> 8;
+    p[1] = value & 0xFF;
+}
+
+ModbusClient::~ModbusClient()
+{
+    end();
+}
+
+bool ModbusClient::begin(IPAddress const& server, uint16_t port)
+{
+    end();
+
+    _server = server;
+    _port = port;
+    _started = _udp.begin(port) == 1;
+    return _started;
+}
+
+void ModbusClient::end()
+{
+    if (!_started) { return; }
+
+    _udp.stop();
+    _started = false;
+
+    for (auto& transaction : _transactions) { transaction.pending = false; }
+}
+
+size_t ModbusClient::getInFlight() const
+{
+    return std::count_if(_transactions.begin(), _transactions.end(),
+            [](Transaction const& t) { return t.pending; });
+}
+
+uint32_t ModbusClient::getTimeoutMicros() const
+{
+    uint32_t timeout = sInitialTimeoutMicros;
+    if (_rttValid) { timeout = std::max(_srttMicros + 4 * _rttVarMicros, MinTimeoutMicros); }
+
+    return std::min(timeout << _backoff, MaxTimeoutMicros);
+}
+
+std::optional<uint16_t> ModbusClient::readHoldingRegisters(uint8_t unitId, uint16_t address, uint16_t count)
+{
+    if (!_started) { return std::nullopt; }
+
+    expireTransactions(micros());
+
+    auto iter = std::find_if(_transactions.begin(), _transactions.end(),
+            [](Transaction const& t) { return !t.pending; });
+    if (iter == _transactions.end()) { return std::nullopt; }
+
+    // zero is skipped such that it never matches a zeroed datagram
+    uint16_t id = _nextTransactionId++;
+    if (_nextTransactionId == 0) { _nextTransactionId = 1; }
+
+    std::array<uint8_t, 12> request;
+    write16(&request[0], id);
+    write16(&request[2], 0x0000); // protocol ID
+    write16(&request[4], 6); // length of the remaining bytes
+    request[6] = unitId;
+    request[7] = sFunctionReadHoldingRegisters;
+    write16(&request[8], address);
+    write16(&request[10], count);
+
+    _udp.beginPacket(_server, _port);
+    _udp.write(request.data(), request.size());
+    if (_udp.endPacket() != 1) { return std::nullopt; }
+
+    iter->pending = true;
+    iter->id = id;
+    iter->unitId = unitId;
+    iter->functionCode = sFunctionReadHoldingRegisters;
+    iter->address = address;
+    iter->count = count;
+    iter->sentMicros = micros();
+
+    return id;
+}
+
+std::optional<ModbusClient::Response> ModbusClient::receive()
+{
+    if (!_started) { return std::nullopt; }
+
+    while (_udp.parsePacket() > 0) {
+        uint32_t receivedMicros = micros();
+
+        if (_udp.remoteIP() != _server) { continue; }
+
+        int length = _udp.read(_buffer.data(), _buffer.size());
+        if (length <= 0) { continue; }
+
+        auto oResponse = parseResponse(length, receivedMicros);
+        if (oResponse) { return oResponse; }
+    }
+
+    expireTransactions(micros());
+    return std::nullopt;
+}
+
+ModbusClient::Transaction* ModbusClient::findTransaction(uint16_t id)
+{
+    for (auto& transaction : _transactions) {
+        if (transaction.pending && transaction.id == id) { return &transaction; }
+    }
+
+    return nullptr;
+}
+
+void ModbusClient::expireTransactions(uint32_t now)
+{
+    uint32_t timeout = getTimeoutMicros();
+    bool expired = false;
+
+    for (auto& transaction : _transactions) {
+        if (!transaction.pending || now - transaction.sentMicros < timeout) { continue; }
+
+        transaction.pending = false;
+        ++_timeouts;
+        expired = true;
+    }
+
+    // late responses are discarded and therefore never contribute to the
+    // estimate. the timeout is doubled until a request is answered in time,
+    // as the estimate would otherwise not catch up with a slower network.
+    if (expired && (getTimeoutMicros() < MaxTimeoutMicros)) { ++_backoff; }
+}
+
+void ModbusClient::updateRtt(uint32_t rttMicros)
+{
+    if (!_rttValid) {
+        _srttMicros = rttMicros;
+        _rttVarMicros = rttMicros / 2;
+        _rttValid = true;
+        return;
+    }
+
+    uint32_t deviation = (rttMicros > _srttMicros) ? rttMicros - _srttMicros : _srttMicros - rttMicros;
+    _rttVarMicros = (3 * _rttVarMicros + deviation) / 4;
+    _srttMicros = (7 * _srttMicros + rttMicros) / 8;
+}
+
+std::optional<ModbusClient::Response> ModbusClient::parseResponse(size_t length, uint32_t receivedMicros)
+{
+    uint8_t const* p = _buffer.data();
+
+    if (length < sMbapHeaderSize + 2) {
+        MessageOutput.printf("[PowerMeters::Udp::ModbusClient] response too short: %u bytes\r\n", length);
+        return std::nullopt;
+    }
+
+    uint16_t transactionId = read16(p);
+    uint16_t protocolId = read16(p + 2);
+    uint16_t pduLength = read16(p + 4); // including the unit ID
+
+    if (protocolId != 0x0000) {
+        MessageOutput.printf("[PowerMeters::Udp::ModbusClient] invalid protocol ID: %04X\r\n", protocolId);
+        return std::nullopt;
+    }
+
+    if (pduLength + 6U != length) {
+        MessageOutput.printf("[PowerMeters::Udp::ModbusClient] length %u does not match "
+                "datagram size %u\r\n", pduLength, length);
+        return std::nullopt;
+    }
+
+    // the transaction may have expired already
+    Transaction* pTransaction = findTransaction(transactionId);
+    if (pTransaction == nullptr) {
+        MessageOutput.printf("[PowerMeters::Udp::ModbusClient] unexpected transaction ID: %04X\r\n",
+                transactionId);
+        return std::nullopt;
+    }
+
+    Transaction transaction = *pTransaction;
+    pTransaction->pending = false;
+
+    uint32_t rtt = receivedMicros - transaction.sentMicros;
+    updateRtt(rtt);
+    _backoff = 0;
+
+    uint8_t unitId = p[6];
+    uint8_t functionCode = p[7];
+
+    if (unitId != transaction.unitId) {
+        MessageOutput.printf("[PowerMeters::Udp::ModbusClient] unexpected unit ID: %02X, "
+                "expected %02X\r\n", unitId, transaction.unitId);
+        return std::nullopt;
+    }
+
+    if (functionCode == (transaction.functionCode | sExceptionFlag)) {
+        MessageOutput.printf("[PowerMeters::Udp::ModbusClient] exception %02X reading %u registers "
+                "at %04X\r\n", p[8], transaction.count, transaction.address);
+        return std::nullopt;
+    }
+
+    if (functionCode != transaction.functionCode) {
+        MessageOutput.printf("[PowerMeters::Udp::ModbusClient] unexpected function code: %02X, "
+                "expected %02X\r\n", functionCode, transaction.functionCode);
+        return std::nullopt;
+    }
+
+    uint8_t byteCount = p[8];
+    if (byteCount != transaction.count * 2 || sMbapHeaderSize + 2 + byteCount != length) {
+        MessageOutput.printf("[PowerMeters::Udp::ModbusClient] unexpected byte count: %02X, "
+                "expected %02X\r\n", byteCount, transaction.count * 2);
+        return std::nullopt;
+    }
+
+    Response response;
+    response.transactionId = transactionId;
+    response.address = transaction.address;
+    response.count = transaction.count;
+    response.pData = p + sMbapHeaderSize + 2;
+    response.rttMicros = rtt;
+    return response;
+}
+
+} // namespace PowerMeters::Udp
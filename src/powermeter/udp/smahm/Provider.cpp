@@ -13,17 +13,38 @@ static constexpr unsigned int multicastPort = 9522;  // local port to listen on
 static const IPAddress multicastIP(239, 12, 255, 254);
 static WiFiUDP SMAUdp;
 
-constexpr uint32_t interval = 1000;
+static constexpr uint16_t groupTagEnd = 0x0000;
+static constexpr uint16_t groupTagData = 0x0010;
+static constexpr uint16_t groupTagTag0 = 0x02A0;
+static constexpr uint16_t protocolEnergyMeter = 0x6069;
+static constexpr uint8_t channelVersion = 144;
 
-void Provider::Soutput(int kanal, int index, int art, int tarif,
-        char const* name, float value, uint32_t timestamp)
+static uint16_t read16(uint8_t const* p)
 {
-    if (!_verboseLogging) { return; }
+    return (p[0] << 8) | p[1];
+}
 
-    MessageOutput.printf("[PowerMeters::Udp::SmaHM] %s = %.1f (timestamp %u)\r\n",
-            name, value, timestamp);
+static uint32_t read32(uint8_t const* p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
 }
 
+// the measurement identifier (channel, index, type, tariff) as found in the
+// datagram, i.e., an OBIS code like 1.4.0 is channel 0, index 1, type 4.
+static constexpr uint32_t obis(uint8_t channel, uint8_t index, uint8_t type, uint8_t tariff)
+{
+    return (static_cast<uint32_t>(channel) << 24) | (index << 16) | (type << 8) | tariff;
+}
+
+// instantaneous active power in units of 0.1 W, in the order of the
+// Measurand enum. all other measurements are skipped.
+static constexpr std::array<uint32_t, 8> sMeasurandIds = {
+    obis(0, 1, 4, 0), obis(0, 2, 4, 0),
+    obis(0, 21, 4, 0), obis(0, 22, 4, 0),
+    obis(0, 41, 4, 0), obis(0, 42, 4, 0),
+    obis(0, 61, 4, 0), obis(0, 62, 4, 0)
+};
+
 bool Provider::init()
 {
     SMAUdp.begin(multicastPort);
@@ -36,174 +57,155 @@ Provider::~Provider()
     SMAUdp.stop();
 }
 
-uint8_t* Provider::decodeGroup(uint8_t* offset, uint16_t grouplen)
+bool Provider::acceptSerial(uint32_t serial)
 {
-    float Pbezug = 0;
-    float BezugL1 = 0;
-    float BezugL2 = 0;
-    float BezugL3 = 0;
-    float Peinspeisung = 0;
-    float EinspeisungL1 = 0;
-    float EinspeisungL2 = 0;
-    float EinspeisungL3 = 0;
-
-    uint8_t* endOfGroup = offset + grouplen;
-
-    // not used: uint16_t protocolID = (offset[0] << 8) + offset[1];
-    offset += 2;
-
-    // not used: uint16_t susyID = (offset[0] << 8) + offset[1];
-    offset += 2;
-
-    _serial = (offset[0] << 24) + (offset[1] << 16) + (offset[2] << 8) + offset[3];
-    offset += 4;
-
-    uint32_t timestamp = (offset[0] << 24) + (offset[1] << 16) + (offset[2] << 8) + offset[3];
-    offset += 4;
-
-    unsigned count = 0;
-    while (offset < endOfGroup) {
-        uint8_t kanal = offset[0];
-        uint8_t index = offset[1];
-        uint8_t art = offset[2];
-        uint8_t tarif = offset[3];
-        offset += 4;
+    uint32_t now = millis();
 
-        if (kanal == 144) {
-            // Optional: Versionsnummer auslesen... aber interessiert die?
-            offset += 4;
-            continue;
-        }
+    if (_serial != 0 && now - _lastSerialMillis > SerialTimeoutMillis) {
+        MessageOutput.printf("[PowerMeters::Udp::SmaHM] Meter with serial %u went silent\r\n", _serial);
+        _serial = 0;
+    }
 
-        if (art == 8) {
-            offset += 8;
-            continue;
-        }
+    if (_serial == 0) {
+        _serial = serial;
+        MessageOutput.printf("[PowerMeters::Udp::SmaHM] Using meter with serial %u\r\n", _serial);
+    }
 
-        if (art == 4) {
-            uint32_t data = (offset[0] << 24) +
-                (offset[1] << 16) +
-                (offset[2] << 8) +
-                offset[3];
-            offset += 4;
-
-            switch (index) {
-                case (1):
-                    Pbezug = data * 0.1;
-                    ++count;
-                    break;
-                case (2):
-                    Peinspeisung = data * 0.1;
-                    ++count;
-                    break;
-                case (21):
-                    BezugL1 = data * 0.1;
-                    ++count;
-                    break;
-                case (22):
-                    EinspeisungL1 = data * 0.1;
-                    ++count;
-                    break;
-                case (41):
-                    BezugL2 = data * 0.1;
-                    ++count;
-                    break;
-                case (42):
-                    EinspeisungL2 = data * 0.1;
-                    ++count;
-                    break;
-                case (61):
-                    BezugL3 = data * 0.1;
-                    ++count;
-                    break;
-                case (62):
-                    EinspeisungL3 = data * 0.1;
-                    ++count;
-                    break;
-                default:
-                    break;
-            }
+    if (serial != _serial) { return false; }
 
-            if (count == 8) {
-                auto powerTotal = Pbezug - Peinspeisung;
-                auto powerL1 = BezugL1 - EinspeisungL1;
-                auto powerL2 = BezugL2 - EinspeisungL2;
-                auto powerL3 = BezugL3 - EinspeisungL3;
-
-                {
-                    auto scopedLock = _dataCurrent.lock();
-                    _dataCurrent.add<DataPointLabel::PowerTotal>(powerTotal);
-                    _dataCurrent.add<DataPointLabel::PowerL1>(powerL1);
-                    _dataCurrent.add<DataPointLabel::PowerL2>(powerL2);
-                    _dataCurrent.add<DataPointLabel::PowerL3>(powerL3);
-                }
-
-                Soutput(kanal, index, art, tarif, "Leistung", powerTotal, timestamp);
-                Soutput(kanal, index, art, tarif, "Leistung L1", powerL1, timestamp);
-                Soutput(kanal, index, art, tarif, "Leistung L2", powerL2, timestamp);
-                Soutput(kanal, index, art, tarif, "Leistung L3", powerL3, timestamp);
-                count = 0;
-            }
+    _lastSerialMillis = now;
+    return true;
+}
+
+bool Provider::decodeGroup(uint8_t const* data, uint16_t length, Reading& reading)
+{
+    // protocol ID, SusyID, serial number and ticker
+    if (length < 12) { return false; }
+
+    // SMA inverters use the same multicast group for other protocols
+    if (read16(data) != protocolEnergyMeter) { return false; }
+
+    // validated before decoding, as the datagrams of other meters are
+    // discarded anyways.
+    if (!acceptSerial(read32(data + 4))) { return false; }
 
-            continue;
+    static_assert(sMeasurandIds.size() == MeasurandCount, "measurand table mismatch");
+
+    reading.timestamp = read32(data + 8);
+    reading.found = 0;
+
+    size_t offset = 12;
+    while (offset + 4 <= length) {
+        uint8_t const* id = data + offset;
+        offset += 4;
+
+        // the software version uses four bytes despite its type being zero
+        size_t size = (id[0] == channelVersion) ? 4 : id[2];
+        if (offset + size > length) { return false; }
+
+        if (size == 4) {
+            uint32_t key = read32(id);
+            for (size_t i = 0; i < sMeasurandIds.size(); ++i) {
+                if (sMeasurandIds[i] != key) { continue; }
+                reading.values[i] = read32(data + offset) * 0.1f;
+                reading.found |= 1U << i;
+                break;
+            }
+        }
+        else if (size != 8 && _verboseLogging) {
+            MessageOutput.printf("[PowerMeters::Udp::SmaHM] Skipped unknown measurement: %d %d %d %d\r\n",
+                    id[0], id[1], id[2], id[3]);
         }
 
-        MessageOutput.printf("[PowerMeters::Udp::SmaHM] Skipped unknown measurement: %d %d %d %d\r\n",
-                kanal, index, art, tarif);
-        offset += art;
+        offset += size;
     }
 
-    return offset;
+    return reading.found == (1U << MeasurandCount) - 1;
 }
 
-void Provider::loop()
+bool Provider::decodeDatagram(uint8_t const* data, size_t length, Reading& reading)
 {
-    uint32_t currentMillis = millis();
-    if (currentMillis - _previousMillis < interval) { return; }
-
-    _previousMillis = currentMillis;
-
-    int packetSize = SMAUdp.parsePacket();
-    if (!packetSize) { return; }
-
-    uint8_t buffer[1024];
-    int rSize = SMAUdp.read(buffer, 1024);
-    if (buffer[0] != 'S' || buffer[1] != 'M' || buffer[2] != 'A') {
+    if (length < 4 || memcmp(data, "SMA", 4) != 0) { // includes the '\0'
         MessageOutput.println("[PowerMeters::Udp::SmaHM] Not an SMA packet?");
-        return;
+        return false;
     }
 
-    uint16_t grouplen;
-    uint16_t grouptag;
-    uint8_t* offset = buffer + 4; // skips the header 'SMA\0'
-
-    do {
-        grouplen = (offset[0] << 8) + offset[1];
-        grouptag = (offset[2] << 8) + offset[3];
+    size_t offset = 4;
+    while (offset + 4 <= length) {
+        uint16_t groupLength = read16(data + offset);
+        uint16_t groupTag = read16(data + offset + 2);
         offset += 4;
 
-        if (grouplen == 0xffff) return;
+        if (groupTag == groupTagEnd || groupLength == 0xffff) { return false; }
 
-        if (grouptag == 0x02A0 && grouplen == 4) {
-            offset += 4;
-            continue;
+        if (offset + groupLength > length) {
+            MessageOutput.printf("[PowerMeters::Udp::SmaHM] Truncated group 0x%04x with length %d\r\n",
+                    groupTag, groupLength);
+            return false;
         }
 
-        if (grouptag == 0x0010) {
-            offset = decodeGroup(offset, grouplen);
-            continue;
+        // a datagram carries a single data group
+        if (groupTag == groupTagData) {
+            return decodeGroup(data + offset, groupLength, reading);
         }
 
-        if (grouptag == 0) {
-            // end marker
-            offset += grouplen;
-            continue;
+        if (groupTag != groupTagTag0) {
+            MessageOutput.printf("[PowerMeters::Udp::SmaHM] Unhandled group 0x%04x with length %d\r\n",
+                    groupTag, groupLength);
         }
 
-        MessageOutput.printf("[PowerMeters::Udp::SmaHM] Unhandled group 0x%04x with length %d\r\n",
-                grouptag, grouplen);
-        offset += grouplen;
-    } while (grouplen > 0 && offset + 4 < buffer + rSize);
+        offset += groupLength;
+    }
+
+    return false;
+}
+
+void Provider::publish(Reading const& reading)
+{
+    auto const& v = reading.values;
+    auto powerTotal = v[ImportTotal] - v[ExportTotal];
+    auto powerL1 = v[ImportL1] - v[ExportL1];
+    auto powerL2 = v[ImportL2] - v[ExportL2];
+    auto powerL3 = v[ImportL3] - v[ExportL3];
+
+    {
+        auto scopedLock = _dataCurrent.lock();
+        _dataCurrent.add<DataPointLabel::PowerTotal>(powerTotal);
+        _dataCurrent.add<DataPointLabel::PowerL1>(powerL1);
+        _dataCurrent.add<DataPointLabel::PowerL2>(powerL2);
+        _dataCurrent.add<DataPointLabel::PowerL3>(powerL3);
+    }
+
+    recordSample();
+
+    if (!_verboseLogging) { return; }
+
+    MessageOutput.printf("[PowerMeters::Udp::SmaHM] Leistung = %.1f, L1 = %.1f, "
+            "L2 = %.1f, L3 = %.1f (timestamp %u)\r\n",
+            powerTotal, powerL1, powerL2, powerL3, reading.timestamp);
+}
+
+void Provider::loop()
+{
+    // all datagrams received since the last call are decoded, but only the
+    // newest reading is published.
+    Reading reading;
+    Reading newest;
+    bool haveReading = false;
+
+    for (size_t i = 0; i < MaxDatagramsPerLoop; ++i) {
+        if (SMAUdp.parsePacket() <= 0) { break; }
+
+        int length = SMAUdp.read(_buffer.data(), _buffer.size());
+        if (length <= 0) { continue; }
+
+        if (decodeDatagram(_buffer.data(), length, reading)) {
+            newest = reading;
+            haveReading = true;
+        }
+    }
+
+    if (haveReading) { publish(newest); }
 }
 
 } // namespace PowerMeters::Udp::SmaHM
@@ -4,22 +4,16 @@
  */
 #include <powermeter/udp/victron/Provider.h>
 #include <Arduino.h>
-#include <WiFiUdp.h>
+#include <algorithm>
 #include <MessageOutput.h>
 
 namespace PowerMeters::Udp::Victron {
 
-static constexpr unsigned int modbusPort = 502;  // local port to listen on
-
 // we only send one request which spans all registers we want to read
-static constexpr uint16_t sTransactionId = 0xDEAD; // arbitrary value
 static constexpr uint8_t sUnitId = 0x01;
-static constexpr uint8_t sFunctionCode = 0x03; // read holding registers
 static constexpr uint16_t sRegisterAddress = 0x3032;
 static constexpr uint16_t sRegisterCount = 0x005A;
 
-static WiFiUDP VictronUdp;
-
 Provider::Provider(PowerMeterUdpVictronConfig const& cfg)
     : _cfg(cfg)
 {
@@ -27,150 +21,79 @@ Provider::Provider(PowerMeterUdpVictronConfig const& cfg)
 
 bool Provider::init()
 {
-    VictronUdp.begin(modbusPort);
-    return true;
+    return _client.begin(IPAddress(_cfg.IpAddress));
 }
 
-Provider::~Provider()
+uint32_t Provider::getPollingInterval() const
 {
-    VictronUdp.stop();
+    uint32_t interval = _cfg.PollingIntervalMs;
+    if (!_cfg.AdaptivePolling || !_client.hasRtt()) { return interval; }
+
+    // as many requests as fit into half of the pipeline during one
+    // round trip, which leaves room for the round-trip time to vary.
+    uint32_t rttMs = _client.getSmoothedRttMicros() / 1000;
+    uint32_t adaptive = 2 * rttMs / ModbusClient::MaxInFlight;
+    return std::clamp(adaptive, std::min(MinPollingIntervalMs, interval), interval);
 }
 
 void Provider::sendModbusRequest()
 {
-    auto interval = _cfg.PollingIntervalMs;
-
     uint32_t currentMillis = millis();
 
-    if (currentMillis - _lastRequest < interval) { return; }
-
-    std::vector<uint8_t> payload;
-
-    payload.push_back(sTransactionId >> 8);
-    payload.push_back(sTransactionId & 0xFF);
+    if (currentMillis - _lastRequest < getPollingInterval()) { return; }
 
-    // protocol ID
-    payload.push_back(0x00);
-    payload.push_back(0x00);
-
-    // length
-    payload.push_back(0x00);
-    payload.push_back(0x06);
-
-    payload.push_back(sUnitId);
-    payload.push_back(sFunctionCode);
-    payload.push_back(sRegisterAddress >> 8);
-    payload.push_back(sRegisterAddress & 0xFF);
-    payload.push_back(sRegisterCount >> 8);
-    payload.push_back(sRegisterCount & 0xFF);
-
-    VictronUdp.beginPacket(_cfg.IpAddress, modbusPort);
-    VictronUdp.write(payload.data(), payload.size());
-    VictronUdp.endPacket();
+    // a request is sent before the previous one was answered, unless too
+    // many are in flight already.
+    if (!_client.readHoldingRegisters(sUnitId, sRegisterAddress, sRegisterCount)) { return; }
 
     _lastRequest = currentMillis;
 }
 
-static float readInt16(uint8_t** buffer, uint8_t factor)
+static float readInt16(uint8_t const** buffer, uint8_t factor)
 {
-    uint8_t* p = *buffer;
+    uint8_t const* p = *buffer;
     int16_t value = (p[0] << 8) | p[1];
     *buffer += 2;
     return static_cast<float>(value) / factor;
 }
 
-static float readInt32(uint8_t** buffer, uint8_t factor)
+static float readInt32(uint8_t const** buffer, uint8_t factor)
 {
-    uint8_t* p = *buffer;
+    uint8_t const* p = *buffer;
     int32_t value = (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
     *buffer += 4;
     return static_cast<float>(value) / factor;
 }
 
-static float readUint32(uint8_t** buffer, uint8_t factor)
+static float readUint32(uint8_t const** buffer, uint8_t factor)
 {
-    uint8_t* p = *buffer;
+    uint8_t const* p = *buffer;
     uint32_t value = (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
     *buffer += 4;
     return static_cast<float>(value) / factor;
 }
 
-void Provider::parseModbusResponse()
+void Provider::parseModbusResponse(ModbusClient::Response const& response)
 {
-    int packetSize = VictronUdp.parsePacket();
-    if (!packetSize) { return; }
-
-    uint8_t buffer[256];
-    VictronUdp.read(buffer, sizeof(buffer));
-
-    uint8_t* p = buffer;
+    if (response.address != sRegisterAddress || response.count != sRegisterCount) { return; }
 
-    if (_verboseLogging) {
-        MessageOutput.printf("[PowerMeters::Udp::Victron] received %d bytes:", packetSize);
-
-        for (int i = 0; i < packetSize; i++) {
-            if (i % 16 == 0) {
-                MessageOutput.print("\r\n");
-            }
-            MessageOutput.printf("%02X ", buffer[i]);
-        }
-
-        MessageOutput.print("\r\n");
-    }
-
-    uint16_t transactionId = (p[0] << 8) | p[1];
-    p += 2;
-
-    if (transactionId != sTransactionId) {
-        MessageOutput.printf("[PowerMeters::Udp::Victron] invalid transaction ID: %04X\r\n", transactionId);
+    // with several requests in flight, responses may overtake each other.
+    // transaction IDs are assigned in ascending order.
+    if (_oLastTransactionId &&
+            static_cast<int16_t>(response.transactionId - *_oLastTransactionId) <= 0) {
         return;
     }
+    _oLastTransactionId = response.transactionId;
 
-    uint16_t protocolId = (p[0] << 8) | p[1];
-    p += 2;
-
-    if (protocolId != 0x0000) {
-        MessageOutput.printf("[PowerMeters::Udp::Victron] invalid protocol ID: %04X\r\n", protocolId);
-        return;
-    }
-
-    uint16_t length = (p[0] << 8) | p[1];
-    p += 2;
-
-    uint16_t expectedLength = (sRegisterCount * 2) + 3;
-    if (length != expectedLength) {
-        MessageOutput.printf("[PowerMeters::Udp::Victron] unexpected length: %04X, "
-            "expected %04X\r\n", length, expectedLength);
-        return;
-    }
-
-    uint8_t unitId = p[0];
-    p += 1;
-
-    if (unitId != sUnitId) {
-        MessageOutput.printf("[PowerMeters::Udp::Victron] unexpected unit ID: %02X, "
-            "expected %02X\r\n", unitId, sUnitId);
-        return;
-    }
-
-    uint8_t functionCode = p[0];
-    p += 1;
-
-    if (functionCode != sFunctionCode) {
-        MessageOutput.printf("[PowerMeters::Udp::Victron] unexpected function code: %02X, "
-            "expected %02X\r\n", functionCode, sFunctionCode);
-        return;
+    if (_verboseLogging) {
+        MessageOutput.printf("[PowerMeters::Udp::Victron] transaction %04X took %u us "
+                "(smoothed %u us, %u timeouts), polling every %u ms\r\n",
+                response.transactionId, response.rttMicros,
+                _client.getSmoothedRttMicros(), _client.getTimeouts(),
+                getPollingInterval());
     }
 
-    uint8_t byteCount = p[0];
-    p += 1;
-
-    uint8_t expectedByteCount = sRegisterCount * 2;
-    if (byteCount != expectedByteCount) {
-        MessageOutput.printf("[PowerMeters::Udp::Victron] unexpected byte count: %02X, "
-            "expected %02X\r\n", byteCount, expectedByteCount);
-        return;
-    }
+    uint8_t const* p = response.pData;
 
     using Label = ::PowerMeters::DataPointLabel;
 
@@ -197,12 +120,18 @@ void Provider::parseModbusResponse()
     _dataCurrent.add<Label::PowerL2>(readInt32(&p, 1)); // 0x3086f
     p += 4; // jump to 0x308A
     _dataCurrent.add<Label::PowerL3>(readInt32(&p, 1)); // 0x308Af
+
+    scopedLock.unlock();
+    recordSample();
 }
 
 void Provider::loop()
 {
+    while (auto oResponse = _client.receive()) {
+        parseModbusResponse(*oResponse);
+    }
+
     sendModbusRequest();
-    parseModbusResponse();
 }
 
 } // namespace PowerMeters::Udp::Victron
@@ -2,6 +2,7 @@
 #include <Configuration.h>
 #include <MessageOutput.h>
 #include <MqttSettings.h>
+#include <MqttHassRegistry.h>
 #include <solarcharger/Controller.h>
 #include <solarcharger/DummyStats.h>
 #include <solarcharger/victron/Provider.h>
@@ -84,6 +85,13 @@ void Controller::loop()
     auto const& config = Configuration.get();
     if (!config.Mqtt.Hass.Enabled) { return; }
 
+    using Owner = MqttHassRegistryClass::Owner;
+    if (MqttHassRegistry.isReady() &&
+            (MqttHassRegistry.takeDeferred(Owner::SolarCharger) ||
+             MqttHassRegistry.takeInvalidated(Owner::SolarCharger))) {
+        _forcePublishSensors = true;
+    }
+
     _upProvider->getStats()->mqttPublishSensors(_forcePublishSensors);
 
     _forcePublishSensors = false;
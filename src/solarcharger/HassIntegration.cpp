@@ -4,6 +4,7 @@
 #include <Configuration.h>
 #include <MqttSettings.h>
 #include <MqttHandleHass.h>
+#include <MqttHassRegistry.h>
 #include <Utils.h>
 #include <__compiled_constants.h>
 
@@ -11,9 +12,7 @@ namespace SolarChargers {
 
 void HassIntegration::publish(const String& subtopic, const String& payload) const
 {
-    String topic = Configuration.get().Mqtt.Hass.Topic;
-    topic += subtopic;
-    MqttSettings.publishGeneric(topic.c_str(), payload.c_str(), Configuration.get().Mqtt.Hass.Retain);
+    MqttHassRegistry.publish(MqttHassRegistryClass::Owner::SolarCharger, subtopic, payload);
 }
 
 } // namespace SolarChargers
@@ -7,6 +7,7 @@ import DeviceAdminView from '@/views/DeviceAdminView.vue';
 import DtuAdminView from '@/views/DtuAdminView.vue';
 import ErrorView from '@/views/ErrorView.vue';
 import FirmwareUpgradeView from '@/views/FirmwareUpgradeView.vue';
+import HistoryAdminView from '@/views/HistoryAdminView.vue';
 import HomeView from '@/views/HomeView.vue';
 import SolarChargerAdminView from '@/views/SolarChargerAdminView.vue';
 import PowerMeterAdminView from '@/views/PowerMeterAdminView.vue';
@@ -131,6 +132,11 @@ const router = createRouter({
             name: 'DTU Settings',
             component: DtuAdminView,
         },
+        {
+            path: '/settings/history',
+            name: 'History Settings',
+            component: HistoryAdminView,
+        },
         {
             path: '/settings/device',
             name: 'Device Manager',
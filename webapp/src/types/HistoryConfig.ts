@@ -0,0 +1,5 @@
+export interface HistoryConfig {
+    enabled: boolean;
+    interval: number;
+    max_size_kb: number;
+}
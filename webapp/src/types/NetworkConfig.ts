@@ -13,4 +13,5 @@ export interface NetworkConfig {
     syslogenabled: boolean;
     sysloghostname: string;
     syslogport: number;
+    syslogusetcp: boolean;
 }
@@ -56,5 +56,8 @@ export interface PowerLimiterConfig {
     inverter_channel_id_for_dc_voltage: number;
     restart_hour: number;
     total_upper_power_limit: number;
+    predictive_enabled: boolean;
+    ramp_rate_limit: number;
+    failsafe_enabled: boolean;
     inverters: PowerLimiterInverterConfig[];
 }
@@ -37,9 +37,16 @@ export interface PowerMeterHttpSmlConfig {
 
 export interface PowerMeterUdpVictronConfig {
     polling_interval_ms: number;
+    adaptive_polling: boolean;
     ip_address: string;
 }
 
+export interface PowerMeterFusionConfig {
+    fast_source: number;
+    slow_source: number;
+    correction_time_constant: number;
+}
+
 export interface PowerMeterConfig {
     enabled: boolean;
     verbose_logging: boolean;
@@ -50,4 +57,5 @@ export interface PowerMeterConfig {
     http_json: PowerMeterHttpJsonConfig;
     http_sml: PowerMeterHttpSmlConfig;
     udp_victron: PowerMeterUdpVictronConfig;
+    fusion: PowerMeterFusionConfig;
 }